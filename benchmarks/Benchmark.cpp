@@ -0,0 +1,313 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// Benchmark.cpp
+// Times loading, conflict queries, patching and saving over a generated plugin set.
+#include "Synthetic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#define PATCH_NAME "BenchPatch.esp"
+#define RESAVE_NAME "BenchResave.esp"
+
+struct PluginEntry
+    {
+    std::string Name;
+    uint64_t Records;
+    uint64_t Bytes;
+    };
+
+struct StageResult
+    {
+    const char *Name;
+    double Seconds; //Best of the repeats
+    uint64_t Records;
+    uint64_t Bytes;
+    };
+
+static bool IsVerbose = false;
+
+static int32_t Logger(const char *Message)
+    {
+    if(IsVerbose)
+        fputs(Message, stderr);
+    return 0;
+    }
+
+static void PrintUsage()
+    {
+    fputs("Usage: cbash-bench DIR [options]\n"
+          "  DIR           A directory written by cbash-genplugins\n"
+          "  --repeat N    Run every stage N times and keep the best time (default 3)\n"
+          "  --json        Print the results as JSON instead of a table\n"
+          "  --verbose     Show CBash's messages\n", stderr);
+    }
+
+static uint64_t FileSize(const std::string &Path)
+    {
+    struct stat buf;
+    return stat(Path.c_str(), &buf) == 0 ? (uint64_t)buf.st_size : 0;
+    }
+
+static bool ReadManifest(const std::string &Dir, const SyntheticGame *&Game, std::vector<PluginEntry> &Plugins)
+    {
+    std::string path = Dir + "/" SYNTHETIC_MANIFEST;
+    FILE *manifest = fopen(path.c_str(), "r");
+    if(manifest == NULL)
+        return false;
+    char name[260];
+    unsigned long long records = 0;
+    Game = NULL;
+    if(fscanf(manifest, "game %63s", name) == 1)
+        Game = FindSyntheticGame(name);
+    while(Game != NULL && fscanf(manifest, "%259s %llu", name, &records) == 2)
+        {
+        PluginEntry entry;
+        entry.Name = name;
+        entry.Records = records;
+        entry.Bytes = FileSize(Dir + "/" + name);
+        Plugins.push_back(entry);
+        }
+    fclose(manifest);
+    return Game != NULL && !Plugins.empty();
+    }
+
+static void Record(StageResult &Stage, const double Seconds, const uint64_t Records, const uint64_t Bytes)
+    {
+    if(Stage.Seconds < 0.0 || Seconds < Stage.Seconds)
+        Stage.Seconds = Seconds;
+    Stage.Records = Records;
+    Stage.Bytes = Bytes;
+    }
+
+static collection_t * OpenCollection(const std::string &Dir, const SyntheticGame *Game, const std::vector<PluginEntry> &Plugins, const uint32_t ModFlags, mod_t **Patch)
+    {
+    collection_t *collection = CreateCollection((char *)Dir.c_str(), Game->CollectionType);
+    if(collection == NULL)
+        return NULL;
+    for(uint32_t p = 0; p < Plugins.size(); ++p)
+        AddMod(collection, (char *)Plugins[p].Name.c_str(), ModFlags);
+    if(Patch != NULL)
+        *Patch = AddMod(collection, (char *)PATCH_NAME, fIsCreateNew | fIsInLoadOrder | fIsSaveable);
+    return collection;
+    }
+
+static bool RunOnce(const std::string &Dir, const SyntheticGame *Game, const std::vector<PluginEntry> &Plugins, std::vector<StageResult> &Stages)
+    {
+    uint64_t totalRecords = 0;
+    uint64_t totalBytes = 0;
+    for(uint32_t p = 0; p < Plugins.size(); ++p)
+        {
+        totalRecords += Plugins[p].Records;
+        totalBytes += Plugins[p].Bytes;
+        }
+
+    //Min load only reads each plugin's header
+    collection_t *collection = OpenCollection(Dir, Game, Plugins, fIsMinLoad | fIsInLoadOrder, NULL);
+    if(collection == NULL)
+        return false;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int32_t loaded = LoadCollection(collection, NULL);
+    Record(Stages[0], SyntheticSeconds(start), Plugins.size(), 0);
+    DeleteCollection(collection);
+    if(loaded != 0)
+        return false;
+
+    mod_t *patch = NULL;
+    collection = OpenCollection(Dir, Game, Plugins, fIsFullLoad | fIsInLoadOrder | fIsSaveable | fIsAddMasters | fIsLoadMasters, &patch);
+    if(collection == NULL)
+        return false;
+    start = std::chrono::steady_clock::now();
+    loaded = LoadCollection(collection, NULL);
+    Record(Stages[1], SyntheticSeconds(start), totalRecords, totalBytes);
+    if(loaded != 0 || patch == NULL)
+        {
+        DeleteCollection(collection);
+        return false;
+        }
+
+    std::vector<mod_t *> mods;
+    std::vector<record_t *> records;
+    for(uint32_t p = 0; p < Plugins.size(); ++p)
+        {
+        mod_t *mod = GetModIDByName(collection, (char *)Plugins[p].Name.c_str());
+        if(mod == NULL)
+            continue;
+        mods.push_back(mod);
+        for(uint32_t t = 0; t < Game->NumTypes; ++t)
+            {
+            uint32_t type = SyntheticRecordType(Game->Types[t].Name);
+            int32_t count = GetNumRecords(mod, type);
+            if(count <= 0)
+                continue;
+            size_t offset = records.size();
+            records.resize(offset + count);
+            GetRecordIDs(mod, type, &records[offset]);
+            }
+        }
+
+    //Conflict queries, as a patcher would make before deciding what to copy
+    std::vector<record_t *> winners;
+    std::vector<record_t *> conflicts(Plugins.size() + 1);
+    start = std::chrono::steady_clock::now();
+    for(uint32_t x = 0; x < records.size(); ++x)
+        {
+        if(IsRecordWinning(records[x], false) > 0)
+            winners.push_back(records[x]);
+        int32_t numConflicts = GetNumRecordConflicts(records[x], false);
+        if(numConflicts > 0)
+            {
+            if((uint32_t)numConflicts > conflicts.size())
+                conflicts.resize(numConflicts);
+            GetRecordConflicts(records[x], &conflicts[0], false);
+            }
+        }
+    Record(Stages[2], SyntheticSeconds(start), records.size(), 0);
+
+    start = std::chrono::steady_clock::now();
+    uint64_t copied = 0;
+    for(uint32_t x = 0; x < winners.size(); ++x)
+        if(CopyRecord(winners[x], patch, NULL, 0, NULL, fSetAsOverride) != NULL)
+            ++copied;
+    Record(Stages[3], SyntheticSeconds(start), copied, 0);
+
+    std::string patchPath = Dir + "/" PATCH_NAME;
+    start = std::chrono::steady_clock::now();
+    int32_t saved = SaveMod(patch, 0, NULL);
+    Record(Stages[4], SyntheticSeconds(start), copied, FileSize(patchPath));
+    remove(patchPath.c_str());
+
+    //Saving every plugin to the same scratch file exercises the writer and compression
+    std::string resavePath = Dir + "/" RESAVE_NAME;
+    double seconds = 0.0;
+    uint64_t resaved = 0;
+    for(uint32_t x = 0; saved == 0 && x < mods.size(); ++x)
+        {
+        start = std::chrono::steady_clock::now();
+        saved = SaveMod(mods[x], 0, (char *)RESAVE_NAME);
+        seconds += SyntheticSeconds(start);
+        resaved += FileSize(resavePath);
+        remove(resavePath.c_str());
+        }
+    Record(Stages[5], seconds, totalRecords, resaved);
+
+    DeleteCollection(collection);
+    return saved == 0;
+    }
+
+static double PerSecond(const double Value, const double Seconds)
+    {
+    return Seconds > 0.0 ? Value / Seconds : 0.0;
+    }
+
+int main(int argc, char *argv[])
+    {
+    std::string dir;
+    uint32_t repeat = 3;
+    bool asJSON = false;
+    for(int x = 1; x < argc; ++x)
+        {
+        std::string arg(argv[x]);
+        if(arg == "--json")
+            asJSON = true;
+        else if(arg == "--verbose")
+            IsVerbose = true;
+        else if(arg == "--repeat" && x + 1 < argc)
+            repeat = (uint32_t)strtoul(argv[++x], NULL, 10);
+        else if(dir.empty() && arg.compare(0, 2, "--") != 0)
+            dir = arg;
+        else
+            {
+            PrintUsage();
+            return 2;
+            }
+        }
+    if(dir.empty() || repeat == 0)
+        {
+        PrintUsage();
+        return 2;
+        }
+    RedirectMessages(Logger);
+
+    const SyntheticGame *game = NULL;
+    std::vector<PluginEntry> plugins;
+    if(!ReadManifest(dir, game, plugins))
+        {
+        fprintf(stderr, "Unable to read \"%s/" SYNTHETIC_MANIFEST "\". Run cbash-genplugins first.\n", dir.c_str());
+        return 1;
+        }
+
+    const char *names[] = {"min load", "full load", "conflict queries", "copy to patch", "save patch", "save plugins"};
+    std::vector<StageResult> stages;
+    for(uint32_t x = 0; x < sizeof(names) / sizeof(names[0]); ++x)
+        {
+        StageResult stage = {names[x], -1.0, 0, 0};
+        stages.push_back(stage);
+        }
+    for(uint32_t x = 0; x < repeat; ++x)
+        if(!RunOnce(dir, game, plugins, stages))
+            {
+            fprintf(stderr, "Benchmark run %u failed. Rerun with --verbose to see CBash's messages.\n", x + 1);
+            return 1;
+            }
+
+    if(asJSON)
+        {
+        printf("{\"game\":\"%s\",\"plugins\":%u,\"repeat\":%u,\"stages\":[", game->Name, (uint32_t)plugins.size(), repeat);
+        for(uint32_t x = 0; x < stages.size(); ++x)
+            printf("%s{\"name\":\"%s\",\"seconds\":%.6f,\"records\":%llu,\"bytes\":%llu,\"records_per_s\":%.1f,\"mb_per_s\":%.2f}", x ? "," : "",
+                   stages[x].Name, stages[x].Seconds, (unsigned long long)stages[x].Records, (unsigned long long)stages[x].Bytes,
+                   PerSecond((double)stages[x].Records, stages[x].Seconds), PerSecond(stages[x].Bytes / 1048576.0, stages[x].Seconds));
+        printf("]}\n");
+        return 0;
+        }
+
+    printf("%s, %u plugins, best of %u\n", game->Name, (uint32_t)plugins.size(), repeat);
+    printf("%-18s %10s %10s %14s %10s %10s\n", "stage", "seconds", "records", "records/s", "MB", "MB/s");
+    for(uint32_t x = 0; x < stages.size(); ++x)
+        {
+        const StageResult &stage = stages[x];
+        printf("%-18s %10.4f %10llu %14.0f", stage.Name, stage.Seconds, (unsigned long long)stage.Records, PerSecond((double)stage.Records, stage.Seconds));
+        if(stage.Bytes != 0)
+            printf(" %10.2f %10.2f\n", stage.Bytes / 1048576.0, PerSecond(stage.Bytes / 1048576.0, stage.Seconds));
+        else
+            printf(" %10s %10s\n", "-", "-");
+        }
+    return 0;
+    }
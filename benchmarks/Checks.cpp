@@ -0,0 +1,672 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// Checks.cpp
+// Behavioural checks of the query, conflict and save paths, run against scratch plugins.
+#include "Synthetic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+    #include <direct.h>
+#endif
+
+#define CHECK(condition) \
+    do \
+        { \
+        if(!(condition)) \
+            { \
+            fprintf(stderr, "  %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            return false; \
+            } \
+        } while(0)
+
+struct CheckEntry
+    {
+    const char *Name;
+    bool (*Run)(const std::string &Dir);
+    };
+
+static bool IsVerbose = false;
+
+static int32_t Logger(const char *Message)
+    {
+    if(IsVerbose)
+        fputs(Message, stderr);
+    return 0;
+    }
+
+static void PrintUsage()
+    {
+    fputs("Usage: cbash-check DIR [options] [CHECK...]\n"
+          "  DIR           A scratch directory for the plugins the checks write\n"
+          "  --list        List the checks and exit\n"
+          "  --verbose     Show CBash's messages\n"
+          "Runs every check unless some are named.\n", stderr);
+    }
+
+//Owns a collection for the length of a check
+class ScratchCollection
+    {
+    public:
+        collection_t *collection;
+
+        ScratchCollection(const std::string &Dir, const uint32_t CollectionType):
+            collection(CreateCollection((char *)Dir.c_str(), CollectionType))
+            {
+            //
+            }
+
+        ~ScratchCollection()
+            {
+            if(collection != NULL)
+                DeleteCollection(collection);
+            }
+
+        mod_t * Add(const char *ModName, const uint32_t ModFlags)
+            {
+            return collection != NULL ? AddMod(collection, (char *)ModName, ModFlags) : NULL;
+            }
+
+        mod_t * AddNew(const char *ModName)
+            {
+            return Add(ModName, fIsFullLoad | fIsCreateNew | fIsInLoadOrder | fIsSaveable);
+            }
+    };
+
+static FieldSpec MakeField(const uint32_t FieldID)
+    {
+    FieldSpec Field = {FieldID, 0, 0, 0, 0, 0, 0};
+    return Field;
+    }
+
+static bool SetRecordField(record_t *RecordID, const uint32_t FieldID, const void *Value, const uint32_t ArraySize)
+    {
+    if(RecordID == NULL)
+        return false;
+    SetField(RecordID, FieldID, 0, 0, 0, 0, 0, 0, (void *)Value, ArraySize);
+    return true;
+    }
+
+//Oblivion game settings hold a string, float or integer depending on their editor id
+static record_t * CreateGMST(mod_t *ModID, const char *EditorID, const void *Value)
+    {
+    record_t *RecordID = CreateRecord(ModID, SyntheticRecordType("GMST"), 0, (char *)EditorID, NULL, 0);
+    return SetRecordField(RecordID, 5, Value, EditorID[0] == 's' ? (uint32_t)strlen((const char *)Value) + 1 : 4) ? RecordID : NULL;
+    }
+
+static bool CheckFieldColumns(const std::string &Dir)
+    {
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *numbers = scratch.AddNew("CheckColumnNumbers.esp");
+    mod_t *strings = scratch.AddNew("CheckColumnStrings.esp");
+    CHECK(numbers != NULL && strings != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+    const int32_t integer = 7;
+    const float real = 2.5f;
+    CHECK(CreateGMST(numbers, "iCheckInteger", &integer) != NULL);
+    CHECK(CreateGMST(numbers, "fCheckReal", &real) != NULL);
+    CHECK(CreateGMST(strings, "sCheckString", "check") != NULL);
+
+    const uint32_t GMST = SyntheticRecordType("GMST");
+    FieldSpec value = MakeField(5);
+    FieldSpec flags = MakeField(1);
+    FieldSpec eid = MakeField(4);
+    FORMID formIDs[2];
+    uint8_t values[2 * 8];
+    void *pointers[2];
+    uint8_t present[1] = {0};
+
+    //The union resolves to a 4 byte integer and float, so they can be copied
+    const uint32_t DATA = SyntheticRecordType("DATA");
+    CHECK(GetFieldColumn(numbers, GMST, &value, &DATA, 1, 4, formIDs, values, present, 2) == 2);
+    CHECK(present[0] == 3);
+    CHECK(*(int32_t *)&values[0] == integer);
+    CHECK(*(float *)&values[4] == real);
+
+    //Copying a string, or a value of another size, is refused rather than truncated
+    CHECK(GetFieldColumn(strings, GMST, &value, NULL, 0, 4, formIDs, values, present, 2) == -1);
+    CHECK(GetFieldColumn(strings, GMST, &eid, NULL, 0, 8, formIDs, values, present, 2) == -1);
+    CHECK(GetFieldColumn(numbers, GMST, &flags, NULL, 0, 2, formIDs, values, present, 2) == -1);
+    CHECK(GetFieldColumn(numbers, GMST, &flags, NULL, 0, 4, formIDs, values, present, 2) == 2);
+
+    //Strings are available as pointers
+    present[0] = 0;
+    CHECK(GetFieldColumn(strings, GMST, &value, NULL, 0, 0, formIDs, pointers, present, 2) == 1);
+    CHECK(present[0] == 1 && strcmp((const char *)pointers[0], "check") == 0);
+    CHECK(GetFieldColumn(numbers, GMST, &eid, NULL, 0, 0, formIDs, pointers, present, 2) == 2);
+    CHECK(strcmp((const char *)pointers[0], "iCheckInteger") == 0);
+    return true;
+    }
+
+static FieldPredicate MakePredicate(const uint32_t FieldID, const uint32_t Operator, const double Value, const char *String)
+    {
+    FieldPredicate Predicate;
+    memset(&Predicate, 0, sizeof(Predicate));
+    Predicate.Field = MakeField(FieldID);
+    Predicate.Operator = Operator;
+    Predicate.Join = eJoinAnd;
+    Predicate.Value = Value;
+    Predicate.String = String;
+    return Predicate;
+    }
+
+static bool CheckFieldPredicates(const std::string &Dir)
+    {
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *mod = scratch.AddNew("CheckPredicates.esp");
+    CHECK(mod != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+    const int32_t integer = 7;
+    const float real = 2.5f;
+    const int32_t negative = -3;
+    record_t *integerID = CreateGMST(mod, "iCheckInteger", &integer);
+    record_t *realID = CreateGMST(mod, "fCheckReal", &real);
+    record_t *negativeID = CreateGMST(mod, "iCheckNegative", &negative);
+    record_t *stringID = CreateGMST(mod, "sCheckString", "check");
+    CHECK(integerID != NULL && realID != NULL && negativeID != NULL && stringID != NULL);
+
+    const uint32_t GMST = SyntheticRecordType("GMST");
+    record_t *matches[4];
+
+    //Each record's value is compared as the type its union resolves to
+    FieldPredicate predicate = MakePredicate(5, eOpEqual, 7.0, NULL);
+    CHECK(GetMatchingRecordIDs(mod, GMST, &predicate, 1, matches, 4) == 1);
+    CHECK(matches[0] == integerID);
+
+    predicate = MakePredicate(5, eOpEqual, 2.5, NULL);
+    CHECK(GetMatchingRecordIDs(mod, GMST, &predicate, 1, matches, 4) == 1);
+    CHECK(matches[0] == realID);
+
+    //Signed values stay signed, and the string's pointer is never read as a number
+    predicate = MakePredicate(5, eOpLess, 0.0, NULL);
+    CHECK(GetMatchingRecordIDs(mod, GMST, &predicate, 1, matches, 4) == 1);
+    CHECK(matches[0] == negativeID);
+
+    predicate = MakePredicate(5, eOpGreater, 1.0, NULL);
+    CHECK(GetMatchingRecordIDs(mod, GMST, &predicate, 1, matches, 4) == 2);
+
+    predicate = MakePredicate(5, eOpEqual, 0.0, "check");
+    CHECK(GetMatchingRecordIDs(mod, GMST, &predicate, 1, matches, 4) == 1);
+    CHECK(matches[0] == stringID);
+
+    //Editor IDs are case insensitive
+    FieldPredicate joined[2] = {MakePredicate(4, eOpEqual, 0.0, "ICHECKINTEGER"), MakePredicate(4, eOpEqual, 0.0, "fcheckreal")};
+    joined[1].Join = eJoinOr;
+    CHECK(GetMatchingRecordIDs(mod, GMST, joined, 2, matches, 4) == 2);
+    return true;
+    }
+
+static bool CheckUncomparablePredicates(const std::string &Dir)
+    {
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *mod = scratch.AddNew("CheckUncomparable.esp");
+    CHECK(mod != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+    //The model hash is a byte array, which a predicate can't compare
+    const uint32_t MISC = SyntheticRecordType("MISC");
+    const float weight = 1.5f;
+    CHECK(SetRecordField(CreateRecord(mod, MISC, 0, NULL, NULL, 0), 12, &weight, 4));
+    record_t *matches[1];
+    FieldPredicate predicate = MakePredicate(8, eOpEqual, 0.0, NULL);
+    CHECK(GetMatchingRecordIDs(mod, MISC, &predicate, 1, matches, 1) == -1);
+
+    //The script is absent, so it doesn't match even a comparison against 0
+    predicate = MakePredicate(10, eOpEqual, 0.0, NULL);
+    CHECK(GetMatchingRecordIDs(mod, MISC, &predicate, 1, matches, 1) == 0);
+    predicate = MakePredicate(12, eOpEqual, 1.5, NULL);
+    CHECK(GetMatchingRecordIDs(mod, MISC, &predicate, 1, matches, 1) == 1);
+    return true;
+    }
+
+static bool CheckIdenticalToMaster(const std::string &Dir)
+    {
+    const uint32_t MISC = SyntheticRecordType("MISC");
+    const float weights[3] = {1.0f, 2.0f, 3.0f};
+    const float edited = 4.0f;
+        {
+        ScratchCollection scratch(Dir, eIsOblivion);
+        mod_t *master = scratch.AddNew("CheckITMMaster.esm");
+        mod_t *plugin = scratch.AddNew("CheckITMPlugin.esp");
+        CHECK(master != NULL && plugin != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+        record_t *overrides[3];
+        for(uint32_t x = 0; x < 3; ++x)
+            {
+            record_t *original = CreateRecord(master, MISC, 0, NULL, NULL, 0);
+            CHECK(SetRecordField(original, 12, &weights[x], 4));
+            overrides[x] = CopyRecord(original, plugin, NULL, 0, NULL, fSetAsOverride);
+            CHECK(overrides[x] != NULL);
+            }
+        CHECK(SetRecordField(overrides[2], 12, &edited, 4));
+        CHECK(GetNumIdenticalToMasterRecords(plugin) == 2);
+        CHECK(SaveMod(master, 0, NULL) == 0);
+        CHECK(SaveMod(plugin, 0, NULL) == 0);
+        }
+
+    //Fingerprints can only rule out records that differ, so the answer is the same with and without them
+    for(uint32_t pass = 0; pass < 2; ++pass)
+        {
+        ScratchCollection scratch(Dir, eIsOblivion);
+        const uint32_t flags = fIsFullLoad | fIsInLoadOrder | (pass == 1 ? fIsFingerprintRecords : 0);
+        CHECK(scratch.Add("CheckITMMaster.esm", flags) != NULL);
+        mod_t *plugin = scratch.Add("CheckITMPlugin.esp", flags);
+        CHECK(plugin != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        CHECK(GetNumIdenticalToMasterRecords(plugin) == 2);
+
+        record_t *identical[3] = {NULL, NULL, NULL};
+        CHECK(GetIdenticalToMasterRecords(plugin, identical) == 2);
+        FieldSpec weight = MakeField(12);
+        for(uint32_t x = 0; x < 2; ++x)
+            {
+            void *value = NULL;
+            CHECK(GetFields(identical[x], &weight, 1, NULL, &value) == 0);
+            CHECK(value != NULL && *(float *)value != edited);
+            }
+        }
+    return true;
+    }
+
+//Finds a plugin's record of a type by its editor id
+static record_t * FindRecord(mod_t *ModID, const uint32_t RecordType, const char *EditorID)
+    {
+    std::vector<record_t *> records(GetNumRecords(ModID, RecordType) > 0 ? GetNumRecords(ModID, RecordType) : 0);
+    if(records.empty() || GetRecordIDs(ModID, RecordType, &records[0]) != (int32_t)records.size())
+        return NULL;
+    for(uint32_t x = 0; x < records.size(); ++x)
+        {
+        const char *curEditorID = (const char *)GetField(records[x], 4, 0, 0, 0, 0, 0, 0, NULL);
+        if(curEditorID != NULL && strcmp(curEditorID, EditorID) == 0)
+            return records[x];
+        }
+    return NULL;
+    }
+
+//Fingerprints describe a record's long formIDs, so swapping the masters' load order doesn't change them
+static bool CheckStableFingerprints(const std::string &Dir)
+    {
+    const uint32_t MISC = SyntheticRecordType("MISC");
+    const char *Masters[2] = {"CheckStableA.esm", "CheckStableB.esm"};
+    const char *EditorIDs[2] = {"CheckFromA", "CheckFromB"};
+        {
+        ScratchCollection scratch(Dir, eIsOblivion);
+        mod_t *masters[2] = {scratch.AddNew(Masters[0]), scratch.AddNew(Masters[1])};
+        mod_t *plugin = scratch.AddNew("CheckStable.esp");
+        CHECK(masters[0] != NULL && masters[1] != NULL && plugin != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        for(uint32_t x = 0; x < 2; ++x)
+            {
+            record_t *target = CreateRecord(masters[x], MISC, 0, NULL, NULL, 0);
+            FORMID *targetID = (FORMID *)GetField(target, 2, 0, 0, 0, 0, 0, 0, NULL);
+            CHECK(targetID != NULL);
+            record_t *source = CreateRecord(plugin, MISC, 0, NULL, NULL, 0);
+            CHECK(SetRecordField(source, 4, EditorIDs[x], 0));
+            CHECK(SetRecordField(source, 10, targetID, 4));
+            }
+        CHECK(SaveMod(masters[0], 0, NULL) == 0);
+        CHECK(SaveMod(masters[1], 0, NULL) == 0);
+        CHECK(SaveMod(plugin, 0, NULL) == 0);
+        }
+
+    uint64_t fingerprints[2][2];
+    FORMID scripts[2][2];
+    for(uint32_t order = 0; order < 2; ++order)
+        {
+        ScratchCollection scratch(Dir, eIsOblivion);
+        const uint32_t flags = fIsFullLoad | fIsInLoadOrder;
+        CHECK(scratch.Add(Masters[order], flags) != NULL);
+        CHECK(scratch.Add(Masters[1 - order], flags) != NULL);
+        mod_t *plugin = scratch.Add("CheckStable.esp", flags);
+        CHECK(plugin != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        record_t *records[2];
+        for(uint32_t x = 0; x < 2; ++x)
+            {
+            records[x] = FindRecord(plugin, MISC, EditorIDs[x]);
+            CHECK(records[x] != NULL);
+            FORMID *script = (FORMID *)GetField(records[x], 10, 0, 0, 0, 0, 0, 0, NULL);
+            CHECK(script != NULL);
+            scripts[order][x] = *script;
+            }
+        CHECK(GetRecordFingerprints(records, fingerprints[order], 2) == 2);
+        }
+
+    //The loaded formIDs do depend on the load order
+    CHECK(scripts[0][0] != scripts[1][0] && scripts[0][1] != scripts[1][1]);
+    CHECK(fingerprints[0][0] == fingerprints[1][0]);
+    CHECK(fingerprints[0][1] == fingerprints[1][1]);
+    CHECK(fingerprints[0][0] != fingerprints[0][1]);
+    return true;
+    }
+
+//Replaces an Oblivion leveled list's entries with the items at level 1, with the given counts
+static bool SetListEntries(record_t *RecordID, const FORMID *Items, const int16_t *Counts, const uint32_t NumEntries)
+    {
+    if(RecordID == NULL)
+        return false;
+    const int16_t level = 1;
+    SetField(RecordID, 9, 0, 0, 0, 0, 0, 0, NULL, NumEntries);
+    for(uint32_t x = 0; x < NumEntries; ++x)
+        {
+        SetField(RecordID, 9, x, 1, 0, 0, 0, 0, (void *)&level, 0);
+        SetField(RecordID, 9, x, 3, 0, 0, 0, 0, (void *)&Items[x], 0);
+        SetField(RecordID, 9, x, 4, 0, 0, 0, 0, (void *)&Counts[x], 0);
+        }
+    return GetFieldAttribute(RecordID, 9, 0, 0, 0, 0, 0, 0, 1) == NumEntries;
+    }
+
+//Each entry of a merged leveled list appears once, however the tagged versions before it treated it
+static bool CheckLeveledListMerge(const std::string &Dir)
+    {
+    const uint32_t MISC = SyntheticRecordType("MISC");
+    const uint32_t LVLI = SyntheticRecordType("LVLI");
+    const char *PluginNames[4] = {"CheckLevDelev.esp", "CheckLevRelev.esp", "CheckLevAddD.esp", "CheckLevAddDE.esp"};
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *master = scratch.AddNew("CheckLevMaster.esm");
+    mod_t *plugins[4];
+    for(uint32_t x = 0; x < 4; ++x)
+        {
+        plugins[x] = scratch.AddNew(PluginNames[x]);
+        CHECK(plugins[x] != NULL);
+        }
+    mod_t *patch = scratch.AddNew("CheckLevPatch.esp");
+    CHECK(master != NULL && patch != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+    //A, B and C are in the original, D and E are added by the untagged plugins
+    FORMID items[5];
+    for(uint32_t x = 0; x < 5; ++x)
+        {
+        FORMID *itemID = (FORMID *)GetField(CreateRecord(master, MISC, 0, NULL, NULL, 0), 2, 0, 0, 0, 0, 0, 0, NULL);
+        CHECK(itemID != NULL);
+        items[x] = *itemID;
+        }
+    const int16_t ones[5] = {1, 1, 1, 1, 1};
+    record_t *original = CreateRecord(master, LVLI, 0, NULL, NULL, 0);
+    CHECK(SetListEntries(original, items, ones, 3));
+
+    record_t *versions[4];
+    for(uint32_t x = 0; x < 4; ++x)
+        {
+        versions[x] = CopyRecord(original, plugins[x], NULL, 0, NULL, fSetAsOverride);
+        CHECK(versions[x] != NULL);
+        }
+    //The Delev plugin drops B, then the Relev plugin changes the counts of A and B
+    const FORMID kept[2] = {items[0], items[2]};
+    const int16_t relevCounts[3] = {5, 3, 1};
+    CHECK(SetListEntries(versions[0], kept, ones, 2));
+    CHECK(SetListEntries(versions[1], items, relevCounts, 3));
+    CHECK(SetListEntries(versions[2], items, ones, 4));
+    CHECK(SetListEntries(versions[3], items, ones, 5));
+
+    const uint32_t tags[2] = {fIsDelev, fIsRelev};
+    CHECK(MergeLeveledLists(patch, LVLI, plugins, tags, 2) == 1);
+    record_t *merged = NULL;
+    CHECK(GetNumRecords(patch, LVLI) == 1);
+    CHECK(GetRecordIDs(patch, LVLI, &merged) == 1);
+
+    const int16_t expected[5] = {5, 3, 1, 1, 1};
+    const uint32_t NumEntries = GetFieldAttribute(merged, 9, 0, 0, 0, 0, 0, 0, 1);
+    CHECK(NumEntries == 5);
+    for(uint32_t x = 0; x < 5; ++x)
+        {
+        uint32_t found = 0;
+        for(uint32_t y = 0; y < NumEntries; ++y)
+            {
+            FORMID *listId = (FORMID *)GetField(merged, 9, y, 3, 0, 0, 0, 0, NULL);
+            int16_t *count = (int16_t *)GetField(merged, 9, y, 4, 0, 0, 0, 0, NULL);
+            CHECK(listId != NULL && count != NULL);
+            if(*listId != items[x])
+                continue;
+            CHECK(*count == expected[x]);
+            ++found;
+            }
+        CHECK(found == 1);
+        }
+    return true;
+    }
+
+//A localized plugin's names only round trip when their string files are written alongside it
+static bool CheckStringTables(const std::string &Dir)
+    {
+    const uint32_t ACTI = SyntheticRecordType("ACTI");
+    const uint32_t Localized = 0x00000080;
+    const uint32_t flags = fIsFullLoad | fIsInLoadOrder | fIsSaveable;
+        {
+        //Records can't be created in a new Skyrim plugin, so an empty one is saved first
+        ScratchCollection scratch(Dir, eIsSkyrim);
+        mod_t *mod = scratch.AddNew("CheckStrings.esp");
+        CHECK(mod != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        CHECK(SetRecordField(GetRecordID(mod, 0, NULL), 1, &Localized, 4));
+        CHECK(SaveMod(mod, fIsWriteStrings, NULL) == 0);
+        }
+
+        {
+        ScratchCollection scratch(Dir, eIsSkyrim);
+        mod_t *mod = scratch.Add("CheckStrings.esp", flags);
+        CHECK(mod != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        record_t *keptID = CreateRecord(mod, ACTI, 0, NULL, NULL, 0);
+        record_t *editedID = CreateRecord(mod, ACTI, 0, NULL, NULL, 0);
+        CHECK(SetRecordField(keptID, 4, "CheckKept", 0));
+        CHECK(SetRecordField(editedID, 4, "CheckEdited", 0));
+        CHECK(SetRecordField(keptID, 13, "Kept Name", 0));
+        CHECK(SetRecordField(editedID, 13, "Old Name", 0));
+
+        //New names have no ids until the string files are written, so the plugin is refused without them
+        CHECK(SaveMod(mod, 0, NULL) == -1);
+        CHECK(SaveMod(mod, fIsWriteStrings, NULL) == 0);
+        }
+
+    for(uint32_t pass = 0; pass < 3; ++pass)
+        {
+        ScratchCollection scratch(Dir, eIsSkyrim);
+        mod_t *mod = scratch.Add("CheckStrings.esp", flags);
+        CHECK(mod != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        record_t *records[2];
+        CHECK(GetNumRecords(mod, ACTI) == 2);
+        CHECK(GetRecordIDs(mod, ACTI, records) == 2);
+        const char *editorID = (const char *)GetField(records[0], 4, 0, 0, 0, 0, 0, 0, NULL);
+        CHECK(editorID != NULL);
+        const bool IsKeptFirst = strcmp(editorID, "CheckKept") == 0;
+        record_t *keptID = records[IsKeptFirst ? 0 : 1];
+        record_t *editedID = records[IsKeptFirst ? 1 : 0];
+        const char *keptName = (const char *)GetField(keptID, 13, 0, 0, 0, 0, 0, 0, NULL);
+        const char *editedName = (const char *)GetField(editedID, 13, 0, 0, 0, 0, 0, 0, NULL);
+        CHECK(keptName != NULL && strcmp(keptName, "Kept Name") == 0);
+        CHECK(editedName != NULL && strcmp(editedName, pass < 2 ? "Old Name" : "New Name") == 0);
+
+        //Unchanged names keep their ids, so the plugin saves without its string files
+        if(pass == 0)
+            CHECK(SaveMod(mod, 0, NULL) == 0);
+        else if(pass == 1)
+            {
+            CHECK(SetRecordField(editedID, 13, "New Name", 0));
+            CHECK(SaveMod(mod, fIsWriteStrings, NULL) == 0);
+            }
+        }
+    return true;
+    }
+
+//Cells and LANDs that are created, copied, moved or deleted after loading are found through the grid
+static bool CheckLandGrid(const std::string &Dir)
+    {
+    const uint32_t WRLD = SyntheticRecordType("WRLD");
+    const uint32_t CELL = SyntheticRecordType("CELL");
+    const uint32_t LAND = SyntheticRecordType("LAND");
+    const uint32_t flags = fIsFullLoad | fIsCreateNew | fIsInLoadOrder | fIsSaveable | fIsIndexLANDs;
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *master = scratch.Add("CheckLandMaster.esm", flags);
+    mod_t *plugin = scratch.Add("CheckLandPlugin.esp", flags);
+    CHECK(master != NULL && plugin != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+
+    record_t *world = CreateRecord(master, WRLD, 0, (char *)"CheckWorld", NULL, 0);
+    record_t *cell = CreateRecord(master, CELL, 0, NULL, world, 0);
+    const int32_t posX = 3, posY = 4, movedY = -5;
+    CHECK(SetRecordField(cell, 32, &posX, 4));
+    CHECK(SetRecordField(cell, 33, &posY, 4));
+    record_t *land = CreateRecord(master, LAND, 0, NULL, cell, 0);
+    CHECK(land != NULL);
+    CHECK(GetWorldLand(world, posX, posY) == land);
+
+    CHECK(SetRecordField(cell, 33, &movedY, 4));
+    CHECK(GetWorldLand(world, posX, posY) == NULL);
+    CHECK(GetWorldLand(world, posX, movedY) == land);
+    record_t *lands[2];
+    CHECK(GetWorldLands(world, INT32_MIN, INT32_MIN, INT32_MAX, INT32_MAX, lands, 2) == 1);
+    CHECK(lands[0] == land);
+
+    //The plugin's version of the worldspace has its own grid
+    record_t *worldCopy = CopyRecord(world, plugin, NULL, 0, NULL, fSetAsOverride);
+    record_t *cellCopy = CopyRecord(cell, plugin, worldCopy, 0, NULL, fSetAsOverride);
+    record_t *landCopy = CopyRecord(land, plugin, cellCopy, 0, NULL, fSetAsOverride);
+    CHECK(landCopy != NULL);
+    CHECK(GetWorldLand(worldCopy, posX, movedY) == landCopy);
+    CHECK(GetWorldLand(world, posX, movedY) == land);
+
+    CHECK(DeleteRecord(cellCopy) == 1);
+    CHECK(GetWorldLand(worldCopy, posX, movedY) == NULL);
+    CHECK(GetWorldLand(world, posX, movedY) == land);
+    return true;
+    }
+
+//A snapshot describes the plugins as they are on disk, so it isn't saved over unsaved changes
+static bool CheckSnapshotChanges(const std::string &Dir)
+    {
+    const int32_t value = 1, edited = 2;
+        {
+        ScratchCollection scratch(Dir, eIsOblivion);
+        mod_t *master = scratch.AddNew("CheckSnapshot.esm");
+        CHECK(master != NULL);
+        CHECK(LoadCollection(scratch.collection, NULL) == 0);
+        CHECK(CreateGMST(master, "iCheckSnapshot", &value) != NULL);
+        CHECK(SaveMod(master, 0, NULL) == 0);
+        }
+
+    ScratchCollection scratch(Dir, eIsOblivion);
+    mod_t *master = scratch.Add("CheckSnapshot.esm", fIsFullLoad | fIsInLoadOrder);
+    CHECK(master != NULL);
+    CHECK(LoadCollection(scratch.collection, NULL) == 0);
+    const std::string FileName = Dir + "/CheckSnapshot.snapshot";
+    CHECK(SaveCollectionSnapshot(scratch.collection, (char *)FileName.c_str()) == 0);
+    CHECK(SetRecordField(GetRecordID(master, 0, (char *)"iCheckSnapshot"), 5, &edited, 4));
+    CHECK(SaveCollectionSnapshot(scratch.collection, (char *)FileName.c_str()) == -1);
+    return true;
+    }
+
+static const CheckEntry Checks[] = {
+    {"field-columns", CheckFieldColumns},
+    {"field-predicates", CheckFieldPredicates},
+    {"uncomparable-predicates", CheckUncomparablePredicates},
+    {"identical-to-master", CheckIdenticalToMaster},
+    {"stable-fingerprints", CheckStableFingerprints},
+    {"leveled-list-merge", CheckLeveledListMerge},
+    {"string-tables", CheckStringTables},
+    {"land-grid", CheckLandGrid},
+    {"snapshot-changes", CheckSnapshotChanges}
+    };
+
+int main(int argc, char *argv[])
+    {
+    std::string dir;
+    std::vector<std::string> names;
+    for(int x = 1; x < argc; ++x)
+        {
+        std::string arg(argv[x]);
+        if(arg == "--verbose")
+            IsVerbose = true;
+        else if(arg == "--list")
+            {
+            for(uint32_t c = 0; c < sizeof(Checks) / sizeof(Checks[0]); ++c)
+                printf("%s\n", Checks[c].Name);
+            return 0;
+            }
+        else if(arg.compare(0, 2, "--") == 0)
+            {
+            PrintUsage();
+            return 2;
+            }
+        else if(dir.empty())
+            dir = arg;
+        else
+            names.push_back(arg);
+        }
+    if(dir.empty())
+        {
+        PrintUsage();
+        return 2;
+        }
+    RedirectMessages(Logger);
+
+#ifdef _WIN32
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+
+    uint32_t run = 0, failed = 0;
+    for(uint32_t c = 0; c < sizeof(Checks) / sizeof(Checks[0]); ++c)
+        {
+        bool IsNamed = names.empty();
+        for(uint32_t x = 0; x < names.size() && !IsNamed; ++x)
+            IsNamed = names[x] == Checks[c].Name;
+        if(!IsNamed)
+            continue;
+        bool passed = Checks[c].Run(dir);
+        printf("%s %s\n", passed ? "PASS" : "FAIL", Checks[c].Name);
+        fflush(stdout);
+        ++run;
+        if(!passed)
+            ++failed;
+        }
+    if(run == 0)
+        {
+        fputs("No check matches the given names. Use --list to see them.\n", stderr);
+        return 2;
+        }
+    printf("%u of %u checks passed\n", run - failed, run);
+    return failed == 0 ? 0 : 1;
+    }
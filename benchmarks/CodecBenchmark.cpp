@@ -0,0 +1,363 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// CodecBenchmark.cpp
+// Times each record type's parse, VisitFormIDs, equals and write, and counts the heap allocations they make.
+#include "CBash.h"
+#include "Collection.h"
+#include "Synthetic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+//Every allocation in the process goes through these, including CBash's own and those of any worker threads
+static std::atomic<uint64_t> NumAllocations(0);
+static std::atomic<uint64_t> AllocatedBytes(0);
+
+void * operator new(size_t size)
+    {
+    NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void *ptr = malloc(size ? size : 1);
+    if(ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+    }
+
+void * operator new[](size_t size)
+    {
+    return operator new(size);
+    }
+
+void operator delete(void *ptr) NOEXCEPT
+    {
+    free(ptr);
+    }
+
+void operator delete[](void *ptr) NOEXCEPT
+    {
+    free(ptr);
+    }
+
+//C++14 compilers call the sized forms where the size is known, so they must also release through free
+void operator delete(void *ptr, size_t) NOEXCEPT
+    {
+    free(ptr);
+    }
+
+void operator delete[](void *ptr, size_t) NOEXCEPT
+    {
+    free(ptr);
+    }
+
+struct AllocationMark
+    {
+    uint64_t Allocations;
+    uint64_t Bytes;
+
+    AllocationMark():
+        Allocations(NumAllocations.load(std::memory_order_relaxed)),
+        Bytes(AllocatedBytes.load(std::memory_order_relaxed))
+        {
+        //
+        }
+    };
+
+struct OpCost
+    {
+    double Seconds;
+    uint64_t Allocations;
+    uint64_t Bytes;
+
+    OpCost():
+        Seconds(0.0),
+        Allocations(0),
+        Bytes(0)
+        {
+        //
+        }
+
+    void Add(const std::chrono::steady_clock::time_point &Start, const AllocationMark &Mark)
+        {
+        Seconds += SyntheticSeconds(Start);
+        Allocations += NumAllocations.load(std::memory_order_relaxed) - Mark.Allocations;
+        Bytes += AllocatedBytes.load(std::memory_order_relaxed) - Mark.Bytes;
+        }
+    };
+
+struct TypeResult
+    {
+    uint64_t NumRecords;
+    uint64_t NumCompressed;
+    uint64_t DiskBytes;
+    uint64_t NumFormIDs;
+    std::vector<Record *> Samples;
+    OpCost Parse;
+    OpCost Visit;
+    OpCost Equals;
+    OpCost Write;
+
+    TypeResult():
+        NumRecords(0),
+        NumCompressed(0),
+        DiskBytes(0),
+        NumFormIDs(0)
+        {
+        //
+        }
+    };
+
+class FormIDCounter : public FormIDOp
+    {
+    public:
+        FormIDCounter() {}
+        ~FormIDCounter() {}
+
+        bool Accept(uint32_t &)
+            {
+            ++count;
+            return stop;
+            }
+
+        bool AcceptMGEF(uint32_t &)
+            {
+            ++count;
+            return stop;
+            }
+    };
+
+//Groups the records read from disk by type, keeping up to MaxSamples of each
+class SampleCollector : public RecordOp
+    {
+    private:
+        std::map<uint32_t, TypeResult> &Results;
+        const uint32_t MaxSamples;
+        const int32_t SizeDistance;
+
+    public:
+        SampleCollector(std::map<uint32_t, TypeResult> &_Results, const uint32_t _MaxSamples, const int32_t _SizeDistance):
+            RecordOp(),
+            Results(_Results),
+            MaxSamples(_MaxSamples),
+            SizeDistance(_SizeDistance)
+            {
+            //
+            }
+
+        bool Accept(Record *&curRecord)
+            {
+            if(curRecord->recData == NULL || curRecord->IsChanged() || curRecord->GetType() == REV32(TES4))
+                return false;
+            TypeResult &result = Results[curRecord->GetType()];
+            ++result.NumRecords;
+            if(result.Samples.size() >= MaxSamples)
+                return false;
+            result.Samples.push_back(curRecord);
+            result.DiskBytes += *(uint32_t *)&curRecord->recData[-SizeDistance];
+            if((*(uint32_t *)&curRecord->recData[-SizeDistance + 4] & 0x00040000) != 0)
+                ++result.NumCompressed;
+            return false;
+            }
+    };
+
+static void PrintUsage()
+    {
+    fputs("Usage: cbash-codecbench --game oblivion|fnv|skyrim --dir DIR [options] PLUGIN...\n"
+          "  --samples N      Records of each type to measure (default 1000)\n"
+          "  --iterations N   Times each sample is measured (default 10)\n"
+          "  --out FILE       Write the table to FILE instead of stdout\n"
+          "Records are taken from the plugins as loaded, so the measured types are the ones\n"
+          "the plugins contain. Plugins written by cbash-genplugins work as input.\n"
+          "The table is comma separated, one row per record type. Times are nanoseconds and\n"
+          "allocations are counts and bytes, each averaged per record per operation.\n", stderr);
+    }
+
+static int32_t Logger(const char *Message)
+    {
+    fputs(Message, stderr);
+    return 0;
+    }
+
+static void Measure(TypeResult &Result, const uint32_t Iterations, FileWriter &Writer)
+    {
+    std::vector<Record *> &samples = Result.Samples;
+    FormIDCounter counter;
+    for(uint32_t i = 0; i < Iterations; ++i)
+        {
+        for(uint32_t x = 0; x < samples.size(); ++x)
+            samples[x]->Unload();
+
+        AllocationMark mark;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(uint32_t x = 0; x < samples.size(); ++x)
+            samples[x]->Read();
+        Result.Parse.Add(start, mark);
+
+        counter.ResetCount();
+        mark = AllocationMark();
+        start = std::chrono::steady_clock::now();
+        for(uint32_t x = 0; x < samples.size(); ++x)
+            samples[x]->VisitFormIDs(counter);
+        Result.Visit.Add(start, mark);
+        Result.NumFormIDs = counter.GetCount();
+
+        //Comparing a record with itself walks every field, as an identical to master check does
+        uint32_t numEqual = 0;
+        mark = AllocationMark();
+        start = std::chrono::steady_clock::now();
+        for(uint32_t x = 0; x < samples.size(); ++x)
+            numEqual += samples[x]->equals(samples[x]) ? 1 : 0;
+        Result.Equals.Add(start, mark);
+        if(numEqual != samples.size())
+            fprintf(stderr, "Warning - %u %s records didn't compare equal to themselves.\n", (uint32_t)samples.size() - numEqual, samples[0]->GetStrType());
+
+        mark = AllocationMark();
+        start = std::chrono::steady_clock::now();
+        for(uint32_t x = 0; x < samples.size(); ++x)
+            {
+            samples[x]->WriteRecord(Writer);
+            if(samples[x]->IsCompressed())
+                Writer.record_compress();
+            Writer.record_clear();
+            }
+        Result.Write.Add(start, mark);
+        }
+    for(uint32_t x = 0; x < samples.size(); ++x)
+        samples[x]->Unload();
+    }
+
+static void PrintCost(FILE *Output, const OpCost &Cost, const double Count)
+    {
+    fprintf(Output, ",%.1f,%.2f,%.1f", Cost.Seconds * 1e9 / Count, Cost.Allocations / Count, Cost.Bytes / Count);
+    }
+
+int main(int argc, char *argv[])
+    {
+    const SyntheticGame *game = NULL;
+    std::string dir;
+    std::string outName;
+    uint32_t numSamples = 1000;
+    uint32_t numIterations = 10;
+    std::vector<std::string> plugins;
+    for(int x = 1; x < argc; ++x)
+        {
+        std::string arg(argv[x]);
+        if(arg.compare(0, 2, "--") != 0)
+            plugins.push_back(arg);
+        else if(x + 1 >= argc)
+            {
+            PrintUsage();
+            return 2;
+            }
+        else if(arg == "--game")
+            game = FindSyntheticGame(argv[++x]);
+        else if(arg == "--dir")
+            dir = argv[++x];
+        else if(arg == "--samples")
+            numSamples = (uint32_t)strtoul(argv[++x], NULL, 10);
+        else if(arg == "--iterations")
+            numIterations = (uint32_t)strtoul(argv[++x], NULL, 10);
+        else if(arg == "--out")
+            outName = argv[++x];
+        else
+            {
+            PrintUsage();
+            return 2;
+            }
+        }
+    if(game == NULL || dir.empty() || plugins.empty() || numSamples == 0 || numIterations == 0)
+        {
+        PrintUsage();
+        return 2;
+        }
+    RedirectMessages(Logger);
+
+    collection_t *collection = CreateCollection((char *)dir.c_str(), game->CollectionType);
+    if(collection == NULL)
+        return 1;
+    std::vector<mod_t *> mods;
+    for(uint32_t p = 0; p < plugins.size(); ++p)
+        mods.push_back(AddMod(collection, (char *)plugins[p].c_str(), fIsFullLoad | fIsInLoadOrder | fIsAddMasters));
+    if(LoadCollection(collection, NULL) != 0)
+        {
+        DeleteCollection(collection);
+        return 1;
+        }
+
+    std::map<uint32_t, TypeResult> results;
+    SampleCollector collector(results, numSamples, game->CollectionType == eIsOblivion ? 16 : 20);
+    for(uint32_t p = 0; p < mods.size(); ++p)
+        if(mods[p] != NULL)
+            mods[p]->VisitAllRecords(collector);
+
+    FileWriter writer(NULL, BUFFERSIZE);
+    for(std::map<uint32_t, TypeResult>::iterator it = results.begin(); it != results.end(); ++it)
+        Measure(it->second, numIterations, writer);
+
+    FILE *output = outName.empty() ? stdout : fopen(outName.c_str(), "w");
+    if(output == NULL)
+        {
+        fprintf(stderr, "Unable to write \"%s\".\n", outName.c_str());
+        DeleteCollection(collection);
+        return 1;
+        }
+    fprintf(output, "game,type,records,sampled,compressed,disk_bytes,formids"
+                    ",parse_ns,parse_allocs,parse_alloc_bytes"
+                    ",visit_ns,visit_allocs,visit_alloc_bytes"
+                    ",equals_ns,equals_allocs,equals_alloc_bytes"
+                    ",write_ns,write_allocs,write_alloc_bytes\n");
+    for(std::map<uint32_t, TypeResult>::iterator it = results.begin(); it != results.end(); ++it)
+        {
+        const TypeResult &result = it->second;
+        if(result.Samples.empty())
+            continue;
+        double count = (double)result.Samples.size() * numIterations;
+        fprintf(output, "%s,%.4s,%llu,%u,%llu,%llu,%llu", game->Name, (char *)&it->first, (unsigned long long)result.NumRecords, (uint32_t)result.Samples.size(),
+                (unsigned long long)result.NumCompressed, (unsigned long long)result.DiskBytes, (unsigned long long)result.NumFormIDs);
+        PrintCost(output, result.Parse, count);
+        PrintCost(output, result.Visit, count);
+        PrintCost(output, result.Equals, count);
+        PrintCost(output, result.Write, count);
+        fputc('\n', output);
+        }
+    if(output != stdout)
+        fclose(output);
+    DeleteCollection(collection);
+    return 0;
+    }
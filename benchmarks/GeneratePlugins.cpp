@@ -0,0 +1,450 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// GeneratePlugins.cpp
+// Writes a set of synthetic but loadable plugins for the benchmark driver.
+#include "Synthetic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+    #include <direct.h>
+#endif
+
+struct MixEntry
+    {
+    std::string Name;
+    uint32_t FullFieldID;
+    uint32_t Weight;
+    bool IsPlaceable;
+    };
+
+struct GeneratedRecord
+    {
+    record_t *Record;
+    uint32_t FullFieldID;
+    };
+
+struct GeneratorOptions
+    {
+    const SyntheticGame *Game;
+    std::string OutDir;
+    uint32_t NumPlugins;
+    uint32_t NumRecords;
+    uint32_t Depth;
+    uint32_t NumCells;
+    uint32_t NumRefs;
+    double CompressedFraction;
+    double OverrideFraction;
+    uint32_t Seed;
+    bool IsVerbose;
+    std::vector<MixEntry> Mix;
+    };
+
+static bool IsVerbose = false;
+
+static int32_t Logger(const char *Message)
+    {
+    if(IsVerbose)
+        fputs(Message, stderr);
+    return 0;
+    }
+
+static void PrintUsage()
+    {
+    fputs("Usage: cbash-genplugins --out DIR [options]\n"
+          "  --game oblivion|fnv|skyrim  Plugin format to write (default oblivion)\n"
+          "  --plugins N                 Number of plugins, the first is written as an esm (default 4)\n"
+          "  --records N                 New top level records per plugin (default 10000)\n"
+          "  --mix TYPE:W[,TYPE:W...]    Record type weights, replacing the game's default mix\n"
+          "  --compressed F              Fraction of records flagged as compressed (default 0.25)\n"
+          "  --overrides F               Overrides of earlier plugins' records, as a fraction of --records (default 0.2)\n"
+          "  --depth 0|1|2               0 for no cells, 1 for interior CELL>REFR, 2 for WRLD>CELL>REFR (default 2)\n"
+          "  --cells N                   Cells per plugin when --depth is set (default 64)\n"
+          "  --refs N                    Placed references per cell (default 16)\n"
+          "  --seed N                    Random seed (default 1)\n"
+          "  --verbose                   Show CBash's messages\n", stderr);
+    }
+
+static bool ParseMix(const char *Value, const SyntheticGame *Game, std::vector<MixEntry> &Mix)
+    {
+    Mix.clear();
+    std::string value(Value);
+    size_t start = 0;
+    while(start < value.size())
+        {
+        size_t end = value.find(',', start);
+        if(end == std::string::npos)
+            end = value.size();
+        std::string item = value.substr(start, end - start);
+        start = end + 1;
+        size_t colon = item.find(':');
+        if(colon != 4)
+            return false;
+        MixEntry entry;
+        entry.Name = item.substr(0, 4);
+        entry.Weight = (uint32_t)strtoul(item.c_str() + 5, NULL, 10);
+        entry.FullFieldID = 0;
+        entry.IsPlaceable = false;
+        for(uint32_t x = 0; x < Game->NumTypes; ++x)
+            if(entry.Name == Game->Types[x].Name)
+                {
+                entry.FullFieldID = Game->Types[x].FullFieldID;
+                entry.IsPlaceable = Game->Types[x].IsPlaceable;
+                }
+        if(entry.Weight != 0)
+            Mix.push_back(entry);
+        }
+    return !Mix.empty();
+    }
+
+static bool ParseOptions(int argc, char *argv[], GeneratorOptions &Options)
+    {
+    const char *mix = NULL;
+    Options.Game = FindSyntheticGame("oblivion");
+    Options.NumPlugins = 4;
+    Options.NumRecords = 10000;
+    Options.Depth = 2;
+    Options.NumCells = 64;
+    Options.NumRefs = 16;
+    Options.CompressedFraction = 0.25;
+    Options.OverrideFraction = 0.2;
+    Options.Seed = 1;
+    Options.IsVerbose = false;
+    for(int x = 1; x < argc; ++x)
+        {
+        std::string arg(argv[x]);
+        if(arg == "--verbose")
+            {
+            Options.IsVerbose = true;
+            continue;
+            }
+        if(x + 1 >= argc)
+            return false;
+        const char *value = argv[++x];
+        if(arg == "--game")
+            {
+            Options.Game = FindSyntheticGame(value);
+            if(Options.Game == NULL)
+                return false;
+            }
+        else if(arg == "--out")
+            Options.OutDir = value;
+        else if(arg == "--plugins")
+            Options.NumPlugins = (uint32_t)strtoul(value, NULL, 10);
+        else if(arg == "--records")
+            Options.NumRecords = (uint32_t)strtoul(value, NULL, 10);
+        else if(arg == "--mix")
+            mix = value;
+        else if(arg == "--compressed")
+            Options.CompressedFraction = atof(value);
+        else if(arg == "--overrides")
+            Options.OverrideFraction = atof(value);
+        else if(arg == "--depth")
+            Options.Depth = (uint32_t)strtoul(value, NULL, 10);
+        else if(arg == "--cells")
+            Options.NumCells = (uint32_t)strtoul(value, NULL, 10);
+        else if(arg == "--refs")
+            Options.NumRefs = (uint32_t)strtoul(value, NULL, 10);
+        else if(arg == "--seed")
+            Options.Seed = (uint32_t)strtoul(value, NULL, 10);
+        else
+            return false;
+        }
+    if(mix != NULL)
+        {
+        if(!ParseMix(mix, Options.Game, Options.Mix))
+            return false;
+        }
+    else
+        {
+        for(uint32_t x = 0; x < Options.Game->NumTypes; ++x)
+            {
+            MixEntry entry;
+            entry.Name = Options.Game->Types[x].Name;
+            entry.FullFieldID = Options.Game->Types[x].FullFieldID;
+            entry.Weight = Options.Game->Types[x].Weight;
+            entry.IsPlaceable = Options.Game->Types[x].IsPlaceable;
+            Options.Mix.push_back(entry);
+            }
+        }
+    //The patch made by the benchmark also needs a load order slot
+    return !Options.OutDir.empty() && Options.NumPlugins != 0 && Options.NumPlugins < 255 && Options.Depth <= 2;
+    }
+
+static void SetString(record_t *Record, const uint32_t FieldID, const std::string &Value)
+    {
+    SetField(Record, FieldID, 0, 0, 0, 0, 0, 0, (void *)Value.c_str(), 0);
+    }
+
+static void SetCompressed(record_t *Record)
+    {
+    //Field 1 is the whole header flags word, so the other flags are kept
+    uint32_t *current = (uint32_t *)GetField(Record, 1, 0, 0, 0, 0, 0, 0, NULL);
+    uint32_t flags = (current != NULL ? *current : 0) | 0x00040000; //fIsCompressed
+    SetField(Record, 1, 0, 0, 0, 0, 0, 0, &flags, 0);
+    }
+
+int main(int argc, char *argv[])
+    {
+    GeneratorOptions options;
+    if(!ParseOptions(argc, argv, options))
+        {
+        PrintUsage();
+        return 2;
+        }
+    IsVerbose = options.IsVerbose;
+    RedirectMessages(Logger);
+
+#ifdef _WIN32
+    _mkdir(options.OutDir.c_str());
+#else
+    mkdir(options.OutDir.c_str(), 0755);
+#endif
+
+    std::mt19937 rng(options.Seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    uint32_t totalWeight = 0;
+    for(uint32_t x = 0; x < options.Mix.size(); ++x)
+        totalWeight += options.Mix[x].Weight;
+    std::uniform_int_distribution<uint32_t> pickWeight(0, totalWeight - 1);
+
+    collection_t *collection = CreateCollection((char *)options.OutDir.c_str(), options.Game->CollectionType);
+    if(collection == NULL)
+        {
+        fprintf(stderr, "Unable to create a collection in \"%s\".\n", options.OutDir.c_str());
+        return 1;
+        }
+
+    std::vector<std::string> names;
+    std::vector<mod_t *> mods;
+    for(uint32_t p = 0; p < options.NumPlugins; ++p)
+        {
+        char name[32];
+        sprintf(name, "Synthetic%03u.%s", p, p == 0 ? "esm" : "esp");
+        names.push_back(name);
+        mods.push_back(AddMod(collection, name, fIsCreateNew | fIsInLoadOrder | fIsSaveable));
+        if(mods.back() == NULL)
+            {
+            fprintf(stderr, "Unable to add \"%s\".\n", name);
+            DeleteCollection(collection);
+            return 1;
+            }
+        }
+    if(LoadCollection(collection, NULL) != 0)
+        {
+        fprintf(stderr, "Unable to load the collection.\n");
+        DeleteCollection(collection);
+        return 1;
+        }
+
+    //Records from earlier plugins, which later plugins pick their overrides from
+    std::vector<GeneratedRecord> pool;
+    std::vector<uint64_t> counts(options.NumPlugins, 0);
+    uint32_t side = 1;
+    while(side * side < options.NumCells)
+        ++side;
+
+    for(uint32_t p = 0; p < options.NumPlugins; ++p)
+        {
+        mod_t *mod = mods[p];
+        std::vector<GeneratedRecord> created;
+        std::vector<record_t *> bases;
+        char eid[64];
+
+        for(uint32_t r = 0; r < options.NumRecords; ++r)
+            {
+            uint32_t pick = pickWeight(rng);
+            uint32_t t = 0;
+            while(pick >= options.Mix[t].Weight)
+                pick -= options.Mix[t++].Weight;
+            const MixEntry &type = options.Mix[t];
+            sprintf(eid, "Syn%03u%s%06u", p, type.Name.c_str(), r);
+            record_t *record = CreateRecord(mod, SyntheticRecordType(type.Name.c_str()), 0, eid, NULL, 0);
+            if(record == NULL)
+                {
+                fprintf(stderr, "Unable to create a %s record in \"%s\".\n", type.Name.c_str(), names[p].c_str());
+                DeleteCollection(collection);
+                return 1;
+                }
+            if(type.FullFieldID != 0)
+                SetString(record, type.FullFieldID, std::string("Synthetic ") + type.Name + " " + std::to_string(r) + " of plugin " + std::to_string(p));
+            if(chance(rng) < options.CompressedFraction)
+                SetCompressed(record);
+            GeneratedRecord generated = {record, type.FullFieldID};
+            created.push_back(generated);
+            if(type.IsPlaceable)
+                bases.push_back(record);
+            }
+        counts[p] += options.NumRecords;
+
+        if(!pool.empty())
+            {
+            uint32_t numOverrides = (uint32_t)(options.OverrideFraction * options.NumRecords);
+            std::uniform_int_distribution<size_t> pickRecord(0, pool.size() - 1);
+            std::set<record_t *> overrides;
+            for(uint32_t r = 0; r < numOverrides; ++r)
+                {
+                const GeneratedRecord &source = pool[pickRecord(rng)];
+                record_t *record = CopyRecord(source.Record, mod, NULL, 0, NULL, fSetAsOverride);
+                if(record == NULL)
+                    continue;
+                overrides.insert(record);
+                if(source.FullFieldID != 0)
+                    SetString(record, source.FullFieldID, "Overridden by plugin " + std::to_string(p));
+                else
+                    {
+                    sprintf(eid, "Syn%03uOverride%06u", p, r);
+                    SetString(record, 4, eid);
+                    }
+                if(chance(rng) < options.CompressedFraction)
+                    SetCompressed(record);
+                }
+            //Picking the same source twice returns the existing override
+            counts[p] += overrides.size();
+            }
+
+        if(options.Depth != 0)
+            {
+            record_t *world = NULL;
+            if(options.Depth == 2)
+                {
+                sprintf(eid, "Syn%03uWorld", p);
+                world = CreateRecord(mod, SyntheticRecordType("WRLD"), 0, eid, NULL, 0);
+                if(world == NULL)
+                    {
+                    fprintf(stderr, "Unable to create a WRLD record in \"%s\".\n", names[p].c_str());
+                    DeleteCollection(collection);
+                    return 1;
+                    }
+                SetString(world, options.Game->CellFullFieldID, "Synthetic world " + std::to_string(p));
+                ++counts[p];
+                }
+            //Every placed reference needs a base object
+            if(bases.empty() && options.NumRefs != 0)
+                {
+                sprintf(eid, "Syn%03uBase", p);
+                record_t *base = CreateRecord(mod, SyntheticRecordType(options.Game->RefBaseType), 0, eid, NULL, 0);
+                if(base == NULL)
+                    {
+                    fprintf(stderr, "Unable to create a %s record in \"%s\".\n", options.Game->RefBaseType, names[p].c_str());
+                    DeleteCollection(collection);
+                    return 1;
+                    }
+                bases.push_back(base);
+                ++counts[p];
+                }
+            std::uniform_int_distribution<size_t> pickBase(0, bases.empty() ? 0 : bases.size() - 1);
+            for(uint32_t c = 0; c < options.NumCells; ++c)
+                {
+                sprintf(eid, "Syn%03uCell%05u", p, c);
+                record_t *cell = CreateRecord(mod, SyntheticRecordType("CELL"), 0, eid, world, 0);
+                if(cell == NULL)
+                    {
+                    fprintf(stderr, "Unable to create a CELL record in \"%s\".\n", names[p].c_str());
+                    DeleteCollection(collection);
+                    return 1;
+                    }
+                if(world != NULL)
+                    {
+                    int32_t posX = (int32_t)(c % side) - (int32_t)(side / 2);
+                    int32_t posY = (int32_t)(c / side) - (int32_t)(side / 2);
+                    SetField(cell, options.Game->CellPosXFieldID, 0, 0, 0, 0, 0, 0, &posX, 0);
+                    SetField(cell, options.Game->CellPosYFieldID, 0, 0, 0, 0, 0, 0, &posY, 0);
+                    }
+                else
+                    SetString(cell, options.Game->CellFullFieldID, "Synthetic cell " + std::to_string(c));
+                if(chance(rng) < options.CompressedFraction)
+                    SetCompressed(cell);
+                ++counts[p];
+
+                for(uint32_t r = 0; r < options.NumRefs; ++r)
+                    {
+                    record_t *ref = CreateRecord(mod, SyntheticRecordType("REFR"), 0, NULL, cell, 0);
+                    if(ref == NULL)
+                        {
+                        fprintf(stderr, "Unable to create a REFR record in \"%s\".\n", names[p].c_str());
+                        DeleteCollection(collection);
+                        return 1;
+                        }
+                    FORMID *base = (FORMID *)GetField(bases[pickBase(rng)], 2, 0, 0, 0, 0, 0, 0, NULL);
+                    if(base != NULL)
+                        SetField(ref, options.Game->RefBaseFieldID, 0, 0, 0, 0, 0, 0, base, 0);
+                    ++counts[p];
+                    }
+                }
+            }
+
+        pool.insert(pool.end(), created.begin(), created.end());
+        }
+
+    for(uint32_t p = 0; p < options.NumPlugins; ++p)
+        if(SaveMod(mods[p], 0, NULL) != 0)
+            {
+            fprintf(stderr, "Unable to save \"%s\".\n", names[p].c_str());
+            DeleteCollection(collection);
+            return 1;
+            }
+    DeleteCollection(collection);
+
+    std::string manifestPath = options.OutDir + "/" SYNTHETIC_MANIFEST;
+    FILE *manifest = fopen(manifestPath.c_str(), "w");
+    if(manifest == NULL)
+        {
+        fprintf(stderr, "Unable to write \"%s\".\n", manifestPath.c_str());
+        return 1;
+        }
+    fprintf(manifest, "game %s\n", options.Game->Name);
+    uint64_t totalRecords = 0;
+    uint64_t totalBytes = 0;
+    for(uint32_t p = 0; p < options.NumPlugins; ++p)
+        {
+        struct stat buf;
+        std::string path = options.OutDir + "/" + names[p];
+        uint64_t size = stat(path.c_str(), &buf) == 0 ? (uint64_t)buf.st_size : 0;
+        fprintf(manifest, "%s %llu\n", names[p].c_str(), (unsigned long long)counts[p]);
+        printf("%s: %llu records, %llu bytes\n", names[p].c_str(), (unsigned long long)counts[p], (unsigned long long)size);
+        totalRecords += counts[p];
+        totalBytes += size;
+        }
+    fclose(manifest);
+    printf("Wrote %u plugins, %llu records, %llu bytes to \"%s\".\n", options.NumPlugins, (unsigned long long)totalRecords, (unsigned long long)totalBytes, options.OutDir.c_str());
+    return 0;
+    }
@@ -0,0 +1,121 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#pragma once
+// Synthetic.h
+#include "CBash.h"
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+
+//Shared by the synthetic plugin generator and the benchmark driver.
+//The generator writes the manifest next to the plugins. Its first line is
+// "game <name>", then each plugin follows in load order as "<filename> <records>".
+//The record counts come from the generator since GetNumRecords can't count
+// placed references for every game.
+#define SYNTHETIC_MANIFEST "synthetic.txt"
+
+struct SyntheticType
+    {
+    const char *Name;
+    uint32_t FullFieldID; //0 if the record type has no FULL subrecord
+    uint32_t Weight; //Relative share of the generated records
+    bool IsPlaceable; //Whether a placed reference can use it as its base object
+    };
+
+struct SyntheticGame
+    {
+    const char *Name;
+    uint32_t CollectionType;
+    const SyntheticType *Types;
+    uint32_t NumTypes;
+    uint32_t CellFullFieldID;
+    uint32_t CellPosXFieldID;
+    uint32_t CellPosYFieldID;
+    uint32_t RefBaseFieldID;
+    const char *RefBaseType; //Created as the base of placed references if a plugin has no placeable records
+    };
+
+static const SyntheticType OblivionTypes[] = {
+    {"MISC", 5, 30, true},
+    {"WEAP", 5, 15, true},
+    {"ARMO", 5, 15, true},
+    {"BOOK", 5, 10, true},
+    {"CONT", 5, 10, true},
+    {"NPC_", 5, 20, false}
+    };
+
+static const SyntheticType FalloutNewVegasTypes[] = {
+    {"MISC", 13, 30, true},
+    {"WEAP", 13, 15, true},
+    {"ARMO", 13, 15, true},
+    {"BOOK", 13, 10, true},
+    {"CONT", 13, 10, true},
+    {"NPC_", 13, 20, false}
+    };
+
+static const SyntheticType SkyrimTypes[] = {
+    {"ACTI", 13, 25, true},
+    {"ALCH", 13, 20, true},
+    {"APPA", 13, 10, true},
+    {"KYWD", 0, 15, false},
+    {"LVLI", 0, 10, false},
+    {"NPC_", 0, 20, false}
+    };
+
+static const SyntheticGame SyntheticGames[] = {
+    {"oblivion", eIsOblivion, OblivionTypes, sizeof(OblivionTypes) / sizeof(OblivionTypes[0]), 5, 32, 33, 5, "MISC"},
+    {"fnv", eIsFalloutNewVegas, FalloutNewVegasTypes, sizeof(FalloutNewVegasTypes) / sizeof(FalloutNewVegasTypes[0]), 7, 9, 10, 7, "MISC"},
+    {"skyrim", eIsSkyrim, SkyrimTypes, sizeof(SkyrimTypes) / sizeof(SkyrimTypes[0]), 7, 9, 10, 7, "ACTI"}
+    };
+
+inline const SyntheticGame * FindSyntheticGame(const char *Name)
+    {
+    for(uint32_t x = 0; x < sizeof(SyntheticGames) / sizeof(SyntheticGames[0]); ++x)
+        if(strcmp(SyntheticGames[x].Name, Name) == 0)
+            return &SyntheticGames[x];
+    return NULL;
+    }
+
+//Converts a 4 character record name into the value the API expects, eg. "CELL" to 'LLEC'
+inline uint32_t SyntheticRecordType(const char *Name)
+    {
+    return (uint32_t)(uint8_t)Name[0] | ((uint32_t)(uint8_t)Name[1] << 8) | ((uint32_t)(uint8_t)Name[2] << 16) | ((uint32_t)(uint8_t)Name[3] << 24);
+    }
+
+inline double SyntheticSeconds(const std::chrono::steady_clock::time_point &Start)
+    {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    }
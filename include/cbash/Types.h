@@ -55,6 +55,9 @@ extern "C"
 typedef struct Collection collection_t;
 typedef struct ModFile mod_t;
 typedef struct Record record_t;
+typedef struct RecordCursor cursor_t;
+typedef struct LoadTask load_task_t;
+typedef struct Snapshot snapshot_t;
 
 typedef uint32_t FORMID;
 
@@ -62,6 +65,152 @@ typedef uint32_t FORMID;
     #define FIELD_IDENTIFIERS const uint32_t FieldID, const uint32_t ListIndex, const uint32_t ListFieldID, const uint32_t ListX2Index, const uint32_t ListX2FieldID, const uint32_t ListX3Index, const uint32_t ListX3FieldID
 #endif
 
+/**
+    @brief The seven identifiers that select a single field, bundled for the batched field functions.
+    @details The members have the same meaning as the ::FIELD_IDENTIFIERS
+             parameters taken by GetField() and SetField().
+*/
+typedef struct {
+    uint32_t FieldID; ///< The field ID.
+    uint32_t ListIndex; ///< The index of the list element, if the field is a list.
+    uint32_t ListFieldID; ///< The field ID within the list element.
+    uint32_t ListX2Index; ///< The index of the nested list element.
+    uint32_t ListX2FieldID; ///< The field ID within the nested list element.
+    uint32_t ListX3Index; ///< The index of the doubly nested list element.
+    uint32_t ListX3FieldID; ///< The field ID within the doubly nested list element.
+} FieldSpec;
+
+/**
+    @brief Comparison operators used by ::FieldPredicate.
+*/
+typedef enum {
+    eOpEqual = 0, ///< The field equals the constant.
+    eOpNotEqual, ///< The field does not equal the constant.
+    eOpLess, ///< The field is less than the constant.
+    eOpLessEqual, ///< The field is less than or equal to the constant.
+    eOpGreater, ///< The field is greater than the constant.
+    eOpGreaterEqual ///< The field is greater than or equal to the constant.
+} comparisonOperators;
+
+/**
+    @brief How a ::FieldPredicate is combined with the predicate before it.
+    @details AND binds tighter than OR, so `a AND b OR c AND d` is evaluated
+             as `(a AND b) OR (c AND d)`.
+*/
+typedef enum {
+    eJoinAnd = 0, ///< Both predicates must hold.
+    eJoinOr ///< Either predicate may hold.
+} predicateJoins;
+
+/**
+    @brief A comparison of a field against a constant, evaluated natively by GetMatchingRecordIDs().
+    @details Numeric, FormID and flag fields are compared against \p Value.
+             String fields are compared against \p String, and only support
+             ::eOpEqual and ::eOpNotEqual. A record that doesn't have the field
+             fails the predicate, whatever the operator.
+*/
+typedef struct {
+    FieldSpec Field; ///< The field to compare.
+    uint32_t Operator; ///< The comparison, one of ::comparisonOperators.
+    uint32_t Join; ///< How the predicate joins the one before it, one of ::predicateJoins. Ignored for the first predicate.
+    /**
+        @brief The subrecord type that holds the field, such as `'DATA'`, or `0` if unknown.
+        @details If every predicate gives its subrecord, records are only
+                 partially decoded to evaluate them.
+    */
+    uint32_t SubrecordType;
+    double Value; ///< The constant for numeric fields.
+    const char *String; ///< The constant for string fields, or `NULL`.
+} FieldPredicate;
+
+/**
+    @brief The kinds of difference reported by DiffMods().
+*/
+typedef enum {
+    eDiffAdded = 0, ///< The record is only in the second plugin.
+    eDiffRemoved, ///< The record is only in the first plugin.
+    eDiffModified ///< The record is in both plugins, but its data differs.
+} diffChanges;
+
+/**
+    @brief Flags that specify how a plugin's leveled lists are merged by MergeLeveledLists().
+*/
+typedef enum {
+    fIsRelev = 0x00000001, ///< The plugin's changes to entry levels and counts, chance none and flags take precedence.
+    fIsDelev = 0x00000002  ///< Entries the plugin removed from the original list are removed from the merged list.
+} levListTags;
+
+/**
+    @brief The states of a load started by LoadCollectionAsync().
+*/
+typedef enum {
+    eLoadRunning = 0, ///< The collection is still loading.
+    eLoadFinished, ///< The collection loaded successfully.
+    eLoadCancelled, ///< The load was cancelled before it finished.
+    eLoadFailed ///< The load stopped because of an error.
+} loadStates;
+
+/**
+    @brief A snapshot of the progress of a load started by LoadCollectionAsync().
+    @details Byte counts are updated between the top level record groups of
+             each plugin, so a plugin with a large worldspace group advances
+             in bigger steps.
+*/
+typedef struct {
+    uint32_t State; ///< The state of the load, one of ::loadStates.
+    uint32_t ModIndex; ///< The index of the plugin being loaded.
+    uint32_t NumMods; ///< The number of plugins to load, including added masters. `0` until the masters have been added.
+    const char *ModName; ///< The filename of the plugin being loaded, or `NULL` if ::NumMods is `0`.
+    uint64_t ModBytesRead; ///< The bytes of the current plugin processed so far.
+    uint64_t ModBytesTotal; ///< The size of the current plugin.
+    uint64_t BytesRead; ///< The bytes of all plugins processed so far.
+    uint64_t BytesTotal; ///< The total size of all plugins, or `0` if ::NumMods is `0`.
+} LoadProgress;
+
+/**
+    @brief A plugin stored in a collection snapshot, as filled by GetSnapshotModInfo().
+    @details The strings and tables point into the snapshot, and are valid
+             until it is closed.
+*/
+typedef struct {
+    const char *FileName; ///< The filename of the plugin.
+    const char *ModName; ///< The name of the plugin, without any ghosting extension.
+    uint32_t Flags; ///< The flags the plugin was added with, a combination of ::modFlags.
+    bool IsPresent; ///< Whether the plugin existed when the snapshot was saved.
+    uint8_t ExpandedIndex; ///< The load order index of the plugin.
+    uint8_t CollapsedIndex; ///< The number of masters of the plugin.
+    const uint8_t *ExpandTable; ///< 256 entries mapping the on disk mod index of a FormID to its load order index.
+    const uint8_t *CollapseTable; ///< 256 entries mapping a load order index to the on disk mod index.
+} SnapshotModInfo;
+
+/**
+    @brief A record stored in a collection snapshot, as filled by the snapshot query functions.
+    @details The record data isn't stored in the snapshot. It can be read
+             from the plugin at \p Offset, which holds the record header.
+*/
+typedef struct {
+    FORMID FormID; ///< The FormID of the record, using the load order of the collection.
+    uint32_t Type; ///< The record type, such as `'WEAP'`.
+    uint32_t Flags; ///< The record flags, as stored in the plugin.
+    uint32_t ModIndex; ///< The index of the plugin that holds the record. See GetSnapshotModInfo().
+    uint32_t Offset; ///< The offset of the record header in the plugin.
+    uint32_t Size; ///< The size of the record data in the plugin, excluding the header.
+    FORMID ParentFormID; ///< The FormID of the parent record, or `0` if the record has none.
+    const char *EditorID; ///< The editor ID of the record, or `NULL` if it has none.
+    bool IsWinning; ///< Whether the record was the winning version when the snapshot was saved.
+} SnapshotRecordInfo;
+
+/**
+    @brief The levels of message logged by CBash, from least to most severe.
+*/
+typedef enum {
+    eLogDebug = 0, ///< Diagnostics, such as record data that couldn't be parsed as expected.
+    eLogInfo, ///< Informational messages.
+    eLogWarning, ///< Problems that CBash worked around.
+    eLogError, ///< Errors that stopped an operation.
+    eLogNone ///< Passed to SetLogLevel() to disable logging.
+} logLevels;
+
 /**
     @brief The game types CBash can create collections for.
     @details The game type determines the file format CBash should assume when reading and writing plugin data.
@@ -129,7 +278,9 @@ typedef enum {
         @brief Causes LAND records to have extra indexing.
         @details Increases load time per mod. It allows the safe editing of
                  land records' heights. Modifying one LAND may require changes
-                 in an adjacent LAND to prevent seams.
+                 in an adjacent LAND to prevent seams. Each worldspace's LANDs
+                 can then be looked up by cell with GetWorldLand() and
+                 GetWorldLands().
     */
     fIsIndexLANDs            = 0x00000200,
     /**
@@ -148,6 +299,13 @@ typedef enum {
     */
     fIsIgnoreInactiveMasters = 0x00001000,
     fIsSkipAllRecords        = 0x00002000,  ///< Causes all records in groups to be skipped once one of each type is read.
+    /**
+        @brief Causes every record in the mod to be fingerprinted once loading finishes.
+        @details Increases load time per mod, though the work is spread across
+                 threads. GetRecordFingerprints() then returns the cached values
+                 for unchanged records.
+    */
+    fIsFingerprintRecords    = 0x00004000,
 } modFlags;
 
 /**
@@ -160,7 +318,25 @@ typedef enum {
                  been loaded with the ::fIsInLoadOrder flag.
     */
     fIsCleanMasters    = 0x00000001,
-    fIsCloseCollection = 0x00000002  ///< Delete the parent collection after the mod is saved.
+    fIsCloseCollection = 0x00000002, ///< Delete the parent collection after the mod is saved.
+    /**
+        @brief Writes a localized plugin's string files.
+        @details Skyrim only. A plugin is always saved in the form it was
+                 read in: a localized plugin stores the ids of its strings,
+                 and an unlocalized one stores the text. With this flag, a
+                 localized plugin's strings are written to its
+                 `Strings/<name>_English.STRINGS`, `.DLSTRINGS` and
+                 `.ILSTRINGS` files, which replace the old ones together with
+                 the plugin. Strings already in the old files keep their ids.
+
+                 Without it, only the ids read from the plugin can be written,
+                 so saving a localized plugin fails if any of its strings were
+                 changed, added or copied from another plugin. Saving with it
+                 fails if the old string files couldn't be read, as when they
+                 ship in a BSA, since new ones would hide them. The flag is
+                 ignored, with a warning, for unlocalized plugins.
+    */
+    fIsWriteStrings    = 0x00000004
 } saveFlags;
 
 /**
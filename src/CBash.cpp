@@ -46,19 +46,17 @@
 #define COMPILING_CBASH
 #include "CBash.h"
 #include "Collection.h"
+#include "Snapshot.h"
 #include "Version.h"
 #include <vector>
+#include <algorithm>
+#include <mutex>
 #include <stdarg.h>
 //#include "mmgr.h"
 
 
 static std::vector<Collection *> Collections;
-#ifdef CBASH_CALLTIMING
-    extern std::map<char *, double> CallTime;
-#endif
-#ifdef CBASH_CALLCOUNT
-    extern std::map<char *, unsigned long> CallCount;
-#endif
+static std::mutex CollectionsLock;
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 //Internal Functions
@@ -68,6 +66,20 @@ inline void ValidatePointer(const void *testPointer)
         throw Ex_NULL();
     }
 
+ModFile *ValidateModID(ModFile *ModID)
+    {
+    //The mod is only dereferenced once it is known to belong to a live collection
+    ValidatePointer(ModID);
+    std::lock_guard<std::mutex> lock(CollectionsLock);
+    for(uint32_t p = 0; p < Collections.size(); ++p)
+        if(Collections[p] != NULL)
+            for(uint32_t x = 0; x < Collections[p]->ModFiles.size(); ++x)
+                if(Collections[p]->ModFiles[x] == ModID)
+                    return ModID;
+    throw Ex_INVALIDMODINDEX();
+    return NULL;
+    }
+
 ModFile *ValidateLoadOrderIndex(Collection *curCollection, const uint32_t ModIndex)
     {
     //ModFiles will never contain null pointers
@@ -93,6 +105,27 @@ ModFile *ValidateLoadOrderIndex(Collection *curCollection, char * const ModName)
     return NULL;
     }
 
+void GetRecordFields(Record *RecordID, const FieldSpec *FieldSpecs, const uint32_t NumFields, void * const *FieldBuffers, void **FieldValues)
+    {
+    //Ensure the record is fully loaded, once for the whole batch
+    if(!RecordID->IsLoaded() || RecordID->GetParentMod()->Parent->IsConcurrentReads)
+        {
+        RecordReader reader(RecordID);
+        reader.Accept(RecordID);
+        }
+
+    for(uint32_t x = 0; x < NumFields; ++x)
+        {
+        const FieldSpec &spec = FieldSpecs[x];
+        //Outputs are never used as buffers, so values returned by an earlier call are never written through
+        void *buffer = FieldBuffers != NULL ? FieldBuffers[x] : NULL;
+        FieldValues[x] = buffer;
+        void *value = RecordID->GetField(spec.FieldID, spec.ListIndex, spec.ListFieldID, spec.ListX2Index, spec.ListX2FieldID, spec.ListX3Index, spec.ListX3FieldID, buffer != NULL ? (void **)buffer : &FieldValues[x]);
+        if(value != NULL)
+            FieldValues[x] = value;
+        }
+    }
+
 //Exported Functions
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
@@ -149,35 +182,128 @@ CPPDLLEXTERN uint32_t GetVersionRevision()
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 //Logging action functions
-int logback_printer(const char * _Format, ...)
+CPPDLLEXTERN void RedirectMessages(int32_t (*_LoggingCallback)(const char *))
     {
-    int nSize = 0;
-    char buff[1024];
-    va_list args;
-    va_start(args, _Format);
-    nSize = sprintf(buff, _Format, args);
-    va_end(args);
-    LoggingCallback(buff);
-    return nSize;
+    //printer checks the callback for each message, so it only has to be stored
+    LoggingCallback = _LoggingCallback;
     }
 
-CPPDLLEXTERN void RedirectMessages(int32_t (*_LoggingCallback)(const char *))
+CPPDLLEXTERN void AllowRaising(void (*_RaiseCallback)(const char *))
+    {
+    RaiseCallback = _RaiseCallback;
+    }
+
+CPPDLLEXTERN int32_t SetProfiling(const bool Enable)
+    {
+    IsProfiling = Enable;
+    return 0;
+    }
+
+CPPDLLEXTERN int32_t SetTracing(const bool Enable)
+    {
+    if(Enable && !IsTracing)
+        ClearTraceEvents();
+    IsTracing = Enable;
+    return 0;
+    }
+
+CPPDLLEXTERN int32_t WriteTrace(char * const FileName)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        ValidatePointer(FileName);
+        if(!WriteTraceEvents(FileName))
+            throw std::runtime_error("Unable to write the trace file.");
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t SetLogLevel(const uint32_t Level)
     {
-    if(_LoggingCallback)
+    try
+        {
+        if(Level > eLogNone)
+            throw std::runtime_error("Unknown log level.");
+        logger.SetLevel((int32_t)Level);
+        return 0;
+        }
+    catch(std::exception &ex)
         {
-        LoggingCallback = _LoggingCallback;
-        printer = &logback_printer;
+        PRINT_EXCEPTION(ex);
         }
-    else
+    catch(...)
         {
-        LoggingCallback = NULL;
-        printer = &printf;
+        PRINT_ERROR;
         }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
     }
 
-CPPDLLEXTERN void AllowRaising(void (*_RaiseCallback)(const char *))
+CPPDLLEXTERN int32_t FlushLog()
     {
-    RaiseCallback = _RaiseCallback;
+    try
+        {
+        logger.Flush();
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetProfileReport(char *Report, const uint32_t ReportSize, const bool Reset)
+    {
+    try
+        {
+        std::string report = BuildProfileReport();
+        if(Report != NULL && ReportSize != 0)
+            {
+            uint32_t length = report.size() < ReportSize ? (uint32_t)report.size() : ReportSize - 1;
+            memcpy(Report, report.c_str(), length);
+            Report[length] = 0;
+            //Samples that weren't all delivered are kept for the next call
+            if(Reset && length == report.size())
+                ResetProfile();
+            }
+        return (int32_t)report.size();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
     }
 
 ////////////////////////////////////////////////////////////////////////
@@ -232,6 +358,7 @@ CPPDLLEXTERN Collection * CreateCollection(char * const ModsPath, const uint32_t
     try
         {
         ValidatePointer(ModsPath);
+        std::lock_guard<std::mutex> lock(CollectionsLock);
         for(uint32_t p = 0; p < Collections.size(); ++p)
             {
             if(Collections[p] == NULL)
@@ -264,10 +391,13 @@ CPPDLLEXTERN int32_t DeleteCollection(Collection *CollectionID)
     try
         {
         //ValidatePointer(CollectionID);
+        std::lock_guard<std::mutex> lock(CollectionsLock);
         for(uint32_t ListIndex = 0; ListIndex < Collections.size(); ++ListIndex)
             {
             if(Collections[ListIndex] == CollectionID)
                 {
+                if(CollectionID->Monitor != NULL)
+                    throw std::runtime_error("Unable to delete the collection. Its load task must be closed first.");
                 for(uint32_t ListX2Index = 0; ListX2Index < CollectionID->ModFiles.size(); ++ListX2Index)
                     CollectionID->ModFiles[ListX2Index]->Close();
                 for(uint32_t ListX2Index = 0; ListX2Index < CollectionID->closing_ops.size(); ++ListX2Index)
@@ -286,48 +416,11 @@ CPPDLLEXTERN int32_t DeleteCollection(Collection *CollectionID)
             }
         Collections.clear();
 
-        #ifdef CBASH_CALLCOUNT
-            cbcounter.end();
-            printer("counts = [");
-            for(std::map<char *, unsigned long>::iterator it = CallCount.begin(); it != CallCount.end(); ++it)
-                printer("(%d, '%s'),", it->second, it->first);
-            printer("]\n");
-            #ifndef CBASH_CALLTIMING
-                CallCount.clear();
-            #endif
-        #endif
-        #ifdef CBASH_CALLTIMING
-            cbtimer.end();
-            double TotTime = 0.0f;
-            printer("times = [");
-            for(std::map<char *, double>::iterator it = CallTime.begin(); it != CallTime.end(); ++it)
-                {
-                TotTime += it->second;
-                printer("(%.10f, '%s'),", it->second, it->first);
-                }
-            printer("]\n\n");
-            #ifdef CBASH_CALLCOUNT
-                printer("Time in CBash = %.10f\n\n", TotTime);
-                printer("Time in CBash = sum(total time)\n");
-                printer("Total %% = Time in CBash / total time * 100%%\n");
-                printer("avg execution = total time / times called\n\n");
-                printer("Total %%,avg execution,total time,function,times called\n");
-                std::multimap<double, char *> CBashProfiling;
-                for(std::map<char *, double>::iterator it = CallTime.begin(); it != CallTime.end(); ++it)
-                    CBashProfiling.insert(std::make_pair((it->second / TotTime) * 100, it->first));
-                for(std::multimap<double, char *>::iterator it = CBashProfiling.end(); it != CBashProfiling.begin();)
-                    {
-                    --it;
-                    if(it->first < 10.0)
-                        printer("0");
-                    printer("%02.2f%%,%.10f,%.10f,%s,%d\n", it->first, CallTime[it->second] / CallCount[it->second], CallTime[it->second], it->second, CallCount[it->second]);
-                    }
-                printer("\n\n");
-                CBashProfiling.clear();
-                CallCount.clear();
-            #endif
-            CallTime.clear();
+        #ifdef CBASH_PROFILING
+            printer("%s\n\n", BuildProfileReport().c_str());
         #endif
+        //Stopped here rather than at unload, where joining the flusher could deadlock
+        logger.Close();
         return 0;
         }
     catch(std::exception &ex)
@@ -351,7 +444,117 @@ CPPDLLEXTERN int32_t LoadCollection(Collection *CollectionID, bool (*_ProgressCa
     try
         {
         //ValidatePointer(CollectionID);
-        CollectionID->Load(_ProgressCallback);
+        if(CollectionID->Monitor != NULL)
+            throw std::runtime_error("Unable to load the collection. It is already being loaded by a load task.");
+        return CollectionID->Load(_ProgressCallback);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN LoadTask * LoadCollectionAsync(Collection *CollectionID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        if(CollectionID->Monitor != NULL)
+            throw std::runtime_error("Unable to load the collection. It is already being loaded by a load task.");
+        return new LoadTask(CollectionID);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return NULL;
+    }
+
+CPPDLLEXTERN int32_t GetLoadProgress(LoadTask *TaskID, LoadProgress *Progress)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(TaskID);
+        loadStates state = TaskID->GetState();
+        if(Progress != NULL)
+            {
+            LoadMonitor &monitor = TaskID->monitor;
+            Progress->State = state;
+            Progress->NumMods = monitor.NumMods;
+            Progress->ModIndex = monitor.ModIndex;
+            //The mod list stops changing once NumMods is set
+            Progress->ModName = Progress->NumMods != 0 ? TaskID->Parent->ModFiles[Progress->ModIndex]->FileName : NULL;
+            Progress->ModBytesRead = monitor.ModBytesRead;
+            Progress->ModBytesTotal = monitor.ModBytesTotal;
+            Progress->BytesRead = monitor.BytesRead;
+            Progress->BytesTotal = monitor.BytesTotal;
+            }
+        return state;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t WaitForLoad(LoadTask *TaskID, const uint32_t Timeout)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(TaskID);
+        return TaskID->Wait(Timeout);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t CancelLoad(LoadTask *TaskID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(TaskID);
+        TaskID->monitor.IsCancelled = true;
         return 0;
         }
     catch(std::exception &ex)
@@ -368,6 +571,32 @@ CPPDLLEXTERN int32_t LoadCollection(Collection *CollectionID, bool (*_ProgressCa
     return -1;
     }
 
+CPPDLLEXTERN int32_t CloseLoadTask(LoadTask *TaskID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(TaskID);
+        TaskID->monitor.IsCancelled = true;
+        loadStates state = TaskID->Wait(0);
+        delete TaskID;
+        return state;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
 CPPDLLEXTERN int32_t UnloadCollection(Collection *CollectionID)
     {
     PROFILE_FUNC
@@ -415,14 +644,40 @@ CPPDLLEXTERN int32_t GetCollectionType(Collection *CollectionID)
     return -1;
     }
 
+CPPDLLEXTERN int32_t SetConcurrentReads(Collection *CollectionID, const bool Enable)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        CollectionID->SetConcurrentReads(Enable);
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
 CPPDLLEXTERN int32_t UnloadAllCollections()
     {
     PROFILE_FUNC
 
     try
         {
+        std::lock_guard<std::mutex> lock(CollectionsLock);
         for(uint32_t p = 0; p < Collections.size(); ++p)
-            Collections[p]->Unload();
+            if(Collections[p] != NULL && Collections[p]->Monitor == NULL)
+                Collections[p]->Unload();
         return 0;
         }
     catch(std::exception &ex)
@@ -445,6 +700,10 @@ CPPDLLEXTERN int32_t DeleteAllCollections()
 
     try
         {
+        std::lock_guard<std::mutex> lock(CollectionsLock);
+        for(uint32_t p = 0; p < Collections.size(); ++p)
+            if(Collections[p] != NULL && Collections[p]->Monitor != NULL)
+                throw std::runtime_error("Unable to delete the collections. A load task must be closed first.");
         for(uint32_t p = 0; p < Collections.size(); ++p)
             delete Collections[p];
         Collections.clear();
@@ -1242,6 +1501,9 @@ CPPDLLEXTERN int32_t UnloadRecord(Record *RecordID)
     try
         {
         //ValidatePointer(RecordID);
+        //Other threads may still be using the record
+        if(RecordID->GetParentMod()->Parent->IsConcurrentReads)
+            return 0;
         return RecordID->IsChanged() ? 0 : RecordID->Unload();
         }
     catch(std::exception &ex)
@@ -1411,28 +1673,18 @@ CPPDLLEXTERN int32_t GetRecordIDs(ModFile *ModID, const uint32_t RecordType, REC
     return -1;
     }
 
-CPPDLLEXTERN int32_t IsRecordWinning(Record *RecordID, const bool GetExtendedConflicts)
+CPPDLLEXTERN RecordCursor * OpenRecordCursor(ModFile *ModID, const uint32_t RecordType)
     {
     PROFILE_FUNC
 
+    RecordCursor *CursorID = NULL;
     try
         {
-        //ValidatePointer(CollectionID);
         //ValidatePointer(ModID);
-        if(!RecordID->IsWinningDetermined())
-            {
-            ModFile *WinningModfile = NULL;
-            Record *WinningRecord = NULL;
-            if(RecordID->IsKeyedByEditorID())
-                RecordID->GetParentMod()->Parent->LookupWinningRecord(RecordID->GetEditorIDKey(), WinningModfile, WinningRecord, true);
-            else
-                RecordID->GetParentMod()->Parent->LookupWinningRecord(RecordID->formID, WinningModfile, WinningRecord, true);
-            }
-        if(GetExtendedConflicts)
-            return RecordID->IsExtendedWinning();
-        else if(RecordID->GetParentMod()->Flags.IsExtendedConflicts)
-            return false;
-        return RecordID->IsWinning();
+        CursorID = new RecordCursor();
+        RecordCursorFiller filler(*CursorID);
+        ModID->VisitRecords(RecordType, filler);
+        return CursorID;
         }
     catch(std::exception &ex)
         {
@@ -1442,20 +1694,26 @@ CPPDLLEXTERN int32_t IsRecordWinning(Record *RecordID, const bool GetExtendedCon
         {
         PRINT_ERROR;
         }
-    printer("\n\n");
+    delete CursorID;
+    printer("RecordType: %08X\n\n", RecordType);
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
-    return -1;
+    return NULL;
     }
 
-CPPDLLEXTERN int32_t GetNumRecordConflicts(Record *RecordID, const bool GetExtendedConflicts)
+CPPDLLEXTERN RecordCursor * OpenWinningRecordCursor(Collection *CollectionID, const uint32_t RecordType)
     {
     PROFILE_FUNC
 
+    RecordCursor *CursorID = NULL;
     try
         {
-        //ValidatePointer(CollectionID);
-        return RecordID->GetParentMod()->Parent->GetNumRecordConflicts(RecordID, GetExtendedConflicts);
+        ValidatePointer(CollectionID);
+        CursorID = new RecordCursor();
+        RecordCursorFiller filler(*CursorID, true);
+        for(uint32_t x = 0; x < CollectionID->ModFiles.size(); ++x)
+            CollectionID->ModFiles[x]->VisitRecords(RecordType, filler);
+        return CursorID;
         }
     catch(std::exception &ex)
         {
@@ -1465,20 +1723,27 @@ CPPDLLEXTERN int32_t GetNumRecordConflicts(Record *RecordID, const bool GetExten
         {
         PRINT_ERROR;
         }
-    printer("\n\n");
+    delete CursorID;
+    printer("RecordType: %08X\n\n", RecordType);
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
-    return -1;
+    return NULL;
     }
 
-CPPDLLEXTERN int32_t GetRecordConflicts(Record *RecordID, RECORDIDARRAY RecordIDs, const bool GetExtendedConflicts)
+CPPDLLEXTERN int32_t NextRecords(RecordCursor *CursorID, RECORDIDARRAY RecordIDs, const uint32_t MaxRecords)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
-        return RecordID->GetParentMod()->Parent->GetRecordConflicts(RecordID, RecordIDs, GetExtendedConflicts);
+        ValidatePointer(CursorID);
+        uint32_t NumRecords = (uint32_t)CursorID->records.size() - CursorID->position;
+        if(NumRecords > MaxRecords)
+            NumRecords = MaxRecords;
+        for(uint32_t x = 0; x < NumRecords; ++x)
+            RecordIDs[x] = CursorID->records[CursorID->position + x];
+        CursorID->position += NumRecords;
+        return NumRecords;
         }
     catch(std::exception &ex)
         {
@@ -1488,21 +1753,21 @@ CPPDLLEXTERN int32_t GetRecordConflicts(Record *RecordID, RECORDIDARRAY RecordID
         {
         PRINT_ERROR;
         }
-    printer("\n\n");
+    printer("MaxRecords: %i\n\n", MaxRecords);
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
     return -1;
     }
 
-CPPDLLEXTERN int32_t GetRecordHistory(Record *RecordID, RECORDIDARRAY RecordIDs)
+CPPDLLEXTERN int32_t CloseRecordCursor(RecordCursor *CursorID)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
-        //ValidatePointer(ModID);
-        return RecordID->GetParentMod()->Parent->GetRecordHistory(RecordID, RecordIDs);
+        ValidatePointer(CursorID);
+        delete CursorID;
+        return 0;
         }
     catch(std::exception &ex)
         {
@@ -1518,26 +1783,15 @@ CPPDLLEXTERN int32_t GetRecordHistory(Record *RecordID, RECORDIDARRAY RecordIDs)
     return -1;
     }
 
-CPPDLLEXTERN int32_t GetNumIdenticalToMasterRecords(ModFile *ModID)
+CPPDLLEXTERN int32_t IsRecordWinning(Record *RecordID, const bool GetExtendedConflicts)
     {
     PROFILE_FUNC
-    if(ModID->Flags.IsExtendedConflicts)
-        {
-        printer("GetNumIdenticalToMasterRecords: Warning - No history available. Mod \"%s\" uses extended conflicts.\n", ModID->ModName);
-        return -1;
-        }
 
     try
         {
-        //ValidatePointer(RecordID1);
-                //ValidatePointer(RecordID2);
-
-        ModID->Parent->identical_records.clear();
-
-        IdenticalToMasterRetriever identical(ModID);
-
-        ModID->VisitAllRecords(identical);
-        return (int32_t)ModID->Parent->identical_records.size();
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        return RecordID->GetParentMod()->Parent->IsWinningRecord(RecordID, GetExtendedConflicts);
         }
     catch(std::exception &ex)
         {
@@ -1553,21 +1807,14 @@ CPPDLLEXTERN int32_t GetNumIdenticalToMasterRecords(ModFile *ModID)
     return -1;
     }
 
-CPPDLLEXTERN int32_t GetIdenticalToMasterRecords(ModFile *ModID, RECORDIDARRAY RecordIDs)
+CPPDLLEXTERN int32_t GetNumRecordConflicts(Record *RecordID, const bool GetExtendedConflicts)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(RecordID1);
-                //ValidatePointer(RecordID2);
-        typedef boost::unordered_set<Record *>::iterator identical_it;
-        uint32_t count = 0;
-        for(identical_it item = ModID->Parent->identical_records.begin(); item != ModID->Parent->identical_records.end(); item++)
-            RecordIDs[count++] = *item;
-
-        ModID->Parent->identical_records.clear();
-        return count;
+        //ValidatePointer(CollectionID);
+        return RecordID->GetParentMod()->Parent->GetNumRecordConflicts(RecordID, GetExtendedConflicts);
         }
     catch(std::exception &ex)
         {
@@ -1583,14 +1830,14 @@ CPPDLLEXTERN int32_t GetIdenticalToMasterRecords(ModFile *ModID, RECORDIDARRAY R
     return -1;
     }
 
-CPPDLLEXTERN int32_t IsRecordFormIDsInvalid(Record *RecordID)
+CPPDLLEXTERN int32_t GetRecordConflicts(Record *RecordID, RECORDIDARRAY RecordIDs, const bool GetExtendedConflicts)
     {
     PROFILE_FUNC
 
     try
         {
-        RecordInvalidFormIDChecker checker;
-        return checker.Accept(RecordID);
+        //ValidatePointer(CollectionID);
+        return RecordID->GetParentMod()->Parent->GetRecordConflicts(RecordID, RecordIDs, GetExtendedConflicts);
         }
     catch(std::exception &ex)
         {
@@ -1605,72 +1852,16 @@ CPPDLLEXTERN int32_t IsRecordFormIDsInvalid(Record *RecordID)
         RaiseCallback(__FUNCTION__);
     return -1;
     }
-////////////////////////////////////////////////////////////////////////
-//Mod or Record action functions
-CPPDLLEXTERN int32_t UpdateReferences(ModFile *ModID, Record *RecordID, FORMIDARRAY OldFormIDs, FORMIDARRAY NewFormIDs, UINT32ARRAY Changes, const uint32_t ArraySize)
+
+CPPDLLEXTERN int32_t GetRecordHistory(Record *RecordID, RECORDIDARRAY RecordIDs)
     {
     PROFILE_FUNC
 
-    //Sanity check.
-    if(ArraySize == 0)
-        return -1;
-
-    //Sanity check.
     try
         {
         //ValidatePointer(CollectionID);
         //ValidatePointer(ModID);
-        uint32_t count = 0;
-        if(RecordID != NULL) //Swap possible uses of FormIDToReplace in a specific record only
-            {
-            for(uint32_t ListIndex = 0; ListIndex < ArraySize; ++ListIndex)
-                {
-                //Sanity check.
-                if(OldFormIDs[ListIndex] == NewFormIDs[ListIndex])
-                    continue;
-                RecordFormIDSwapper swapper(OldFormIDs[ListIndex], NewFormIDs[ListIndex], RecordID->GetParentMod()->FormIDHandler, RecordID->GetParentMod()->Parent->Expanders);
-                swapper.Accept(RecordID);
-                Changes[ListIndex] = swapper.GetCount();
-                count += swapper.GetCount();
-                }
-            if(count)
-                {
-                RecordID->IsChanged(true);
-                RecordID->GetParentMod()->Parent->changed_records.insert(RecordID);
-                }
-            }
-        else
-            {
-            ModID->Parent->changed_records.clear();
-            //Build a map of references to avoid iterating through every single record N times
-            std::map<FORMID, std::vector<Record *> > formID_users;
-            RecordFormIDMapper mapper(formID_users, ModID->FormIDHandler, ModID->Parent->Expanders);
-            ModID->VisitAllRecords(mapper);
-            uint32_t OldFormID = 0, NewFormID = 0;
-            RecordReader reader(ModID);
-            Record *curRecord;
-            for(uint32_t ListIndex = 0; ListIndex < ArraySize; ++ListIndex)
-                {
-                //Sanity check.
-                OldFormID = OldFormIDs[ListIndex];
-                NewFormID = NewFormIDs[ListIndex];
-                if(OldFormID == NewFormID)
-                    continue;
-                FormIDSwapper swapper(OldFormID, NewFormID, ModID->FormIDHandler);
-                std::vector<Record *> &users = formID_users[OldFormID];
-                for(uint32_t ListX2Index = 0; ListX2Index < users.size(); ++ListX2Index)
-                    {
-                    curRecord = users[ListX2Index];
-                    reader.Accept(curRecord);
-                    curRecord->VisitFormIDs(swapper);
-                    curRecord->IsChanged(true);
-                    ModID->Parent->changed_records.insert(curRecord);
-                    }
-                Changes[ListIndex] = swapper.GetCount();
-                count += swapper.GetCount();
-                }
-            }
-        return count;
+        return RecordID->GetParentMod()->Parent->GetRecordHistory(RecordID, RecordIDs);
         }
     catch(std::exception &ex)
         {
@@ -1685,21 +1876,18 @@ CPPDLLEXTERN int32_t UpdateReferences(ModFile *ModID, Record *RecordID, FORMIDAR
         RaiseCallback(__FUNCTION__);
     return -1;
     }
-////////////////////////////////////////////////////////////////////////
-//Mod or Record info functions
-CPPDLLEXTERN int32_t GetRecordUpdatedReferences(Collection *CollectionID, Record *RecordID)
+
+CPPDLLEXTERN int32_t BuildConflictMatrix(ModFile *ModID, const uint32_t RecordType, const bool GetExtendedConflicts, UINT32ARRAY NumRows)
     {
     PROFILE_FUNC
 
     try
         {
-        if(RecordID == NULL)
-            {
-            CollectionID->changed_records.clear();
-            return 0;
-            }
-
-        return (int32_t)RecordID->GetParentMod()->Parent->changed_records.count(RecordID);
+        ValidateModID(ModID);
+        int32_t NumRecords = (int32_t)ModID->Parent->BuildConflictMatrix(ModID, RecordType, GetExtendedConflicts);
+        if(NumRows != NULL)
+            *NumRows = (uint32_t)ModID->Parent->conflict_rows.size();
+        return NumRecords;
         }
     catch(std::exception &ex)
         {
@@ -1709,24 +1897,39 @@ CPPDLLEXTERN int32_t GetRecordUpdatedReferences(Collection *CollectionID, Record
         {
         PRINT_ERROR;
         }
-    printer("\n\n");
+    printer("RecordType: %08X\n\n", RecordType);
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
     return -1;
     }
-////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////
-//Field action functions
-CPPDLLEXTERN int32_t SetIDFields(Record *RecordID, const FORMID FormID, char * const EditorID)
+
+CPPDLLEXTERN int32_t GetConflictMatrix(ModFile *ModID, RECORDIDARRAY RowIDs, UINT32ARRAY Offsets, RECORDIDARRAY RecordIDs)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
-        //ValidatePointer(ModID);
-        //ValidatePointer(RecordID);
-        return RecordID->GetParentMod()->Parent->SetIDFields(RecordID, FormID, EditorID);
+        ValidateModID(ModID);
+        Collection *CollectionID = ModID->Parent;
+        if(CollectionID->conflict_mod != ModID)
+            throw std::runtime_error("No conflict matrix has been built for the mod.");
+        uint32_t NumRows = (uint32_t)CollectionID->conflict_rows.size();
+        if(NumRows)
+            {
+            memcpy(RowIDs, &CollectionID->conflict_rows[0], NumRows * sizeof(Record *));
+            memcpy(Offsets, &CollectionID->conflict_offsets[0], (NumRows + 1) * sizeof(uint32_t));
+            if(!CollectionID->conflict_records.empty())
+                memcpy(RecordIDs, &CollectionID->conflict_records[0], CollectionID->conflict_records.size() * sizeof(Record *));
+            }
+        else if(!CollectionID->conflict_offsets.empty())
+            Offsets[0] = 0;
+
+        //Release the memory rather than just clearing
+        CollectionID->conflict_mod = NULL;
+        std::vector<Record *>().swap(CollectionID->conflict_rows);
+        std::vector<uint32_t>().swap(CollectionID->conflict_offsets);
+        std::vector<Record *>().swap(CollectionID->conflict_records);
+        return NumRows;
         }
     catch(std::exception &ex)
         {
@@ -1742,45 +1945,27 @@ CPPDLLEXTERN int32_t SetIDFields(Record *RecordID, const FORMID FormID, char * c
     return -1;
     }
 
-CPPDLLEXTERN void SetField(Record *RecordID, FIELD_IDENTIFIERS, void *FieldValue, const uint32_t ArraySize)
+CPPDLLEXTERN int32_t GetNumIdenticalToMasterRecords(ModFile *ModID)
     {
     PROFILE_FUNC
+    if(ModID->Flags.IsExtendedConflicts)
+        {
+        printer("GetNumIdenticalToMasterRecords: Warning - No history available. Mod \"%s\" uses extended conflicts.\n", ModID->ModName);
+        return -1;
+        }
 
     try
         {
-        //ValidatePointer(CollectionID);
-        //ValidatePointer(ModID);
-        //ValidatePointer(RecordID);
+        //ValidatePointer(RecordID1);
+                //ValidatePointer(RecordID2);
 
-        //Ensure the record is fully loaded
-        if(!RecordID->IsLoaded())
-            {
-            RecordReader reader(RecordID);
-            reader.Accept(RecordID);
-            }
+        ModID->Parent->identical_records.clear();
 
-        if(RecordID->SetField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, FieldValue, ArraySize))
-            {
-            //returns true if formIDs need to be checked
-            //Update the master list if needed
-            FormIDMasterUpdater checker(RecordID);
-            //checker.Accept(curRecord->formID); //FormID can only be changed through SetRecordIDs, so no need to check
-            RecordID->VisitFormIDs(checker);
-            //RecordID->HasInvalidFormIDs(checker.result);
-            //if(checker.result)
-            //    {
-            //    uint8_t ModIndex = (uint8_t)(RecordID->formID >> 24);
-            //    ModFile *ModID = RecordID->GetParentMod();
-            //    uint8_t CollapsedIndex = ModID->FormIDHandler.CollapseTable[ModIndex];
-            //    char * LongID = CollapsedIndex >= ModID->TES4.MAST.size() ? ModID->ModName : ModID->TES4.MAST[CollapsedIndex];
-            //    VSDPRINT(RecordID->GetStrType());
-            //    PRINT_FIELD_IDENTIFIERS;
-            //    printer("SetField: Error! Record (%s, 0x%06X) in mod (%s) contains an invalid FormID!\n", LongID, RecordID->formID & 0x00FFFFFF, ModID->ModName);
-            //    }
-            }
+        IdenticalToMasterRetriever identical(ModID);
 
-        RecordID->IsChanged(true);
-        return;
+        ModID->VisitAllRecords(identical);
+        identical.Compare();
+        return (int32_t)ModID->Parent->identical_records.size();
         }
     catch(std::exception &ex)
         {
@@ -1790,35 +1975,27 @@ CPPDLLEXTERN void SetField(Record *RecordID, FIELD_IDENTIFIERS, void *FieldValue
         {
         PRINT_ERROR;
         }
-    //PRINT_RECORD_IDENTIFIERS;
-    PRINT_FIELD_IDENTIFIERS;
-    printer("ArraySize: %i\n\n", ArraySize);
+    printer("\n\n");
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
-    return;
+    return -1;
     }
 
-CPPDLLEXTERN void DeleteField(Record *RecordID, FIELD_IDENTIFIERS)
+CPPDLLEXTERN int32_t GetIdenticalToMasterRecords(ModFile *ModID, RECORDIDARRAY RecordIDs)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
-        //ValidatePointer(ModID);
-        //ValidatePointer(RecordID);
-
-        //Ensure the record is fully loaded
-        if(!RecordID->IsLoaded())
-            {
-            RecordReader reader(RecordID);
-            reader.Accept(RecordID);
-            }
-
-        RecordID->DeleteField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID);
+        //ValidatePointer(RecordID1);
+                //ValidatePointer(RecordID2);
+        typedef boost::unordered_set<Record *>::iterator identical_it;
+        uint32_t count = 0;
+        for(identical_it item = ModID->Parent->identical_records.begin(); item != ModID->Parent->identical_records.end(); item++)
+            RecordIDs[count++] = *item;
 
-        RecordID->IsChanged(true);
-        return;
+        ModID->Parent->identical_records.clear();
+        return count;
         }
     catch(std::exception &ex)
         {
@@ -1828,37 +2005,38 @@ CPPDLLEXTERN void DeleteField(Record *RecordID, FIELD_IDENTIFIERS)
         {
         PRINT_ERROR;
         }
-    //PRINT_RECORD_IDENTIFIERS;
-    PRINT_FIELD_IDENTIFIERS;
     printer("\n\n");
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
-    return;
+    return -1;
     }
-////////////////////////////////////////////////////////////////////////
-//Field info functions
-CPPDLLEXTERN uint32_t GetFieldAttribute(Record *RecordID, FIELD_IDENTIFIERS, const uint32_t WhichAttribute)
+
+CPPDLLEXTERN int32_t GetRecordFingerprints(RECORDIDARRAY RecordIDs, uint64_t *Fingerprints, const uint32_t ArraySize)
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
-        //ValidatePointer(ModID);
-        //ValidatePointer(RecordID);
+        //ValidatePointer(RecordIDs);
+        //Each collection fingerprints its own records, and a record is only fingerprinted once
+        std::map<Collection *, std::vector<Record *> > grouped;
+        boost::unordered_set<Record *> seen;
+        for(uint32_t x = 0; x < ArraySize; ++x)
+            if(seen.insert(RecordIDs[x]).second)
+                grouped[RecordIDs[x]->GetParentMod()->Parent].push_back(RecordIDs[x]);
 
-        if(WhichAttribute > 0)
+        boost::unordered_map<Record *, uint64_t> results;
+        for(std::map<Collection *, std::vector<Record *> >::iterator group = grouped.begin(); group != grouped.end(); ++group)
             {
-            //Any attribute other than type requires the record to be read
-            //Ensure the record is fully loaded
-            if(!RecordID->IsLoaded())
-                {
-                RecordReader reader(RecordID);
-                reader.Accept(RecordID);
-                }
+            std::vector<uint64_t> hashes;
+            group->first->FingerprintRecords(group->second, hashes);
+            for(uint32_t x = 0; x < group->second.size(); ++x)
+                results[group->second[x]] = hashes[x];
             }
 
-        return RecordID->GetFieldAttribute(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, WhichAttribute);
+        for(uint32_t x = 0; x < ArraySize; ++x)
+            Fingerprints[x] = results[RecordIDs[x]];
+        return ArraySize;
         }
     catch(std::exception &ex)
         {
@@ -1868,32 +2046,1131 @@ CPPDLLEXTERN uint32_t GetFieldAttribute(Record *RecordID, FIELD_IDENTIFIERS, con
         {
         PRINT_ERROR;
         }
-    //PRINT_RECORD_IDENTIFIERS;
-    PRINT_FIELD_IDENTIFIERS;
-    printer("WhichAttribute: %i\n\n", WhichAttribute);
+    printer("\n\n");
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
-    return UNKNOWN_FIELD;
+    return -1;
     }
 
-CPPDLLEXTERN void * GetField(Record *RecordID, FIELD_IDENTIFIERS, void **FieldValues)
+CPPDLLEXTERN int32_t DiffMods(ModFile *ModID, ModFile *OtherModID, bool (*_DiffCallback)(const uint32_t Change, Record *RecordID, Record *OtherRecordID, const uint32_t *Subrecords, const uint32_t NumSubrecords))
     {
     PROFILE_FUNC
 
     try
         {
-        //ValidatePointer(CollectionID);
         //ValidatePointer(ModID);
-        //ValidatePointer(RecordID);
+        //ValidatePointer(OtherModID);
+        if(ModID == OtherModID)
+            return 0;
 
-        //Ensure the record is fully loaded
-        if(!RecordID->IsLoaded())
-            {
-            RecordReader reader(RecordID);
-            reader.Accept(RecordID);
-            }
+        ModDiffer differ(ModID, OtherModID);
+        return differ.Diff(_DiffCallback);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
 
-        return RecordID->GetField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, FieldValues);
+CPPDLLEXTERN int32_t IsRecordFormIDsInvalid(Record *RecordID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        RecordInvalidFormIDChecker checker;
+        return checker.Accept(RecordID);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetWorldHeightmapBounds(Record *WorldRecordID, int32_t *MinX, int32_t *MinY, int32_t *MaxX, int32_t *MaxY)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(WorldRecordID);
+        int32_t Bounds[4] = {0, 0, 0, 0};
+        int32_t count = WorldRecordID->GetParentMod()->Parent->GetWorldHeightmap(WorldRecordID, Bounds, NULL);
+        if(count > 0)
+            {
+            *MinX = Bounds[0];
+            *MinY = Bounds[1];
+            *MaxX = Bounds[2];
+            *MaxY = Bounds[3];
+            }
+        return count;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetWorldHeightmap(Record *WorldRecordID, const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, float *Heights, const uint32_t MaxHeights, const float NoData)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(WorldRecordID);
+        ValidatePointer(Heights);
+        if(MaxX < MinX || MaxY < MinY)
+            {
+            printer("GetWorldHeightmap: Error - The bounds (%i, %i) to (%i, %i) are empty.\n", MinX, MinY, MaxX, MaxY);
+            return -1;
+            }
+        //Each side is at most 2^37 vertices, so their product is checked before it is formed
+        const uint64_t width = ((uint64_t)((int64_t)MaxX - MinX) + 1) * 32 + 1;
+        const uint64_t height = ((uint64_t)((int64_t)MaxY - MinY) + 1) * 32 + 1;
+        if(width > MaxHeights || height > MaxHeights / width)
+            {
+            printer("GetWorldHeightmap: Error - The heightmap of (%i, %i) to (%i, %i) doesn't fit in %u heights.\n", MinX, MinY, MaxX, MaxY, MaxHeights);
+            return -1;
+            }
+        std::fill(Heights, Heights + (size_t)(width * height), NoData);
+        int32_t Bounds[4] = {MinX, MinY, MaxX, MaxY};
+        return WorldRecordID->GetParentMod()->Parent->GetWorldHeightmap(WorldRecordID, Bounds, Heights);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN Record * GetWorldLand(Record *WorldRecordID, const int32_t PosX, const int32_t PosY)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(WorldRecordID);
+        LandGrid *grid = WorldRecordID->GetParentMod()->Parent->GetLandGrid(WorldRecordID);
+        return grid != NULL ? grid->Find(PosX, PosY) : NULL;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return NULL;
+    }
+
+CPPDLLEXTERN int32_t GetWorldLands(Record *WorldRecordID, const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, RECORDIDARRAY RecordIDs, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(WorldRecordID);
+        LandGrid *grid = WorldRecordID->GetParentMod()->Parent->GetLandGrid(WorldRecordID);
+        if(grid == NULL)
+            return -1;
+        std::vector<Record *> lands;
+        grid->Find(MinX, MinY, MaxX, MaxY, lands);
+        uint32_t count = (uint32_t)lands.size() < MaxRecords ? (uint32_t)lands.size() : MaxRecords;
+        for(uint32_t x = 0; x < count; ++x)
+            RecordIDs[x] = lands[x];
+        return (int32_t)count;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+////////////////////////////////////////////////////////////////////////
+//Mod or Record action functions
+CPPDLLEXTERN int32_t UpdateReferences(ModFile *ModID, Record *RecordID, FORMIDARRAY OldFormIDs, FORMIDARRAY NewFormIDs, UINT32ARRAY Changes, const uint32_t ArraySize)
+    {
+    PROFILE_FUNC
+
+    //Sanity check.
+    if(ArraySize == 0)
+        return -1;
+
+    //Sanity check.
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        uint32_t count = 0;
+        if(RecordID != NULL) //Swap possible uses of FormIDToReplace in a specific record only
+            {
+            for(uint32_t ListIndex = 0; ListIndex < ArraySize; ++ListIndex)
+                {
+                //Sanity check.
+                if(OldFormIDs[ListIndex] == NewFormIDs[ListIndex])
+                    continue;
+                RecordFormIDSwapper swapper(OldFormIDs[ListIndex], NewFormIDs[ListIndex], RecordID->GetParentMod()->FormIDHandler, RecordID->GetParentMod()->Parent->Expanders);
+                swapper.Accept(RecordID);
+                Changes[ListIndex] = swapper.GetCount();
+                count += swapper.GetCount();
+                }
+            if(count)
+                {
+                RecordID->IsChanged(true);
+                RecordID->GetParentMod()->Parent->changed_records.insert(RecordID);
+                }
+            }
+        else
+            {
+            ModID->Parent->changed_records.clear();
+            //Build a map of references to avoid iterating through every single record N times
+            std::map<FORMID, std::vector<Record *> > formID_users;
+            RecordFormIDMapper mapper(formID_users, ModID->FormIDHandler, ModID->Parent->Expanders);
+            ModID->VisitAllRecords(mapper);
+            uint32_t OldFormID = 0, NewFormID = 0;
+            RecordReader reader(ModID);
+            Record *curRecord;
+            for(uint32_t ListIndex = 0; ListIndex < ArraySize; ++ListIndex)
+                {
+                //Sanity check.
+                OldFormID = OldFormIDs[ListIndex];
+                NewFormID = NewFormIDs[ListIndex];
+                if(OldFormID == NewFormID)
+                    continue;
+                FormIDSwapper swapper(OldFormID, NewFormID, ModID->FormIDHandler);
+                std::vector<Record *> &users = formID_users[OldFormID];
+                for(uint32_t ListX2Index = 0; ListX2Index < users.size(); ++ListX2Index)
+                    {
+                    curRecord = users[ListX2Index];
+                    reader.Accept(curRecord);
+                    curRecord->VisitFormIDs(swapper);
+                    curRecord->IsChanged(true);
+                    ModID->Parent->changed_records.insert(curRecord);
+                    }
+                Changes[ListIndex] = swapper.GetCount();
+                count += swapper.GetCount();
+                }
+            }
+        return count;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t MergeLeveledLists(ModFile *PatchModID, const uint32_t RecordType, MODIDARRAY ModIDs, const uint32_t *Tags, const uint32_t ArraySize)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(PatchModID);
+        if(!PatchModID->Flags.IsInLoadOrder)
+            {
+            printer("MergeLeveledLists: Error - Unable to merge into \"%s\". It is not in the load order.\n", PatchModID->ModName);
+            return -1;
+            }
+
+        boost::unordered_map<ModFile *, uint32_t> tags;
+        for(uint32_t x = 0; x < ArraySize; ++x)
+            tags[ModIDs[x]] = Tags[x];
+
+        return PatchModID->Parent->MergeLeveledLists(PatchModID, RecordType, tags);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+////////////////////////////////////////////////////////////////////////
+//Mod or Record info functions
+CPPDLLEXTERN int32_t GetRecordUpdatedReferences(Collection *CollectionID, Record *RecordID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        if(RecordID == NULL)
+            {
+            CollectionID->changed_records.clear();
+            return 0;
+            }
+
+        return (int32_t)RecordID->GetParentMod()->Parent->changed_records.count(RecordID);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+//Field action functions
+CPPDLLEXTERN int32_t SetIDFields(Record *RecordID, const FORMID FormID, char * const EditorID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        //ValidatePointer(RecordID);
+        return RecordID->GetParentMod()->Parent->SetIDFields(RecordID, FormID, EditorID);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN void SetField(Record *RecordID, FIELD_IDENTIFIERS, void *FieldValue, const uint32_t ArraySize)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        //ValidatePointer(RecordID);
+
+        //Ensure the record is fully loaded
+        if(!RecordID->IsLoaded())
+            {
+            RecordReader reader(RecordID);
+            reader.Accept(RecordID);
+            }
+
+        if(RecordID->SetField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, FieldValue, ArraySize))
+            {
+            //returns true if formIDs need to be checked
+            //Update the master list if needed
+            FormIDMasterUpdater checker(RecordID);
+            //checker.Accept(curRecord->formID); //FormID can only be changed through SetRecordIDs, so no need to check
+            RecordID->VisitFormIDs(checker);
+            //RecordID->HasInvalidFormIDs(checker.result);
+            //if(checker.result)
+            //    {
+            //    uint8_t ModIndex = (uint8_t)(RecordID->formID >> 24);
+            //    ModFile *ModID = RecordID->GetParentMod();
+            //    uint8_t CollapsedIndex = ModID->FormIDHandler.CollapseTable[ModIndex];
+            //    char * LongID = CollapsedIndex >= ModID->TES4.MAST.size() ? ModID->ModName : ModID->TES4.MAST[CollapsedIndex];
+            //    VSDPRINT(RecordID->GetStrType());
+            //    PRINT_FIELD_IDENTIFIERS;
+            //    printer("SetField: Error! Record (%s, 0x%06X) in mod (%s) contains an invalid FormID!\n", LongID, RecordID->formID & 0x00FFFFFF, ModID->ModName);
+            //    }
+            }
+
+        //A cell's grid position may have changed
+        RecordID->GetParentMod()->Parent->InvalidateLandGrid(RecordID);
+        RecordID->IsChanged(true);
+        return;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    //PRINT_RECORD_IDENTIFIERS;
+    PRINT_FIELD_IDENTIFIERS;
+    printer("ArraySize: %i\n\n", ArraySize);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return;
+    }
+
+CPPDLLEXTERN int32_t SetFields(RECORDIDARRAY RecordIDs, const FieldSpec *FieldSpecs, void **FieldValues, const uint32_t *ArraySizes, const uint32_t NumItems, SINT32ARRAY Statuses)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        ValidatePointer(RecordIDs);
+        ValidatePointer(FieldSpecs);
+        ValidatePointer(FieldValues);
+        ValidatePointer(ArraySizes);
+
+        //Group the items by record, keeping the given order within each record
+        std::vector<std::pair<Record *, uint32_t> > items;
+        items.reserve(NumItems);
+        for(uint32_t x = 0; x < NumItems; ++x)
+            items.push_back(std::make_pair(RecordIDs[x], x));
+        std::sort(items.begin(), items.end());
+
+        int32_t applied = 0;
+        for(uint32_t x = 0; x < items.size();)
+            {
+            Record *RecordID = items[x].first;
+            uint32_t end = x;
+            while(end < items.size() && items[end].first == RecordID)
+                ++end;
+
+            bool bLoaded = true;
+            try
+                {
+                //Ensure the record is fully loaded
+                if(!RecordID->IsLoaded())
+                    {
+                    RecordReader reader(RecordID);
+                    reader.Accept(RecordID);
+                    }
+                }
+            catch(std::exception &ex)
+                {
+                PRINT_EXCEPTION(ex);
+                bLoaded = false;
+                }
+            catch(...)
+                {
+                PRINT_ERROR;
+                bLoaded = false;
+                }
+
+            bool bCheckFormIDs = false, bChanged = false;
+            for(; x < end; ++x)
+                {
+                const uint32_t &item = items[x].second;
+                const FieldSpec &spec = FieldSpecs[item];
+                int32_t status = -1;
+                if(bLoaded)
+                    {
+                    try
+                        {
+                        //returns true if formIDs need to be checked
+                        if(RecordID->SetField(spec.FieldID, spec.ListIndex, spec.ListFieldID, spec.ListX2Index, spec.ListX2FieldID, spec.ListX3Index, spec.ListX3FieldID, FieldValues[item], ArraySizes[item]))
+                            bCheckFormIDs = true;
+                        bChanged = true;
+                        status = 0;
+                        ++applied;
+                        }
+                    catch(std::exception &ex)
+                        {
+                        PRINT_EXCEPTION(ex);
+                        }
+                    catch(...)
+                        {
+                        PRINT_ERROR;
+                        }
+                    }
+                if(Statuses != NULL)
+                    Statuses[item] = status;
+                }
+
+            //Change tracking is deferred until every item for the record is applied
+            if(bCheckFormIDs)
+                {
+                //Update the master list if needed
+                FormIDMasterUpdater checker(RecordID);
+                RecordID->VisitFormIDs(checker);
+                }
+            if(bChanged)
+                {
+                //A cell's grid position may have changed
+                RecordID->GetParentMod()->Parent->InvalidateLandGrid(RecordID);
+                RecordID->IsChanged(true);
+                }
+            }
+        return applied;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("NumItems: %i\n\n", NumItems);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN void DeleteField(Record *RecordID, FIELD_IDENTIFIERS)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        //ValidatePointer(RecordID);
+
+        //Ensure the record is fully loaded
+        if(!RecordID->IsLoaded())
+            {
+            RecordReader reader(RecordID);
+            reader.Accept(RecordID);
+            }
+
+        RecordID->DeleteField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID);
+
+        //A cell's grid position may have changed
+        RecordID->GetParentMod()->Parent->InvalidateLandGrid(RecordID);
+        RecordID->IsChanged(true);
+        return;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    //PRINT_RECORD_IDENTIFIERS;
+    PRINT_FIELD_IDENTIFIERS;
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return;
+    }
+////////////////////////////////////////////////////////////////////////
+//Field info functions
+CPPDLLEXTERN uint32_t GetFieldAttribute(Record *RecordID, FIELD_IDENTIFIERS, const uint32_t WhichAttribute)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        //ValidatePointer(RecordID);
+
+        if(WhichAttribute > 0)
+            {
+            //Any attribute other than type requires the record to be read
+            //Ensure the record is fully loaded
+            if(!RecordID->IsLoaded() || RecordID->GetParentMod()->Parent->IsConcurrentReads)
+                {
+                RecordReader reader(RecordID);
+                reader.Accept(RecordID);
+                }
+            }
+
+        return RecordID->GetFieldAttribute(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, WhichAttribute);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    //PRINT_RECORD_IDENTIFIERS;
+    PRINT_FIELD_IDENTIFIERS;
+    printer("WhichAttribute: %i\n\n", WhichAttribute);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return UNKNOWN_FIELD;
+    }
+
+CPPDLLEXTERN void * GetField(Record *RecordID, FIELD_IDENTIFIERS, void **FieldValues)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        //ValidatePointer(ModID);
+        //ValidatePointer(RecordID);
+
+        //Ensure the record is fully loaded
+        //Concurrent readers always go through the reader, since it synchronizes the loading
+        if(!RecordID->IsLoaded() || RecordID->GetParentMod()->Parent->IsConcurrentReads)
+            {
+            RecordReader reader(RecordID);
+            reader.Accept(RecordID);
+            }
+
+        return RecordID->GetField(FieldID, ListIndex, ListFieldID, ListX2Index, ListX2FieldID, ListX3Index, ListX3FieldID, FieldValues);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    //PRINT_RECORD_IDENTIFIERS;
+    PRINT_FIELD_IDENTIFIERS;
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return NULL;
+    }
+
+CPPDLLEXTERN int32_t GetFields(Record *RecordID, const FieldSpec *FieldSpecs, const uint32_t NumFields, void * const *FieldBuffers, void **FieldValues)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(RecordID);
+        ValidatePointer(FieldSpecs);
+        ValidatePointer(FieldValues);
+
+        GetRecordFields(RecordID, FieldSpecs, NumFields, FieldBuffers, FieldValues);
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("NumFields: %i\n\n", NumFields);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetRecordsFields(Record **RecordIDs, const uint32_t NumRecords, const FieldSpec *FieldSpecs, const uint32_t NumFields, void * const *FieldBuffers, void **FieldValues, SINT32ARRAY Statuses)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        ValidatePointer(RecordIDs);
+        ValidatePointer(FieldSpecs);
+        ValidatePointer(FieldValues);
+
+        int32_t retrieved = 0;
+        for(uint32_t x = 0; x < NumRecords; ++x)
+            {
+            int32_t status = -1;
+            try
+                {
+                GetRecordFields(RecordIDs[x], FieldSpecs, NumFields, FieldBuffers != NULL ? &FieldBuffers[x * NumFields] : NULL, &FieldValues[x * NumFields]);
+                status = 0;
+                ++retrieved;
+                }
+            catch(std::exception &ex)
+                {
+                PRINT_EXCEPTION(ex);
+                }
+            catch(...)
+                {
+                PRINT_ERROR;
+                }
+            //A failed record's values are cleared rather than left half filled
+            if(status != 0)
+                for(uint32_t f = 0; f < NumFields; ++f)
+                    FieldValues[x * NumFields + f] = NULL;
+            if(Statuses != NULL)
+                Statuses[x] = status;
+            }
+        return retrieved;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("NumRecords: %i, NumFields: %i\n\n", NumRecords, NumFields);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetFieldColumn(ModFile *ModID, const uint32_t RecordType, const FieldSpec *Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t ValueSize, FORMIDARRAY FormIDs, void *Values, UINT8ARRAY Present, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(ModID);
+        ValidatePointer(Field);
+        if(NumTypes != 0)
+            ValidatePointer(SubrecordTypes);
+        FieldColumnRetriever retriever(*Field, SubrecordTypes, NumTypes, ValueSize, FormIDs, Values, Present, MaxRecords);
+        ModID->VisitRecords(RecordType, retriever);
+        return retriever.GetCount();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("RecordType: %08X, ValueSize: %i, MaxRecords: %i\n\n", RecordType, ValueSize, MaxRecords);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetWinningFieldColumn(Collection *CollectionID, const uint32_t RecordType, const FieldSpec *Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t ValueSize, FORMIDARRAY FormIDs, void *Values, UINT8ARRAY Present, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        ValidatePointer(CollectionID);
+        ValidatePointer(Field);
+        if(NumTypes != 0)
+            ValidatePointer(SubrecordTypes);
+        FieldColumnRetriever retriever(*Field, SubrecordTypes, NumTypes, ValueSize, FormIDs, Values, Present, MaxRecords, true);
+        for(uint32_t x = 0; x < CollectionID->ModFiles.size() && !retriever.Stop(); ++x)
+            CollectionID->ModFiles[x]->VisitRecords(RecordType, retriever);
+        return retriever.GetCount();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("RecordType: %08X, ValueSize: %i, MaxRecords: %i\n\n", RecordType, ValueSize, MaxRecords);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetMatchingRecordIDs(ModFile *ModID, const uint32_t RecordType, const FieldPredicate *Predicates, const uint32_t NumPredicates, RECORDIDARRAY RecordIDs, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(ModID);
+        RecordPredicateFilter filter(Predicates, NumPredicates, RecordIDs, MaxRecords);
+        ModID->VisitRecords(RecordType, filter);
+        return filter.GetCount();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("RecordType: %08X, NumPredicates: %i, MaxRecords: %i\n\n", RecordType, NumPredicates, MaxRecords);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t ExportModJSON(ModFile *ModID, char * const FileName, bool (*_LineCallback)(const char *))
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(ModID);
+        if(FileName == NULL && _LineCallback == NULL)
+            throw std::runtime_error("Either a file name or a line callback is required.");
+        RecordJSONExporter exporter(FileName, _LineCallback);
+        ModID->VisitAllRecords(exporter);
+        if(!exporter.Close())
+            throw std::runtime_error("Unable to write the export file.");
+        return exporter.GetCount();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t ExportCollectionJSON(Collection *CollectionID, char * const FileName, bool (*_LineCallback)(const char *))
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        if(FileName == NULL && _LineCallback == NULL)
+            throw std::runtime_error("Either a file name or a line callback is required.");
+        RecordJSONExporter exporter(FileName, _LineCallback);
+        for(uint32_t p = 0; p < CollectionID->ModFiles.size() && !exporter.Stop(); ++p)
+            CollectionID->ModFiles[p]->VisitAllRecords(exporter);
+        if(!exporter.Close())
+            throw std::runtime_error("Unable to write the export file.");
+        return exporter.GetCount();
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+////////////////////////////////////////////////////////////////////////
+//Snapshot functions
+CPPDLLEXTERN int32_t SaveCollectionSnapshot(Collection *CollectionID, char * const FileName)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        ValidatePointer(FileName);
+        if(!Snapshot::Save(CollectionID, FileName))
+            throw std::runtime_error("Unable to write the snapshot file.");
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN Snapshot * OpenCollectionSnapshot(Collection *CollectionID, char * const FileName, bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *))
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(CollectionID);
+        ValidatePointer(FileName);
+        if(CollectionID->Monitor != NULL)
+            throw std::runtime_error("Unable to open the snapshot. The collection is being loaded by a load task.");
+        return Snapshot::OpenOrRebuild(CollectionID, FileName, _ProgressCallback);
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return NULL;
+    }
+
+CPPDLLEXTERN int32_t CloseCollectionSnapshot(Snapshot *SnapshotID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        delete SnapshotID;
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t IsSnapshotRebuilt(Snapshot *SnapshotID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        return SnapshotID->IsRebuilt ? 1 : 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotNumMods(Snapshot *SnapshotID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        return (int32_t)SnapshotID->Header->NumMods;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotModInfo(Snapshot *SnapshotID, const uint32_t ModIndex, SnapshotModInfo *Info)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        ValidatePointer(Info);
+        if(ModIndex >= SnapshotID->Header->NumMods)
+            throw std::runtime_error("The mod index is outside the snapshot.");
+        SnapshotID->GetModInfo(ModIndex, *Info);
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("ModIndex: %u\n\n", ModIndex);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotNumRecords(Snapshot *SnapshotID)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        return (int32_t)SnapshotID->Header->NumRecords;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("\n\n");
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotRecords(Snapshot *SnapshotID, const FORMID FormID, SnapshotRecordInfo *Records, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        const SnapshotRecord *first = NULL;
+        uint32_t count = std::min(SnapshotID->FindRecords(FormID, first), MaxRecords);
+        for(uint32_t x = 0; x < count; ++x)
+            SnapshotID->GetRecordInfo(first[x], Records[x]);
+        return (int32_t)count;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("FormID: %08X, MaxRecords: %u\n\n", FormID, MaxRecords);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotRecordsByEditorID(Snapshot *SnapshotID, char * const EditorID, SnapshotRecordInfo *Records, const uint32_t MaxRecords)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        ValidatePointer(EditorID);
+        const SnapshotEditorID *first = NULL;
+        uint32_t count = std::min(SnapshotID->FindEditorIDs(EditorID, first), MaxRecords);
+        for(uint32_t x = 0; x < count; ++x)
+            SnapshotID->GetRecordInfo(SnapshotID->Records[first[x].RecordIndex], Records[x]);
+        return (int32_t)count;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("MaxRecords: %u\n\n", MaxRecords);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN int32_t GetSnapshotWinningRecord(Snapshot *SnapshotID, const FORMID FormID, SnapshotRecordInfo *Record)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        ValidatePointer(Record);
+        const SnapshotRecord *first = NULL;
+        uint32_t count = SnapshotID->FindRecords(FormID, first);
+        for(uint32_t x = 0; x < count; ++x)
+            {
+            if(first[x].IsWinning)
+                {
+                SnapshotID->GetRecordInfo(first[x], *Record);
+                return 1;
+                }
+            }
+        return 0;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    printer("FormID: %08X\n\n", FormID);
+    if(RaiseCallback != NULL)
+        RaiseCallback(__FUNCTION__);
+    return -1;
+    }
+
+CPPDLLEXTERN Record * GetSnapshotRecordID(Snapshot *SnapshotID, Collection *CollectionID, const SnapshotRecordInfo *Record)
+    {
+    PROFILE_FUNC
+
+    try
+        {
+        //ValidatePointer(SnapshotID);
+        //ValidatePointer(CollectionID);
+        ValidatePointer(Record);
+        return SnapshotID->GetRecord(CollectionID, *Record);
         }
     catch(std::exception &ex)
         {
@@ -1903,8 +3180,6 @@ CPPDLLEXTERN void * GetField(Record *RecordID, FIELD_IDENTIFIERS, void **FieldVa
         {
         PRINT_ERROR;
         }
-    //PRINT_RECORD_IDENTIFIERS;
-    PRINT_FIELD_IDENTIFIERS;
     printer("\n\n");
     if(RaiseCallback != NULL)
         RaiseCallback(__FUNCTION__);
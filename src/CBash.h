@@ -91,6 +91,89 @@ DLLEXTERN void RedirectMessages(int32_t (*_LoggingCallback)(const char *));
 */
 DLLEXTERN void AllowRaising(void (*_RaiseCallback)(const char *));
 
+/**
+    @brief Switches the built in profiler on or off.
+    @details While it is on, the C API functions and the internal load and save
+             phases (GRUP scan, inflate, ParseRecord, indexing and write) are
+             timed. Each thread records into its own table, up to a fixed
+             number of threads after which the rest share one, and the tables
+             are summed by GetProfileReport(). While it is off, each probe costs a single
+             flag check. Samples recorded so far are kept when it is switched off.
+    @param Enable Whether to record samples.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SetProfiling(const bool Enable);
+
+/**
+    @brief Gets the samples recorded by the profiler as JSON.
+    @details The report is an object with an `enabled` flag, the number of
+             sample tables allocated in `tables`, how many of them were handed
+             back by exited threads and are waiting for new ones in
+             `free_tables`, the number of running threads that record into the
+             shared table in `shared_threads`, and a `points` array. The points
+             include the samples of threads that have exited. Each point that
+             was reached has its `name`, `calls`,
+             `total_ns`, `mean_ns`, `max_ns`, and a `histogram` of
+             `[lower bound in ns, calls]` pairs whose buckets double in width.
+
+             The report is copied into \p Report and null terminated, and is
+             truncated if it doesn't fit. Pass `NULL` to only get its length.
+    @param Report A buffer of \p ReportSize characters to copy the report into, or `NULL`.
+    @param ReportSize The size of \p Report, including space for the terminating null.
+    @param Reset Whether to clear the samples once the report is built. They are only cleared if the whole report was copied.
+    @returns The length of the whole report, not counting the terminating null, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetProfileReport(char *Report, const uint32_t ReportSize, const bool Reset);
+
+/**
+    @brief Switches the recording of load and save trace spans on or off.
+    @details While it is on, CBash records timed spans for collection loads
+             (preloading masters, each LoadTES4(), each plugin and each of
+             its top level record groups, UndeleteRecords and fingerprinting)
+             and for saves (each plugin and each record type written). Each
+             span gives the plugin name where relevant, and the records and
+             inflated bytes handled within it. Enabling tracing discards any
+             spans not yet written. By default at most 65536 spans are held, and once
+             that many are, each new span replaces the oldest.
+    @param Enable Whether to record spans.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SetTracing(const bool Enable);
+
+/**
+    @brief Writes the recorded trace spans to a file, then discards them.
+    @details The file uses the Chrome trace event format, so it can be opened
+             in `chrome://tracing` or Perfetto to see the spans on a timeline.
+             `otherData.dropped_events` counts the oldest spans that were
+             replaced before they could be written.
+    @param FileName The path of the file to write. An existing file is overwritten.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t WriteTrace(char * const FileName);
+
+/**
+    @brief Sets the lowest level of message that CBash logs.
+    @details Messages below the level are discarded before they are
+             formatted. Logged messages are queued and written by a
+             background thread, like other messages, to the callback passed to
+             RedirectMessages() or to standard output, and to the log file if
+             one was opened. They may appear shortly after the call that logged
+             them, and the thread is stopped when the last collection is
+             deleted. Each place in the code may log a burst of messages each
+             second, and further messages from it are counted and reported as
+             suppressed. Consecutive identical messages are collapsed into a
+             repeat count.
+    @param Level The lowest level to log, one of ::logLevels. ::eLogNone disables logging.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SetLogLevel(const uint32_t Level);
+
+/**
+    @brief Writes any queued log messages before returning.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t FlushLog();
+
 ///@}
 /**************************//**
     @name Collection action functions
@@ -100,6 +183,10 @@ DLLEXTERN void AllowRaising(void (*_RaiseCallback)(const char *));
 /**
     @brief Create a plugin collection.
     @details Collections are used to manage groups of mod plugins and their data in CBash.
+             Collections that load the same plugin file share one read only
+             mapping of it. Only the file's bytes are shared: each collection
+             still scans the plugin and builds its own records, since loading
+             rewrites every record's FormIDs for that collection's load order.
     @param ModsPath Specifies the path to the folder containing the mod plugins that are to be added to the collection.
     @param CollectionType Specifies the type of game the collection is for. Valid game types are given by ::whichGameTypes.
     @returns A pointer to the newly-created collection_t object.
@@ -118,11 +205,64 @@ DLLEXTERN int32_t DeleteCollection(collection_t *CollectionID);
     @brief Loads a collection of plugins.
     @details Loads the records from the plugins in the given collection into memory, where their data can be accessed.
     @param CollectionID A pointer to the collection to load.
-    @param _ProgressCallback A pointer to a function to use as a progress callback. If `NULL`, no progress is reported. The function arguments are the load order position of the plugin currently being loaded, the maximum load order position, and the plugin filename. The function returns a boolean that is currently ignored, but may in future be used to signal cancellation of loading by the client.
-    @returns `0` on success, `-1` if an error occurred.
+    @param _ProgressCallback A pointer to a function to use as a progress callback. If `NULL`, no progress is reported. The function arguments are the load order position of the plugin currently being loaded, the maximum load order position, and the plugin filename. The function returns `false` to cancel loading before that plugin is loaded.
+    @returns `0` on success, `1` if the load was cancelled, `-1` if an error occurred. A cancelled collection can only be deleted.
 */
 DLLEXTERN int32_t LoadCollection(collection_t *CollectionID, bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *));
 
+/**
+    @brief Loads a collection of plugins on a background thread.
+    @details Does the same as LoadCollection(), but returns immediately. The
+             load is followed with GetLoadProgress() or WaitForLoad(), and may
+             be stopped with CancelLoad(). Cancellation takes effect between
+             the top level record groups of a plugin, and leaves a collection
+             that can only be deleted.
+
+             No other function may be called on the collection until the load
+             has stopped, except for the load task functions. Errors are
+             printed, but don't raise the error callback. They are reported
+             as ::eLoadFailed instead.
+
+             CloseLoadTask() must be called once the task is no longer needed,
+             and before the collection is deleted.
+    @param CollectionID A pointer to the collection to load.
+    @returns A handle to the load task, or `NULL` if an error occurred.
+*/
+DLLEXTERN load_task_t * LoadCollectionAsync(collection_t *CollectionID);
+
+/**
+    @brief Gets the progress of a load started by LoadCollectionAsync().
+    @param TaskID The load task to query.
+    @param Progress A pointer to a ::LoadProgress structure to fill, or `NULL` if only the state is wanted.
+    @returns The state of the load, one of ::loadStates, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetLoadProgress(load_task_t *TaskID, LoadProgress *Progress);
+
+/**
+    @brief Waits for a load started by LoadCollectionAsync() to stop.
+    @param TaskID The load task to wait for.
+    @param Timeout The longest time to wait, in milliseconds. If `0`, waits until the load stops.
+    @returns The state of the load, one of ::loadStates, or `-1` if an error occurred. ::eLoadRunning means the wait timed out.
+*/
+DLLEXTERN int32_t WaitForLoad(load_task_t *TaskID, const uint32_t Timeout);
+
+/**
+    @brief Asks a load started by LoadCollectionAsync() to stop.
+    @details The request is asynchronous. Use WaitForLoad() to know when the
+             load has stopped, which may be after it finished anyway.
+    @param TaskID The load task to cancel.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t CancelLoad(load_task_t *TaskID);
+
+/**
+    @brief Frees a load task started by LoadCollectionAsync().
+    @details A load that is still running is cancelled and waited for first.
+    @param TaskID The load task to free. The handle is invalid afterwards.
+    @returns The final state of the load, one of ::loadStates, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t CloseLoadTask(load_task_t *TaskID);
+
 /**
     @brief Unloads a collection of plugins.
     @details Unloads any records from the plugins in the given collection that have previously been loaded into memory, without deleting the collection.
@@ -138,6 +278,32 @@ DLLEXTERN int32_t UnloadCollection(collection_t *CollectionID);
 */
 DLLEXTERN int32_t GetCollectionType(collection_t *CollectionID);
 
+/**
+    @brief Allow a loaded collection to be queried from several threads at once.
+    @details While enabled, records are read under a lock the first time any
+             thread needs them, are always read in full, and are never
+             unloaded (UnloadRecord() does nothing), so a record stays valid
+             for every thread using it. The winning state of every record is
+             determined when the mode is enabled, so that later queries don't
+             modify the records.
+
+             The following functions may then be called concurrently on the
+             collection: GetField(), GetFieldAttribute(), GetFields(),
+             GetRecordsFields(), GetRecordID(), GetLongIDName(),
+             IsRecordWinning(), GetNumRecordConflicts(), GetRecordConflicts(),
+             GetRecordHistory(), GetNumRecords() and GetRecordIDs(). Any
+             function that changes the collection, its plugins or its records
+             must not run at the same time as them. Creating and deleting
+             other collections is always safe.
+
+             Since nothing is unloaded, memory use grows with the number of
+             records queried. Disable the mode before editing the collection.
+    @param CollectionID The collection to set the mode for. It should already be loaded.
+    @param Enable Whether to enable or disable concurrent reads.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SetConcurrentReads(collection_t *CollectionID, const bool Enable);
+
 /**
     @brief Unload all collections of plugins that have been created by CBash.
     @details Unloads all loaded collections from memory, without deleting them. Has the same effect as calling UnloadCollection() for each collection that has been created.
@@ -195,6 +361,8 @@ DLLEXTERN int32_t CleanModMasters(mod_t *ModID);
     @brief Save a single plugin's data to a plugin file.
     @param ModID A pointer to the plugin object to save.
     @param SaveFlagsField Flags that determine how the plugin is saved. These flags are given in ::saveFlags.
+                          With ::fIsWriteStrings, a localized Skyrim plugin's string files are written alongside it.
+                          The plugin and its string files are replaced together, or not at all.
     @param DestinationName The output plugin filename.
     @returns `0` on success, `-1` if an error occurred.
 */
@@ -482,6 +650,49 @@ DLLEXTERN size_t GetNumRecords(mod_t *ModID, const uint32_t RecordType);
 */
 DLLEXTERN int32_t GetRecordIDs(mod_t *ModID, const uint32_t RecordType, record_t ** RecordIDs);
 
+/**
+    @brief Open a cursor over the records of a specified type in a plugin.
+    @details The records are gathered in a single pass, and can then be
+             fetched in fixed-size chunks with NextRecords(), instead of
+             calling GetNumRecords() and allocating an array for
+             GetRecordIDs(). Records are returned in the same order as
+             GetRecordIDs().
+
+             The cursor isn't updated if records of the type are created or
+             deleted while it is open, and deleted records must not be used.
+    @param ModID The plugin to query.
+    @param RecordType The record type to look for.
+    @returns A pointer to the cursor, to be closed with CloseRecordCursor(), or `NULL` if an error occurred.
+*/
+DLLEXTERN cursor_t * OpenRecordCursor(mod_t *ModID, const uint32_t RecordType);
+
+/**
+    @brief Open a cursor over the winning records of a specified type in a collection.
+    @details As OpenRecordCursor(), but covers every plugin in the collection
+             and only keeps the records for which IsRecordWinning() is true
+             without extended conflicts.
+    @param CollectionID The collection to query.
+    @param RecordType The record type to look for.
+    @returns A pointer to the cursor, to be closed with CloseRecordCursor(), or `NULL` if an error occurred.
+*/
+DLLEXTERN cursor_t * OpenWinningRecordCursor(collection_t *CollectionID, const uint32_t RecordType);
+
+/**
+    @brief Get the next chunk of records from a cursor.
+    @param CursorID The cursor to read from.
+    @param RecordIDs An array of at least \p MaxRecords record pointers. This function populates the array.
+    @param MaxRecords The maximum number of records to get.
+    @returns The number of records retrieved, `0` once the cursor is exhausted, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t NextRecords(cursor_t *CursorID, record_t ** RecordIDs, const uint32_t MaxRecords);
+
+/**
+    @brief Close a cursor, freeing its memory.
+    @param CursorID The cursor to close.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t CloseRecordCursor(cursor_t *CursorID);
+
 /**
     @brief Check if the given record is winning any conflict with other records.
     @details A record wins a conflict if it is the last-loaded version of that record in the load order.
@@ -517,6 +728,38 @@ DLLEXTERN int32_t GetRecordConflicts(record_t *RecordID, record_t ** RecordIDs,
 */
 DLLEXTERN int32_t GetRecordHistory(record_t *RecordID, record_t ** RecordIDs);
 
+/**
+    @brief Compute the conflicts of every record of a plugin in one pass.
+    @details For each record of \p ModID, its conflicting records are found
+             and sorted as GetRecordConflicts() would. All of them are
+             computed with a single walk over the collection's indexes, and
+             stored in the collection until retrieved with GetConflictMatrix().
+    @param ModID The plugin whose records are the rows of the matrix.
+    @param RecordType The record type to limit the rows to, or `0` for all types.
+    @param GetExtendedConflicts If true, conflicts from plugins loaded with ::fIsExtendedConflicts are included.
+    @param NumRows A pointer that receives the number of rows, which is the number of records of the plugin that are included.
+    @returns The total number of conflicting records over all rows, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t BuildConflictMatrix(mod_t *ModID, const uint32_t RecordType, const bool GetExtendedConflicts, uint32_t *NumRows);
+
+/**
+    @brief Retrieve the conflict matrix computed by BuildConflictMatrix().
+    @details The matrix is returned in compressed sparse row form: the
+             conflicts of `RowIDs[x]` are
+             `RecordIDs[Offsets[x]]` to `RecordIDs[Offsets[x + 1] - 1]`. The
+             computed matrix is then released.
+
+             This fails if \p ModID isn't a plugin of a live collection, or if
+             the collection's last built matrix was for another plugin or has
+             already been retrieved.
+    @param ModID The plugin that was passed to BuildConflictMatrix().
+    @param RowIDs An array of record pointers, pre-allocated to the number of rows.
+    @param Offsets An array of offsets, pre-allocated to the number of rows plus one.
+    @param RecordIDs An array of record pointers, pre-allocated to the size returned by BuildConflictMatrix().
+    @returns The number of rows retrieved, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetConflictMatrix(mod_t *ModID, record_t **RowIDs, uint32_t *Offsets, record_t **RecordIDs);
+
 /**
     @brief Get the number of Identical To Master records in a plugin.
     @details Identical To Master records are unedited copies of records present in a plugin's masters.
@@ -534,6 +777,52 @@ DLLEXTERN int32_t GetNumIdenticalToMasterRecords(mod_t *ModID);
 */
 DLLEXTERN int32_t GetIdenticalToMasterRecords(mod_t *ModID, record_t ** RecordIDs);
 
+/**
+    @brief Get stable fingerprints of records.
+    @details A fingerprint is a 64-bit FNV-1a hash of the record's type,
+             header flags and decompressed subrecord data, with every FormID
+             in it normalized to its long form (the name of the originating
+             plugin and the object ID). Fingerprints therefore don't depend on
+             the load order, the plugin's masters or whether the record is
+             compressed, and can be stored and compared across sessions.
+             Two records with the same fingerprint almost certainly hold the
+             same data; records with different fingerprints never do.
+
+             Fingerprints of unchanged records are cached. Records that aren't
+             cached are fingerprinted in parallel.
+    @param RecordIDs An input array of records to fingerprint. The records may belong to different collections.
+    @param Fingerprints An output array of fingerprints, one for each record in RecordIDs.
+    @param ArraySize The size of the RecordIDs and Fingerprints arrays.
+    @returns The number of fingerprints retrieved, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetRecordFingerprints(record_t **RecordIDs, uint64_t *Fingerprints, const uint32_t ArraySize);
+
+/**
+    @brief Compare the records of two plugins.
+    @details Records are matched by their long FormID (or by editor ID, for
+             records keyed by it), and visited in FormID order. The plugins may
+             belong to different collections. For each difference, the
+             callback is given the kind of change (one of ::diffChanges), the
+             record in each plugin (`NULL` on the side that doesn't have it)
+             and, for modified records, the signatures of the subrecords that
+             differ. A modified record with no changed subrecords differs only
+             in its header flags or type.
+
+             Records are first compared by fingerprint, then by their
+             normalized subrecord bytes. If both plugins share a load order,
+             records whose bytes differ are finally checked with the typed
+             comparison, so insignificant differences aren't reported.
+    @param ModID The first plugin, such as the older version.
+    @param OtherModID The second plugin, such as the newer version.
+    @param _DiffCallback A function that receives each difference. It should
+                         return `true` to continue the comparison, or `false`
+                         to stop it. The subrecord array is only valid for the
+                         duration of the call. May be `NULL` to only count the
+                         differences.
+    @returns The number of differences found, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t DiffMods(mod_t *ModID, mod_t *OtherModID, bool (*_DiffCallback)(const uint32_t Change, record_t *RecordID, record_t *OtherRecordID, const uint32_t *Subrecords, const uint32_t NumSubrecords));
+
 /**
     @brief Check if a record's FormID or any of the FormIDs referenced by the record are invalid.
     @param RecordID The record to check.
@@ -541,6 +830,70 @@ DLLEXTERN int32_t GetIdenticalToMasterRecords(mod_t *ModID, record_t ** RecordID
 */
 DLLEXTERN int32_t IsRecordsFormIDsInvalid(record_t *RecordID);
 
+/**
+    @brief Get the cells spanned by a worldspace's landscape.
+    @param WorldRecordID A pointer to a `WRLD` record.
+    @param MinX Outputs the smallest cell X coordinate with a `LAND` record.
+    @param MinY Outputs the smallest cell Y coordinate with a `LAND` record.
+    @param MaxX Outputs the largest cell X coordinate with a `LAND` record.
+    @param MaxY Outputs the largest cell Y coordinate with a `LAND` record.
+    @returns The number of cells with a `LAND` record, or `-1` if an error occurred. The bounds are only set if it is greater than `0`.
+*/
+DLLEXTERN int32_t GetWorldHeightmapBounds(record_t *WorldRecordID, int32_t *MinX, int32_t *MinY, int32_t *MaxX, int32_t *MaxY);
+
+/**
+    @brief Decode a worldspace's landscape into a single heightmap.
+    @details Each cell spans 32 quads and shares its edge vertices with its
+             neighbours, so the heightmap is `(MaxX - MinX + 1) * 32 + 1`
+             vertices wide and `(MaxY - MinY + 1) * 32 + 1` vertices high.
+             It is stored row by row, from south to north, with each row
+             running from west to east. Heights are in game units. Cells
+             from every loaded mod that overrides the worldspace are used,
+             and each cell's `LAND` is the winning override of that record.
+    @param WorldRecordID A pointer to a `WRLD` record.
+    @param MinX The westmost cell to decode.
+    @param MinY The southmost cell to decode.
+    @param MaxX The eastmost cell to decode.
+    @param MaxY The northmost cell to decode.
+    @param Heights An output array of at least \p MaxHeights floats.
+    @param MaxHeights The size of \p Heights. It is an error if the whole heightmap doesn't fit.
+    @param NoData The height given to vertices that aren't covered by a `LAND` record with height data.
+    @returns The number of `LAND` records decoded, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetWorldHeightmap(record_t *WorldRecordID, const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, float *Heights, const uint32_t MaxHeights, const float NoData);
+
+/**
+    @brief Get the `LAND` record of a worldspace cell.
+    @details Uses the worldspace's grid index, which is only built for plugins
+             loaded with ::fIsIndexLANDs. The index is rebuilt on first use
+             after a cell or `LAND` in the worldspace is created, copied or
+             edited. Neighbouring `LAND` records are
+             found by offsetting the position by one cell.
+    @param WorldRecordID A pointer to a `WRLD` record.
+    @param PosX The cell's X grid position.
+    @param PosY The cell's Y grid position.
+    @returns The cell's `LAND` record, or `NULL` if it has none or an error occurred.
+*/
+DLLEXTERN record_t * GetWorldLand(record_t *WorldRecordID, const int32_t PosX, const int32_t PosY);
+
+/**
+    @brief Get the `LAND` records of a range of worldspace cells.
+    @details Uses the worldspace's grid index, which is only built for plugins
+             loaded with ::fIsIndexLANDs. The index is rebuilt on first use
+             after a cell or `LAND` in the worldspace is created, copied or
+             edited. Records are returned from south to
+             north, with each row running from west to east.
+    @param WorldRecordID A pointer to a `WRLD` record.
+    @param MinX The westmost cell to include.
+    @param MinY The southmost cell to include.
+    @param MaxX The eastmost cell to include.
+    @param MaxY The northmost cell to include.
+    @param RecordIDs An array of at least \p MaxRecords records, filled with the `LAND` records found.
+    @param MaxRecords The maximum number of records to return.
+    @returns The number of records returned, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetWorldLands(record_t *WorldRecordID, const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, record_t **RecordIDs, const uint32_t MaxRecords);
+
 ///@}
 /**************************//**
     @name Mod or Record action functions
@@ -559,6 +912,30 @@ DLLEXTERN int32_t IsRecordsFormIDsInvalid(record_t *RecordID);
 */
 DLLEXTERN int32_t UpdateReferences(mod_t *ModID, record_t *RecordID, FORMID * OldFormIDs, FORMID * NewFormIDs, uint32_t * Changes, const uint32_t ArraySize);
 
+/**
+    @brief Merge the leveled lists of a collection into a patch plugin.
+    @details Every version of each leveled list of the given type is merged
+             in load order, starting from the original. Each version adds the
+             entries it introduces. Versions from plugins tagged ::fIsRelev
+             also replace the entries whose levels or counts they changed, and
+             set the chance none and flags. Versions from plugins tagged
+             ::fIsDelev remove the entries they dropped from the original. The
+             merged entries are sorted by level.
+
+             A list is written to the patch if the merge result differs from
+             the winning version, or if the patch already overrides it.
+             Supported types are `LVLC`, `LVLI` and `LVSP` for Oblivion,
+             `LVLC`, `LVLI` and `LVLN` for Fallout: New Vegas, and `LVLI`,
+             `LVLN` and `LVSP` for Skyrim.
+    @param PatchModID The plugin to write the merged lists to. Its own versions of the lists are ignored as inputs.
+    @param RecordType The leveled list type to merge.
+    @param ModIDs An input array of plugins that have tags. Plugins not in the array are merged without tags.
+    @param Tags An input array of ::levListTags combinations, one for each plugin in ModIDs.
+    @param ArraySize The size of the ModIDs and Tags arrays.
+    @returns The number of lists written to the patch, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t MergeLeveledLists(mod_t *PatchModID, const uint32_t RecordType, mod_t **ModIDs, const uint32_t *Tags, const uint32_t ArraySize);
+
 ///@}
 /**************************//**
     @name Mod or Record info functions
@@ -605,6 +982,27 @@ DLLEXTERN int32_t SetIDFields(record_t *RecordID, const FORMID FormID, char * co
 */
 DLLEXTERN void   SetField(record_t *RecordID, FIELD_IDENTIFIERS, void *FieldValue, const uint32_t ArraySize);
 
+/**
+    @brief Set many fields, possibly across many records, in a single call.
+    @details Item `x` sets the field \p FieldSpecs[x] of \p RecordIDs[x] to
+             \p FieldValues[x], as SetField() would. Items are grouped by
+             record: each record is loaded once, its master list is updated
+             once and it is marked as changed once, after all of its items
+             have been applied. Items for the same record are applied in the
+             order they are given.
+
+             A failing item does not stop the others and does not trigger the
+             raise callback; its failure is reported through \p Statuses.
+    @param RecordIDs An array of \p NumItems records.
+    @param FieldSpecs An array of \p NumItems field specifications.
+    @param FieldValues An array of \p NumItems values to set.
+    @param ArraySizes An array of \p NumItems byte sizes, as passed to SetField().
+    @param NumItems The number of fields to set.
+    @param Statuses An array of \p NumItems status codes, set to `0` for each item that was applied and `-1` for each that failed. May be `NULL`.
+    @returns The number of items applied, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SetFields(record_t **RecordIDs, const FieldSpec *FieldSpecs, void **FieldValues, const uint32_t *ArraySizes, const uint32_t NumItems, int32_t *Statuses);
+
 /**
     @brief
     @details
@@ -658,4 +1056,294 @@ DLLEXTERN uint32_t GetFieldAttribute(record_t *RecordID, FIELD_IDENTIFIERS, cons
 */
 DLLEXTERN void * GetField(record_t *RecordID, FIELD_IDENTIFIERS, void **FieldValues);
 
+/**
+    @brief Get several fields of a record in a single call.
+    @details The record is loaded once, and each field is then retrieved as
+             GetField() would retrieve it, without the per-call overhead of
+             repeated API calls.
+
+             Each element of \p FieldValues receives the value GetField()
+             returns for the corresponding field specification. Fields that
+             GetField() returns through a caller supplied array, such as lists
+             of strings, need that array given in the matching element of
+             \p FieldBuffers; the output element then points to it. Other
+             fields need no buffer, and their output element receives the
+             value directly. \p FieldValues is only ever written, so it can be
+             reused across calls.
+    @param RecordID The record in which the fields are found.
+    @param FieldSpecs An array of \p NumFields field specifications.
+    @param NumFields The number of fields to get.
+    @param FieldBuffers An array of \p NumFields buffers, `NULL` for fields that need none. May be `NULL` if no field needs one.
+    @param FieldValues An array of \p NumFields values, filled in the order of \p FieldSpecs.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetFields(record_t *RecordID, const FieldSpec *FieldSpecs, const uint32_t NumFields, void * const *FieldBuffers, void **FieldValues);
+
+/**
+    @brief Get the same set of fields from several records in a single call.
+    @details Behaves as GetFields() called once per record. \p FieldBuffers
+             and \p FieldValues are laid out row-major: the elements for
+             record `i` start at index `i * NumFields`.
+
+             A failing record does not stop the others and does not trigger
+             the raise callback. Its values are set to `NULL` and its failure
+             is reported through \p Statuses.
+    @param RecordIDs An array of \p NumRecords records.
+    @param NumRecords The number of records.
+    @param FieldSpecs An array of \p NumFields field specifications.
+    @param NumFields The number of fields to get from each record.
+    @param FieldBuffers An array of `NumRecords * NumFields` buffers, as for GetFields(). May be `NULL`.
+    @param FieldValues An array of `NumRecords * NumFields` values.
+    @param Statuses An array of \p NumRecords status codes, set to `0` for each record read and `-1` for each that failed. May be `NULL`.
+    @returns The number of records read, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetRecordsFields(record_t **RecordIDs, const uint32_t NumRecords, const FieldSpec *FieldSpecs, const uint32_t NumFields, void * const *FieldBuffers, void **FieldValues, int32_t *Statuses);
+
+/**
+    @brief Get one field from every record of a type in a plugin, as columns.
+    @details Records are visited in the same order as GetRecordIDs(). For
+             each record, its FormID is written to \p FormIDs, the field value
+             is written to \p Values and the corresponding bit of \p Present is
+             set if the field has a value. Records are unloaded again after
+             their field has been copied, unless they were already loaded.
+
+             When values are copied, only the subrecords given in
+             \p SubrecordTypes (and always EDID) are decoded. The others are
+             skipped by size, and the record is left partially loaded until
+             it is unloaded again. Any other access to such a record reads it
+             in full first. The subrecord types of the field must all be
+             listed, including any subrecord that a list element starts with.
+
+             Only fields that GetField() returns directly can be extracted
+             this way. Fields whose type depends on the record, such as
+             FormID or integer references, are resolved per record.
+    @param ModID The plugin to get the records from.
+    @param RecordType The record type.
+    @param Field The field to get.
+    @param SubrecordTypes An array of \p NumTypes subrecord types to decode, such as `'DATA'`. May be `NULL` if \p NumTypes is `0`.
+    @param NumTypes The number of subrecord types. If `0`, records are read in full.
+    @param ValueSize The size in bytes of each value, which are copied into
+                     \p Values. Copying fails if a record's field is not of a
+                     fixed size type of exactly this size, so strings, arrays
+                     and lists can't be copied. If `0`, the pointers returned
+                     by GetField() are stored instead, array and list fields
+                     are reported as absent, and the records are left loaded
+                     so that the pointers remain valid.
+    @param FormIDs An array of at least \p MaxRecords FormIDs.
+    @param Values An array of at least \p MaxRecords values of \p ValueSize bytes.
+    @param Present A bitmap of at least `(MaxRecords + 7) / 8` bytes. Bit `x % 8` of byte `x / 8` is set if record `x` has the field.
+    @param MaxRecords The maximum number of records to get. The number of records can be obtained using GetNumRecords().
+    @returns The number of records written, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetFieldColumn(mod_t *ModID, const uint32_t RecordType, const FieldSpec *Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t ValueSize, FORMID *FormIDs, void *Values, uint8_t *Present, const uint32_t MaxRecords);
+
+/**
+    @brief Get one field from every winning record of a type in a collection, as columns.
+    @details As GetFieldColumn(), but visits the records of every plugin in
+             the collection and keeps only those that are winning, as
+             determined by IsRecordWinning() without extended conflicts.
+    @param CollectionID The collection to query.
+    @param RecordType The record type.
+    @param Field The field to get.
+    @param SubrecordTypes The subrecord types to decode. See GetFieldColumn().
+    @param NumTypes The number of subrecord types.
+    @param ValueSize The size in bytes of each value. See GetFieldColumn().
+    @param FormIDs An array of at least \p MaxRecords FormIDs.
+    @param Values An array of at least \p MaxRecords values of \p ValueSize bytes.
+    @param Present A bitmap of at least `(MaxRecords + 7) / 8` bytes.
+    @param MaxRecords The maximum number of records to get.
+    @returns The number of records written, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetWinningFieldColumn(collection_t *CollectionID, const uint32_t RecordType, const FieldSpec *Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t ValueSize, FORMID *FormIDs, void *Values, uint8_t *Present, const uint32_t MaxRecords);
+
+/**
+    @brief Get the records of a type in a plugin whose fields match a set of predicates.
+    @details The predicates are evaluated natively while the records are
+             visited, so only the matching record IDs are returned. The
+             predicates are joined as described by ::predicateJoins.
+
+             Fields whose type depends on the record are resolved per record
+             and compared as the type they hold. Numeric fields are compared
+             with the predicate's `Value`, and strings and 4 character codes
+             with its `String`, for equality only. A field that a record doesn't have never
+             matches. The scan fails if a predicate names an array or list
+             field, or any other type that can't be compared.
+
+             If every predicate gives the subrecord type that holds its field,
+             only those subrecords are decoded. Records read for the scan are
+             unloaded again, unless they were already loaded.
+    @param ModID The plugin to search.
+    @param RecordType The record type.
+    @param Predicates An array of \p NumPredicates predicates.
+    @param NumPredicates The number of predicates. If `0`, every record matches.
+    @param RecordIDs An array of at least \p MaxRecords records, filled with the matching records in the same order as GetRecordIDs().
+    @param MaxRecords The maximum number of records to return.
+    @returns The number of matching records returned, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetMatchingRecordIDs(mod_t *ModID, const uint32_t RecordType, const FieldPredicate *Predicates, const uint32_t NumPredicates, record_t **RecordIDs, const uint32_t MaxRecords);
+
+/**
+    @brief Writes every record of a plugin as a line of JSON.
+    @details Each line is an object with the plugin name (`mod`), record type
+             (`type`), FormID (`formid`), parent record FormID (`parent`, if
+             any) and the record's fields (`fields`). Fields are keyed by
+             their field ID, as used by GetField(), and fields that aren't
+             present are left out. Lists are arrays of objects keyed by their
+             list field IDs. FormIDs are written as long FormIDs, a
+             `[master name, object ID]` pair, or `null` if they are `0`.
+             Strings are converted from Windows-1252 to UTF-8.
+
+             Records are visited group by group. Each record is read just
+             before it is written, and unloaded again afterwards unless it
+             was already loaded or has changed, so when the plugin is loaded
+             with ::fIsMinLoad the export doesn't keep record data in memory.
+             Child records, such as the references of a cell, are written on
+             their own lines.
+    @param ModID The plugin to export.
+    @param FileName The path of the file to write, or `NULL` to only call \p _LineCallback.
+    @param _LineCallback A function called with each line, without its line break, or `NULL`. The function returns `false` to stop the export after that record.
+    @returns The number of records written, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t ExportModJSON(mod_t *ModID, char * const FileName, bool (*_LineCallback)(const char *));
+
+/**
+    @brief Writes every record of every plugin in a collection as a line of JSON.
+    @details Does the same as ExportModJSON() for each plugin in load order,
+             into a single file.
+    @param CollectionID The collection to export.
+    @param FileName The path of the file to write, or `NULL` to only call \p _LineCallback.
+    @param _LineCallback A function called with each line, without its line break, or `NULL`. The function returns `false` to stop the export after that record.
+    @returns The number of records written, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t ExportCollectionJSON(collection_t *CollectionID, char * const FileName, bool (*_LineCallback)(const char *));
+
+///@}
+
+/**
+    @name Snapshot functions
+    @details A snapshot stores the plugins, FormID tables and record index of
+             a loaded collection in a single file. It is memory mapped when
+             opened, so a later run against the same plugins can answer record
+             queries without loading the collection.
+*/
+///@{
+
+/**
+    @brief Saves a snapshot of a loaded collection.
+    @details Each record is stored with its position in its plugin. Record
+             data isn't stored. Any existing file is replaced.
+    @param CollectionID The collection to save. It must have been loaded, and the records of plugins on disk mustn't have unsaved changes.
+    @param FileName The path of the snapshot file to write.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t SaveCollectionSnapshot(collection_t *CollectionID, char * const FileName);
+
+/**
+    @brief Opens a snapshot of a collection, rebuilding it if it is out of date.
+    @details The snapshot is used if it was saved with the plugins that have
+             been added to the collection, with the same flags and in the same
+             order, and none of its plugins have changed size, modification
+             time or header record since. The collection is left unloaded in
+             that case, so it has no records: the functions that take a
+             ::record_t pointer can't be used with it until it is loaded,
+             either by LoadCollection() or by the first call to
+             GetSnapshotRecordID().
+
+             Otherwise the collection is loaded as by LoadCollection() and a
+             new snapshot is saved over \p FileName. IsSnapshotRebuilt()
+             tells the two cases apart.
+
+             The snapshot stays valid after the collection is deleted, and must
+             be freed with CloseCollectionSnapshot().
+    @param CollectionID The collection the snapshot describes, with its plugins added.
+    @param FileName The path of the snapshot file.
+    @param _ProgressCallback A progress callback for the fallback load. See LoadCollection().
+    @returns A handle to the snapshot, or `NULL` if the fallback load was cancelled or an error occurred.
+*/
+DLLEXTERN snapshot_t * OpenCollectionSnapshot(collection_t *CollectionID, char * const FileName, bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *));
+
+/**
+    @brief Frees a snapshot opened by OpenCollectionSnapshot().
+    @param SnapshotID The snapshot to close. The handle, and any strings and tables got from it, are invalid afterwards.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t CloseCollectionSnapshot(snapshot_t *SnapshotID);
+
+/**
+    @brief Checks whether OpenCollectionSnapshot() had to load the collection to rebuild the snapshot.
+    @param SnapshotID The snapshot to query.
+    @returns `1` if the collection was loaded and the snapshot saved again, `0` if the existing snapshot was used, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t IsSnapshotRebuilt(snapshot_t *SnapshotID);
+
+/**
+    @brief Gets the number of plugins in a snapshot.
+    @details This includes any masters that were added while the collection was loaded.
+    @param SnapshotID The snapshot to query.
+    @returns The number of plugins, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotNumMods(snapshot_t *SnapshotID);
+
+/**
+    @brief Gets a plugin stored in a snapshot.
+    @param SnapshotID The snapshot to query.
+    @param ModIndex The index of the plugin, in the order they were added to the collection.
+    @param Info A pointer to a ::SnapshotModInfo structure to fill.
+    @returns `0` on success, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotModInfo(snapshot_t *SnapshotID, const uint32_t ModIndex, SnapshotModInfo *Info);
+
+/**
+    @brief Gets the number of records in a snapshot.
+    @param SnapshotID The snapshot to query.
+    @returns The number of records, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotNumRecords(snapshot_t *SnapshotID);
+
+/**
+    @brief Gets every version of a record stored in a snapshot.
+    @details The versions are returned in plugin order. There is at most one
+             version per plugin, so an array of GetSnapshotNumMods() entries
+             is always big enough.
+    @param SnapshotID The snapshot to query.
+    @param FormID The FormID of the record.
+    @param Records An array of at least \p MaxRecords ::SnapshotRecordInfo structures to fill.
+    @param MaxRecords The maximum number of versions to return.
+    @returns The number of versions returned, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotRecords(snapshot_t *SnapshotID, const FORMID FormID, SnapshotRecordInfo *Records, const uint32_t MaxRecords);
+
+/**
+    @brief Gets the records stored in a snapshot that have an editor ID.
+    @details The editor ID is compared case insensitively. Records are
+             returned in FormID order, then in plugin order.
+    @param SnapshotID The snapshot to query.
+    @param EditorID The editor ID to look up.
+    @param Records An array of at least \p MaxRecords ::SnapshotRecordInfo structures to fill.
+    @param MaxRecords The maximum number of records to return.
+    @returns The number of records returned, or `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotRecordsByEditorID(snapshot_t *SnapshotID, char * const EditorID, SnapshotRecordInfo *Records, const uint32_t MaxRecords);
+
+/**
+    @brief Gets the winning version of a record stored in a snapshot.
+    @param SnapshotID The snapshot to query.
+    @param FormID The FormID of the record.
+    @param Record A pointer to a ::SnapshotRecordInfo structure to fill.
+    @returns `1` if the winning version was found, `0` if it wasn't, `-1` if an error occurred.
+*/
+DLLEXTERN int32_t GetSnapshotWinningRecord(snapshot_t *SnapshotID, const FORMID FormID, SnapshotRecordInfo *Record);
+
+/**
+    @brief Gets the loaded record described by a snapshot entry.
+    @details If the collection was left unloaded by OpenCollectionSnapshot(),
+             it is loaded first, as by LoadCollection(), so the first call can
+             take as long as a full load.
+    @param SnapshotID The snapshot the entry was got from.
+    @param CollectionID The collection the snapshot was opened for.
+    @param Record The snapshot entry, as filled by one of the snapshot query functions.
+    @returns The record, or `NULL` if it is no longer in its plugin, the load was cancelled, or an error occurred.
+*/
+DLLEXTERN record_t * GetSnapshotRecordID(snapshot_t *SnapshotID, collection_t *CollectionID, const SnapshotRecordInfo *Record);
+
 ///@}
@@ -39,6 +39,11 @@
 #ifdef _WIN32
 #include <direct.h>
 #endif
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <chrono>
 
 //#include <boost/threadpool.hpp>
 
@@ -156,10 +161,13 @@ Collection::Collection(char * const &ModsPath, uint32_t _CollectionType):
     IsLoaded(false),
     CollectionType(),
     identical_records(),
+    conflict_mod(NULL),
     changed_records(),
     filter_records(),
     filter_wspaces(),
-    filter_inclusive(false)
+    filter_inclusive(false),
+    IsConcurrentReads(false),
+    Monitor(NULL)
     {
     if(_CollectionType >= eIsUnknownGameType)
         throw std::runtime_error("CreateCollection: Error - Unable to create the collection. Invalid collection type specified.\n");
@@ -271,6 +279,7 @@ ModFile * Collection::IsModAdded(char * const &ModName)
 
 int32_t Collection::SaveMod(ModFile *&curModFile, SaveFlags &flags, char * const DestinationName)
     {
+    TRACE_SPAN("Save", curModFile->ModName);
     if(!curModFile->Flags.IsSaveable)
         {
         log_error << "SaveMod: Error - Unable to save mod \"" << curModFile->ModName << "\". It is flagged as being non-saveable.\n";
@@ -299,16 +308,70 @@ int32_t Collection::SaveMod(ModFile *&curModFile, SaveFlags &flags, char * const
 #endif
 
     char * temp_name = GetTemporaryFileName(DestinationName != NULL ? DestinationName : curModFile->ModName); //deleted when RenameOp is destroyed
+    if(temp_name == NULL)
+        return -1;
+
+    //A mod is saved in the form it was read in, so only localized Skyrim mods have string files to write.
+    //Changing the form would mean converting names that are still read as plain strings (CELL, WRLD, DIAL, QUST, FACT).
+    StringTableWriter strings;
+    bool bWriteStrings = false;
+    if(flags.IsWriteStrings)
+        {
+        if(CollectionType != eIsSkyrim)
+            log_warning << "SaveMod: Warning - Unable to write the string files of mod \"" << curModFile->ModName << "\". Only Skyrim mods have string files.\n";
+        else if(!curModFile->TES4.IsLookupStrings())
+            log_warning << "SaveMod: Warning - Unable to write the string files of mod \"" << curModFile->ModName << "\". It isn't localized, and will be saved unlocalized.\n";
+        else
+            bWriteStrings = true;
+        }
+
+    //The mod and its string files are written to temp files, and then replace the old ones together or not at all
+    std::vector<RenameOp *> ops;
+    ops.push_back(new RenameOp(temp_name, DestinationName != NULL ? DestinationName : curModFile->FileName));
+    uint32_t performed = 0;
+    try
+        {
+        bool written = curModFile->Save(temp_name, Expanders, flags.IsCloseCollection, indexer, bWriteStrings ? &strings : NULL) == 0;
+        //The string files are named after the mod, next to it
+        if(written && bWriteStrings)
+            written = strings.Write(DestinationName != NULL ? DestinationName : curModFile->ModName, ops);
+        if(written)
+            {
+            for(; performed < ops.size(); ++performed)
+                if(!ops[performed]->perform())
+                    break;
+            }
+        }
+    catch(...)
+        {
+        for(uint32_t x = 0; x < ops.size(); ++x)
+            {
+            ops[x]->rollback();
+            delete ops[x];
+            }
+        throw;
+        }
 
-    //Save the mod to temp file
-    curModFile->Save(temp_name, Expanders, flags.IsCloseCollection, indexer);
-    RenameOp *op = new RenameOp(temp_name, DestinationName != NULL ? DestinationName : curModFile->FileName);
-    op->perform();
+    const bool bCommitted = performed == ops.size();
+    for(uint32_t x = (uint32_t)ops.size(); x-- > 0;)
+        {
+        if(!bCommitted)
+            ops[x]->rollback();
+        delete ops[x];
+        }
+    if(!bCommitted)
+        {
+        log_error << "SaveMod: Error - Unable to save mod \"" << curModFile->ModName << "\". Its files were left as they were.\n";
+        return -1;
+        }
     return 0;
     }
 
 int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *))
     {
+    PROFILE_FUNC
+    TRACE_SPAN("Load");
+
     ModFile *curModFile = NULL;
     RecordIndexer indexer(EditorID_ModFile_Record, FormID_ModFile_Record, EDIDIndex);
     RecordIndexer extended_indexer(ExtendedEditorID_ModFile_Record, ExtendedFormID_ModFile_Record, EDIDIndex);
@@ -320,6 +383,10 @@ int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_
         log_warning << "Load: Warning - Unable to load collection. It is already loaded.\n";
         return 0;
         }
+    if(!Expanders.empty())
+        throw std::runtime_error("Unable to load collection. An earlier load was cancelled or failed part way through, so the collection must be deleted and created again.");
+    LoadMonitor local_monitor;
+    LoadMonitor &monitor = Monitor != NULL ? *Monitor : local_monitor;
     try
         {
 #ifdef _WIN32
@@ -330,22 +397,28 @@ int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_
         //Brute force approach to loading all masters
         //Could be done more elegantly with recursion
         //printer("Before Preloading\n");
-        do {
-            Preloading = false;
-            for(uint32_t p = 0; p < (uint32_t)ModFiles.size(); ++p)
-                {
-                curModFile = ModFiles[p];
-                curModFile->LoadTES4();
-                if(!curModFile->Flags.IsCreateNew && curModFile->Flags.IsAddMasters)
+            {
+            TRACE_SPAN("Preloading");
+            do {
+                Preloading = false;
+                for(uint32_t p = 0; p < (uint32_t)ModFiles.size(); ++p)
                     {
-                    //Any new mods loaded this way inherit their flags
-                    ModFlags preloadFlags(curModFile->Flags.GetFlags());
-                    preloadFlags.IsNoLoad = !curModFile->Flags.IsLoadMasters;
-                    for(uint8_t x = 0; x < curModFile->TES4.MAST.size(); ++x)
-                        Preloading = (AddMod(curModFile->TES4.MAST[x], preloadFlags, true) != NULL || Preloading);
+                    curModFile = ModFiles[p];
+                        {
+                        TRACE_SPAN("LoadTES4", curModFile->ModName);
+                        curModFile->LoadTES4();
+                        }
+                    if(!curModFile->Flags.IsCreateNew && curModFile->Flags.IsAddMasters)
+                        {
+                        //Any new mods loaded this way inherit their flags
+                        ModFlags preloadFlags(curModFile->Flags.GetFlags());
+                        preloadFlags.IsNoLoad = !curModFile->Flags.IsLoadMasters;
+                        for(uint8_t x = 0; x < curModFile->TES4.MAST.size(); ++x)
+                            Preloading = (AddMod(curModFile->TES4.MAST[x], preloadFlags, true) != NULL || Preloading);
+                        }
                     }
-                }
-        }while(Preloading);
+            }while(Preloading);
+            }
         //printer("Load order before sort\n");
         //for(uint32_t x = 0; x < ModFiles.size(); ++x)
         //    printer("%02X: %s\n", x, ModFiles[x]->FileName);
@@ -382,15 +455,27 @@ int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_
         uint8_t expandedIndex = 0;
         uint32_t x = 0;
 
+        uint64_t BytesTotal = 0;
+        for(uint32_t p = 0; p < (uint32_t)ModFiles.size(); ++p)
+            if(ModFiles[p]->file_map.is_open())
+                BytesTotal += ModFiles[p]->file_map.size();
+        monitor.BytesTotal = BytesTotal;
+        monitor.NumMods = (uint32_t)ModFiles.size();
+
         for(uint32_t p = 0; p < (uint32_t)ModFiles.size(); ++p)
         {
             curModFile = ModFiles[p];
 
             if(_ProgressCallback && !(*_ProgressCallback)(p, (uint32_t)ModFiles.size() - 1, curModFile->FileName))
-            {
-                /* TODO: clean abort */
-            }
+                monitor.IsCancelled = true;
+            if(monitor.IsCancelled)
+                break;
 
+            monitor.ModIndex = p;
+            monitor.ModBytesRead = 0;
+            monitor.ModBytesTotal = curModFile->file_map.is_open() ? curModFile->file_map.size() : 0;
+
+            TRACE_SPAN("Load mod", curModFile->ModName);
             RecordReader read_parser(curModFile);
             //Loads GRUP and Record Headers.  Fully loads GMST records.
             curModFile->FormIDHandler.SetLoadOrder((curModFile->Flags.IsInLoadOrder || curModFile->Flags.IsIgnoreInactiveMasters) ? strLoadOrder255 : strAllLoadOrder[x++]);
@@ -403,16 +488,45 @@ int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_
             RecordIndexer &used_indexer = curModFile->Flags.IsExtendedConflicts ? extended_indexer : indexer;
             used_indexer.SetModFile(curModFile);
             curModFile->SetFilter(filter_inclusive, filter_records, filter_wspaces);
+            curModFile->Monitor = &monitor;
             curModFile->Load(read_parser, used_indexer, Expanders, DeletedRecords.back().second);
+            curModFile->Monitor = NULL;
+            if(monitor.IsCancelled)
+                break;
+            monitor.BytesDone += monitor.ModBytesTotal;
+            monitor.ModBytesRead = monitor.ModBytesTotal.load();
+            monitor.BytesRead = monitor.BytesDone;
         }
         //printer("Loaded\n");
         strAllLoadOrder.clear();
+        if(monitor.IsCancelled)
+            {
+            //The mods loaded so far are left as they are, and are freed along with the collection
+            log_warning << "Load: Warning - The collection load was cancelled.\n";
+            return 1;
+            }
         UndeleteRecords(DeletedRecords);
+
+        //Fingerprinting waits until every mod is loaded, since it needs the final load order
+        for(uint32_t p = 0; p < (uint32_t)ModFiles.size(); ++p)
+            {
+            curModFile = ModFiles[p];
+            if(!curModFile->Flags.IsFingerprintRecords)
+                continue;
+            TRACE_SPAN("Fingerprint", curModFile->ModName);
+            RecordCursor loaded;
+            RecordCursorFiller filler(loaded);
+            std::vector<uint64_t> hashes;
+            curModFile->VisitAllRecords(filler);
+            FingerprintRecords(loaded.records, hashes);
+            }
         IsLoaded = true;
         }
     catch(...)
         {
         IsLoaded = false;
+        if(curModFile != NULL)
+            curModFile->Monitor = NULL;
         throw;
         }
     return 0;
@@ -420,6 +534,7 @@ int32_t Collection::Load(bool (*_ProgressCallback)(const uint32_t, const uint32_
 
 void Collection::UndeleteRecords(std::vector<std::pair<ModFile *, std::vector<Record *> > > &DeletedRecords)
     {
+    TRACE_SPAN("UndeleteRecords");
     //Deleted records are only composed of their header. All of their data is missing.
     //This makes undeleting a record a bit tricky since you can't just toggle the records IsDeleted flag.
     //This function tries to restore the data of all deleted records so that toggling the IsDeleted flag works as expected.
@@ -518,6 +633,7 @@ void Collection::UndeleteRecords(std::vector<std::pair<ModFile *, std::vector<Re
 int32_t Collection::Unload()
     {
     RecordUnloader unloader;
+    fingerprints.clear();
     for(uint32_t ListIndex = 0; ListIndex < ModFiles.size(); ++ListIndex)
         ModFiles[ListIndex]->VisitAllRecords(unloader);
     return 0;
@@ -643,6 +759,46 @@ EditorID_Iterator Collection::LookupWinningRecord(char * const &RecordEditorID,
     return EditorID_ModFile_Record.end();
     }
 
+void Collection::SetConcurrentReads(const bool Enable)
+    {
+    if(Enable && !IsConcurrentReads)
+        {
+        //Winning flags are cached on the records as they're looked up, so they're all determined up front
+        for(uint32_t p = 0; p < ModFiles.size(); ++p)
+            {
+            RecordCursor loaded;
+            RecordCursorFiller filler(loaded);
+            ModFiles[p]->VisitAllRecords(filler);
+            for(uint32_t x = 0; x < loaded.records.size(); ++x)
+                IsWinningRecord(loaded.records[x], true);
+            }
+        }
+    IsConcurrentReads = Enable;
+    }
+
+std::mutex &Collection::ReadLock(Record *curRecord)
+    {
+    return read_locks[((size_t)curRecord >> 4) % NUMREADLOCKS];
+    }
+
+bool Collection::IsWinningRecord(Record *curRecord, const bool GetExtendedConflicts)
+    {
+    if(!curRecord->IsWinningDetermined())
+        {
+        ModFile *WinningModFile = NULL;
+        Record *WinningRecord = NULL;
+        if(curRecord->IsKeyedByEditorID())
+            LookupWinningRecord(curRecord->GetEditorIDKey(), WinningModFile, WinningRecord, true);
+        else
+            LookupWinningRecord(curRecord->formID, WinningModFile, WinningRecord, true);
+        }
+    if(GetExtendedConflicts)
+        return curRecord->IsExtendedWinning();
+    else if(curRecord->GetParentMod()->Flags.IsExtendedConflicts)
+        return false;
+    return curRecord->IsWinning();
+    }
+
 uint32_t Collection::GetNumRecordConflicts(Record *&curRecord, const bool GetExtendedConflicts)
     {
     uint32_t count = 0;
@@ -667,6 +823,7 @@ uint32_t Collection::GetNumRecordConflicts(Record *&curRecord, const bool GetExt
 
 int32_t Collection::GetRecordConflicts(Record *&curRecord, RECORDIDARRAY RecordIDs, const bool GetExtendedConflicts)
     {
+    std::vector<Record *> sortedConflicts;
     ModFile *curModFile = NULL;
     if(curRecord->IsKeyedByEditorID())
         {
@@ -715,7 +872,6 @@ int32_t Collection::GetRecordConflicts(Record *&curRecord, RECORDIDARRAY RecordI
         std::sort(sortedConflicts.begin(), sortedConflicts.end(), compConflicts);
         for(uint32_t x = 0; x < y; ++x)
             RecordIDs[x] = sortedConflicts[x];
-        sortedConflicts.clear();
         }
     return y;
     }
@@ -730,6 +886,7 @@ int32_t Collection::GetRecordHistory(Record *&curRecord, RECORDIDARRAY RecordIDs
         return -1;
         }
 
+    std::vector<Record *> sortedConflicts;
     uint8_t curCollapsedIndex = curModFile->FormIDHandler.CollapsedIndex;
     const uint8_t (&CollapseTable)[256] = curModFile->FormIDHandler.CollapseTable;
 
@@ -765,11 +922,178 @@ int32_t Collection::GetRecordHistory(Record *&curRecord, RECORDIDARRAY RecordIDs
         std::sort(sortedConflicts.begin(), sortedConflicts.end(), compHistory);
         for(uint32_t x = 0; x < y; ++x)
             RecordIDs[x] = sortedConflicts[x];
-        sortedConflicts.clear();
         }
     return y;
     }
 
+uint32_t Collection::BuildConflictMatrix(ModFile *curModFile, const uint32_t RecordType, const bool GetExtendedConflicts)
+    {
+    //Each row is a record of the mod followed by its conflicts, in the same order as GetRecordConflicts
+    //The indexes are walked once, key by key, instead of being looked up per record
+    conflict_mod = curModFile;
+    conflict_rows.clear();
+    conflict_offsets.clear();
+    conflict_records.clear();
+
+    const bool IsExtended = curModFile->Flags.IsExtendedConflicts;
+    FormID_Map &FormID_Index = IsExtended ? ExtendedFormID_ModFile_Record : FormID_ModFile_Record;
+    EditorID_Map &EditorID_Index = IsExtended ? ExtendedEditorID_ModFile_Record : EditorID_ModFile_Record;
+    ModFile *testModFile = NULL;
+    Record *rowRecord = NULL;
+
+    for(FormID_Iterator it = FormID_Index.begin(); it != FormID_Index.end();)
+        {
+        FormID_Iterator end = it;
+        while(end != FormID_Index.end() && end->first == it->first)
+            ++end;
+        rowRecord = NULL;
+        for(FormID_Iterator row = it; row != end; ++row)
+            if(row->second->GetParentMod() == curModFile && !row->second->IsKeyedByEditorID() && (RecordType == 0 || row->second->GetType() == RecordType))
+                {
+                rowRecord = row->second;
+                break;
+                }
+        if(rowRecord != NULL)
+            {
+            conflict_rows.push_back(rowRecord);
+            conflict_offsets.push_back((uint32_t)conflict_records.size());
+            for(uint32_t pass = 0; pass < 2; ++pass)
+                {
+                //Normal conflicts first, then extended ones if asked for
+                if(pass == 1 && !GetExtendedConflicts)
+                    break;
+                FormID_Range range = (pass == 1) == IsExtended ? FormID_Range(it, end) : (pass == 1 ? ExtendedFormID_ModFile_Record : FormID_ModFile_Record).equal_range(it->first);
+                for(; range.first != range.second; ++range.first)
+                    {
+                    testModFile = range.first->second->GetParentMod();
+                    if(testModFile->Flags.IsInLoadOrder || testModFile->Flags.IsIgnoreInactiveMasters)
+                        conflict_records.push_back(range.first->second);
+                    }
+                }
+            std::sort(conflict_records.begin() + conflict_offsets.back(), conflict_records.end(), compConflicts);
+            }
+        it = end;
+        }
+
+    for(EditorID_Iterator it = EditorID_Index.begin(); it != EditorID_Index.end();)
+        {
+        EditorID_Iterator end = it;
+        while(end != EditorID_Index.end() && !EditorID_Index.key_comp()(it->first, end->first))
+            ++end;
+        rowRecord = NULL;
+        for(EditorID_Iterator row = it; row != end; ++row)
+            if(row->second->GetParentMod() == curModFile && row->second->IsKeyedByEditorID() && (RecordType == 0 || row->second->GetType() == RecordType))
+                {
+                rowRecord = row->second;
+                break;
+                }
+        if(rowRecord != NULL)
+            {
+            conflict_rows.push_back(rowRecord);
+            conflict_offsets.push_back((uint32_t)conflict_records.size());
+            for(uint32_t pass = 0; pass < 2; ++pass)
+                {
+                if(pass == 1 && !GetExtendedConflicts)
+                    break;
+                EditorID_Range range = (pass == 1) == IsExtended ? EditorID_Range(it, end) : (pass == 1 ? ExtendedEditorID_ModFile_Record : EditorID_ModFile_Record).equal_range(it->first);
+                for(; range.first != range.second; ++range.first)
+                    {
+                    testModFile = range.first->second->GetParentMod();
+                    if(testModFile->Flags.IsInLoadOrder || testModFile->Flags.IsIgnoreInactiveMasters)
+                        conflict_records.push_back(range.first->second);
+                    }
+                }
+            std::sort(conflict_records.begin() + conflict_offsets.back(), conflict_records.end(), compConflicts);
+            }
+        it = end;
+        }
+
+    conflict_offsets.push_back((uint32_t)conflict_records.size());
+    return (uint32_t)conflict_records.size();
+    }
+
+void Collection::FingerprintRecords(std::vector<Record *> &Records, std::vector<uint64_t> &Fingerprints)
+    {
+    Fingerprints.resize(Records.size());
+
+    //Only fingerprint records that don't have a usable cached value
+    std::vector<uint32_t> pending;
+    for(uint32_t x = 0; x < Records.size(); ++x)
+        {
+        Record *curRecord = Records[x];
+        if(!curRecord->IsChanged())
+            {
+            boost::unordered_map<Record *, std::pair<unsigned char *, uint64_t> >::iterator cached = fingerprints.find(curRecord);
+            if(cached != fingerprints.end() && cached->second.first == curRecord->recData)
+                {
+                Fingerprints[x] = cached->second.second;
+                continue;
+                }
+            }
+        pending.push_back(x);
+        }
+
+    if(pending.empty())
+        return;
+
+    //Each record is only touched by the thread that claimed it, so the records
+    // can be read and hashed independently. Records must be unique in the list.
+    //Messages and failures are kept per worker and reported once they've all finished.
+    uint32_t numThreads = pending.size() < 64 ? 1 : std::min<uint32_t>(NUMTHREADS, (uint32_t)pending.size() / 64);
+    std::vector<std::exception_ptr> failures(numThreads);
+    std::vector<std::vector<std::pair<int32_t, std::string> > > messages(numThreads);
+    std::atomic<uint32_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&](const uint32_t index)
+        {
+        LogCapture capture;
+        RecordFingerprinter fingerprinter;
+        try
+            {
+            for(uint32_t x = next++; x < pending.size() && !failed; x = next++)
+                {
+                fingerprinter.Accept(Records[pending[x]]);
+                Fingerprints[pending[x]] = fingerprinter.fingerprint;
+                }
+            }
+        catch(...)
+            {
+            failures[index] = std::current_exception();
+            failed = true;
+            }
+        messages[index].swap(capture.messages);
+        };
+
+    //Small batches aren't worth the thread startup
+    if(numThreads <= 1)
+        worker(0);
+    else
+        {
+        std::vector<std::thread> threads;
+        for(uint32_t x = 0; x < numThreads; ++x)
+            threads.push_back(std::thread(worker, x));
+        for(uint32_t x = 0; x < threads.size(); ++x)
+            threads[x].join();
+        }
+
+    std::exception_ptr failure;
+    for(uint32_t x = 0; x < numThreads; ++x)
+        {
+        LogCapture::Report(messages[x]);
+        if(failures[x] != NULL && failure == NULL)
+            failure = failures[x];
+        }
+    if(failure != NULL)
+        std::rethrow_exception(failure);
+
+    for(uint32_t x = 0; x < pending.size(); ++x)
+        {
+        Record *curRecord = Records[pending[x]];
+        if(!curRecord->IsChanged())
+            fingerprints[curRecord] = std::make_pair(curRecord->recData, Fingerprints[pending[x]]);
+        }
+    }
+
 uint32_t Collection::NextFreeExpandedFormID(ModFile *&curModFile, uint32_t depth)
     {
     uint32_t curFormID = curModFile->FormIDHandler.NextExpandedFormID();
@@ -861,6 +1185,7 @@ Record * Collection::CreateRecord(ModFile *&curModFile, const uint32_t &RecordTy
             LookupWinningRecord(curRecord->formID, WinningModfile, WinningRecord, true);
         }
 
+    InvalidateLandGrid(curRecord);
     return curRecord;
     }
 
@@ -968,7 +1293,7 @@ Record * Collection::CopyRecord(Record *&curRecord, ModFile *&DestModFile, const
         return RecordCopy;
 
     //Copy over the internal flags
-    RecordCopy->CBash_Flags = curRecord->CBash_Flags;
+    RecordCopy->CBash_Flags = curRecord->CBash_Flags.load();
     if(!curRecord->IsChanged())
         RecordCopy->IsLoaded(false);
 
@@ -1009,6 +1334,7 @@ Record * Collection::CopyRecord(Record *&curRecord, ModFile *&DestModFile, const
             LookupWinningRecord(RecordCopy->formID, WinningModfile, WinningRecord, true);
         }
 
+    InvalidateLandGrid(RecordCopy);
     if(reader.result) //If the record was read, go ahead and unload it
         RecordCopy->Unload();
     return RecordCopy;
@@ -1225,8 +1551,81 @@ bool RecordDeindexer::Accept(Record *&curRecord)
     return false;
     }
 
+RecordFingerprinter::RecordFingerprinter():
+    RecordOp(),
+    writer(NULL, BUFFERSIZE),
+    fingerprint(FINGERPRINT_SEED)
+    {
+    header[0] = header[1] = header[2] = 0;
+    }
+
+RecordFingerprinter::~RecordFingerprinter()
+    {
+    //
+    }
+
+void RecordFingerprinter::Serialize(Record *curRecord, const uint8_t *CanonicalTable)
+    {
+    RecordReader reader(curRecord);
+    reader.Accept(curRecord);
+
+    //The compression flag only describes how the data is stored on disk
+    header[0] = curRecord->GetType();
+    header[1] = curRecord->IsCompressed() ? curRecord->flags & ~0x00040000 : curRecord->flags;
+
+    //The record is written with load order independent formIDs, the same way a save writes it with collapsed ones,
+    // so the record is fingerprinted the same way no matter where it was loaded
+    //Other readers are kept out while the formIDs are swapped, as they are while the record is read
+    Collection *Parent = curRecord->GetParentMod()->Parent;
+    std::unique_lock<std::mutex> lock;
+    if(Parent->IsConcurrentReads)
+        lock = std::unique_lock<std::mutex>(Parent->ReadLock(curRecord));
+    normalizer.Normalize(curRecord->GetParentMod(), CanonicalTable);
+    header[2] = normalizer.NormalizeFormID(curRecord->formID);
+    writer.record_clear();
+    try
+        {
+        curRecord->VisitFormIDs(normalizer);
+        if(!curRecord->IsDeleted())
+            curRecord->WriteRecord(writer);
+        }
+    catch(...)
+        {
+        normalizer.Restore();
+        throw;
+        }
+    normalizer.Restore();
+    if(lock.owns_lock())
+        lock.unlock();
+
+    fingerprint = HashBytes(&header[0], sizeof(header), normalizer.hash);
+    fingerprint = HashBytes(writer.record_data(), writer.record_size(), fingerprint);
+
+    //Keep memory usage at a minimum
+    if(reader.result && !curRecord->IsChanged())
+        curRecord->Unload();
+    }
+
+unsigned char *RecordFingerprinter::GetData()
+    {
+    return writer.record_data();
+    }
+
+uint32_t RecordFingerprinter::GetSize()
+    {
+    return writer.record_size();
+    }
+
+bool RecordFingerprinter::Accept(Record *&curRecord)
+    {
+    Serialize(curRecord);
+    ++count;
+    return stop;
+    }
+
 IdenticalToMasterRetriever::IdenticalToMasterRetriever(ModFile *ModID):
     RecordOp(),
+    Parent(ModID->Parent),
     reader(ModID->FormIDHandler, ModID->Parent->Expanders),
     MasterIndex(ModID->FormIDHandler.ExpandedIndex),
     identical_records(ModID->Parent->identical_records),
@@ -1291,24 +1690,126 @@ bool IdenticalToMasterRetriever::Accept(Record *&curRecord)
     if(master_record == NULL)
         return false;
 
-    RecordReader read_other(master_record->GetParentMod()->FormIDHandler, Expanders);
+    //The comparisons are deferred to Compare so that the records can be fingerprinted in bulk
+    candidates.push_back(std::make_pair(curRecord, master_record));
+    return false;
+    }
+
+void IdenticalToMasterRetriever::Compare()
+    {
+    //Records that share their data with their master compare equal without being read
+    std::vector<Record *> records;
+    boost::unordered_map<Record *, uint32_t> indexes;
+    for(uint32_t x = 0; x < candidates.size(); ++x)
+        {
+        Record *curRecord = candidates[x].first, *master_record = candidates[x].second;
+        if(!curRecord->IsChanged() && !master_record->IsChanged() && curRecord->recData == master_record->recData)
+            continue;
+        if(indexes.insert(std::make_pair(curRecord, (uint32_t)records.size())).second)
+            records.push_back(curRecord);
+        if(indexes.insert(std::make_pair(master_record, (uint32_t)records.size())).second)
+            records.push_back(master_record);
+        }
+
+    std::vector<uint64_t> hashes;
+    Parent->FingerprintRecords(records, hashes);
 
-    if(curRecord->master_equality(master_record, reader, read_other, identical_records))
-        identical_records.insert(curRecord);
+    //Visit in the original order, since deep_equals expects child records to have been compared first
+    for(uint32_t x = 0; x < candidates.size(); ++x)
+        {
+        Record *curRecord = candidates[x].first, *master_record = candidates[x].second;
+        boost::unordered_map<Record *, uint32_t>::iterator self_index = indexes.find(curRecord), master_index = indexes.find(master_record);
+        RecordReader read_other(master_record->GetParentMod()->FormIDHandler, Expanders);
+
+        //Differing fingerprints rule the pair out without reading it, while a match is only
+        // a candidate that the full comparison still has to confirm
+        bool IsIdentical;
+        if(self_index != indexes.end() && master_index != indexes.end() && hashes[self_index->second] != hashes[master_index->second])
+            IsIdentical = false;
+        else
+            IsIdentical = curRecord->master_equality(master_record, reader, read_other, identical_records);
 
-    //Keep memory usage at a minimum
-    if(!curRecord->IsChanged())
-        curRecord->Unload();
-    if(!master_record->IsChanged())
-        master_record->Unload();
+        if(IsIdentical)
+            identical_records.insert(curRecord);
 
-    return false;
+        //Keep memory usage at a minimum
+        if(!curRecord->IsChanged())
+            curRecord->Unload();
+        if(!master_record->IsChanged())
+            master_record->Unload();
+        }
+    candidates.clear();
+    }
+
+LoadTask::LoadTask(Collection *_Parent):
+    Parent(_Parent),
+    monitor(),
+    state(eLoadRunning)
+    {
+    Parent->Monitor = &monitor;
+    worker = std::thread(&LoadTask::Run, this);
+    }
+
+LoadTask::~LoadTask()
+    {
+    monitor.IsCancelled = true;
+    if(worker.joinable())
+        worker.join();
+    Parent->Monitor = NULL;
+    }
+
+void LoadTask::Run()
+    {
+    loadStates result = eLoadFailed;
+    try
+        {
+        result = Parent->Load() == 0 ? eLoadFinished : eLoadCancelled;
+        }
+    catch(std::exception &ex)
+        {
+        PRINT_EXCEPTION(ex);
+        }
+    catch(...)
+        {
+        PRINT_ERROR;
+        }
+    std::lock_guard<std::mutex> lock(state_lock);
+    state = result;
+    state_changed.notify_all();
+    }
+
+loadStates LoadTask::GetState()
+    {
+    std::lock_guard<std::mutex> lock(state_lock);
+    return state;
+    }
+
+loadStates LoadTask::Wait(const uint32_t Timeout)
+    {
+    std::unique_lock<std::mutex> lock(state_lock);
+    if(Timeout == 0)
+        state_changed.wait(lock, [this]{ return state != eLoadRunning; });
+    else
+        state_changed.wait_for(lock, std::chrono::milliseconds(Timeout), [this]{ return state != eLoadRunning; });
+    return state;
+    }
+
+RecordCursor::RecordCursor():
+    position(0)
+    {
+    //
+    }
+
+RecordCursor::~RecordCursor()
+    {
+    //
     }
 
 RecordReader::RecordReader(FormIDHandlerClass &_FormIDHandler, std::vector<FormIDResolver *> &_Expanders):
     RecordOp(),
     expander(_FormIDHandler.ExpandTable, _FormIDHandler.FileStart, _FormIDHandler.FileEnd),
-    Expanders(_Expanders)
+    Expanders(_Expanders),
+    Projection(NULL)
     {
     //
     }
@@ -1316,7 +1817,8 @@ RecordReader::RecordReader(FormIDHandlerClass &_FormIDHandler, std::vector<FormI
 RecordReader::RecordReader(Record *RecordID):
     RecordOp(),
     expander(RecordID->GetParentMod()->FormIDHandler.ExpandTable, RecordID->GetParentMod()->FormIDHandler.FileStart, RecordID->GetParentMod()->FormIDHandler.FileEnd),
-    Expanders(RecordID->GetParentMod()->Parent->Expanders)
+    Expanders(RecordID->GetParentMod()->Parent->Expanders),
+    Projection(NULL)
     {
     //
     }
@@ -1324,7 +1826,8 @@ RecordReader::RecordReader(Record *RecordID):
 RecordReader::RecordReader(ModFile *ModID):
     RecordOp(),
     expander(ModID->FormIDHandler.ExpandTable, ModID->FormIDHandler.FileStart, ModID->FormIDHandler.FileEnd),
-    Expanders(ModID->Parent->Expanders)
+    Expanders(ModID->Parent->Expanders),
+    Projection(NULL)
     {
     //
     }
@@ -1334,9 +1837,34 @@ RecordReader::~RecordReader()
     //
     }
 
+void RecordReader::SetProjection(const SubrecordProjection *_Projection)
+    {
+    //An empty projection reads everything
+    Projection = (_Projection != NULL && !_Projection->empty()) ? _Projection : NULL;
+    }
+
 bool RecordReader::Accept(Record *&curRecord)
     {
-    result = curRecord->Read();
+    Collection *Parent = curRecord->GetParentMod()->Parent;
+    if(Parent->IsConcurrentReads)
+        {
+        //Other threads may be using the record, so it is only ever fully read, and only by one thread at a time.
+        //It is reported as not read so that callers leave it loaded.
+        std::lock_guard<std::mutex> lock(Parent->ReadLock(curRecord));
+        const SubrecordProjection *RequestedProjection = Projection;
+        Projection = NULL;
+        Read(curRecord);
+        Projection = RequestedProjection;
+        result = false;
+        return stop;
+        }
+    Read(curRecord);
+    return stop;
+    }
+
+void RecordReader::Read(Record *&curRecord)
+    {
+    result = curRecord->Read(Projection);
     if(result)
         {
         if(curRecord->IsValid(expander))
@@ -1363,9 +1891,7 @@ bool RecordReader::Accept(Record *&curRecord)
                 uint8_t CollapsedIndex = ModID->FormIDHandler.CollapseTable[ModIndex];
                 char * LongID = CollapsedIndex >= ModID->TES4.MAST.size() ? ModID->ModName : ModID->TES4.MAST[CollapsedIndex];
 
-                char strBuff[120];
-                sprintf(strBuff, "RecordReader: Error - Unable to find the correct expander for record (%s, %06X) in mod %s!\n", LongID, curRecord->formID & 0x00FFFFFF, ModID->ModName);
-                log_error << strBuff;
+                log_error << LogFormat("RecordReader: Error - Unable to find the correct expander for record (%s, %06X) in mod %s!\n", LongID, curRecord->formID & 0x00FFFFFF, ModID->ModName);
                 //expander.result = false;
                 curRecord->VisitFormIDs(expander);
                 //curRecord->HasInvalidFormIDs(expander.result);
@@ -1379,7 +1905,6 @@ bool RecordReader::Accept(Record *&curRecord)
             }
         ++count;
         }
-    return stop;
     }
 
 RecordInvalidFormIDChecker::InvalidFormIDChecker::InvalidFormIDChecker():
@@ -1597,4 +2122,1563 @@ bool RecordChanger::Accept(Record *&curRecord)
     curRecord->IsChanged(true);
 
     return stop;
-    }
\ No newline at end of file
+    }
+
+void *GetFieldValue(Record *curRecord, const FieldSpec &Field, uint32_t &FieldType)
+    {
+    FieldType = curRecord->GetFieldAttribute(Field.FieldID, Field.ListIndex, Field.ListFieldID, Field.ListX2Index, Field.ListX2FieldID, Field.ListX3Index, Field.ListX3FieldID, 0);
+    switch(FieldType)
+        {
+        case FORMID_OR_UINT32_FIELD:
+        case FORMID_OR_FLOAT32_FIELD:
+        case UINT8_OR_UINT32_FIELD:
+        case FORMID_OR_STRING_FIELD:
+        case UNKNOWN_OR_FORMID_OR_UINT32_FIELD:
+        case UNKNOWN_OR_UINT32_FLAG_FIELD:
+        case MGEFCODE_OR_CHAR4_FIELD:
+        case FORMID_OR_MGEFCODE_OR_ACTORVALUE_OR_UINT32_FIELD:
+        case STRING_OR_FLOAT32_OR_SINT32_FIELD:
+            //The record knows which of the types applies
+            FieldType = curRecord->GetFieldAttribute(Field.FieldID, Field.ListIndex, Field.ListFieldID, Field.ListX2Index, Field.ListX2FieldID, Field.ListX3Index, Field.ListX3FieldID, 2);
+            break;
+        default:
+            break;
+        }
+    switch(FieldType)
+        {
+        case UNKNOWN_FIELD:
+        case MISSING_FIELD:
+        case JUNK_FIELD:
+        case LIST_FIELD:
+        case SUBRECORD_FIELD:
+        case SINT8_ARRAY_FIELD:
+        case UINT8_ARRAY_FIELD:
+        case SINT16_ARRAY_FIELD:
+        case UINT16_ARRAY_FIELD:
+        case SINT32_ARRAY_FIELD:
+        case UINT32_ARRAY_FIELD:
+        case FLOAT32_ARRAY_FIELD:
+        case RADIAN_ARRAY_FIELD:
+        case FORMID_ARRAY_FIELD:
+        case FORMID_OR_UINT32_ARRAY_FIELD:
+        case MGEFCODE_OR_UINT32_ARRAY_FIELD:
+        case STRING_ARRAY_FIELD:
+        case ISTRING_ARRAY_FIELD:
+        case SUBRECORD_ARRAY_FIELD:
+        case UNDEFINED_FIELD:
+            //Only fields returned directly by GetField are supported
+            return NULL;
+        default:
+            break;
+        }
+    void *unused = NULL;
+    return curRecord->GetField(Field.FieldID, Field.ListIndex, Field.ListFieldID, Field.ListX2Index, Field.ListX2FieldID, Field.ListX3Index, Field.ListX3FieldID, &unused);
+    }
+
+uint32_t GetFieldValueSize(const uint32_t FieldType)
+    {
+    switch(FieldType)
+        {
+        case BOOL_FIELD:
+        case SINT8_FIELD:
+        case UINT8_FIELD:
+        case CHAR_FIELD:
+        case SINT8_FLAG_FIELD:
+        case SINT8_TYPE_FIELD:
+        case SINT8_FLAG_TYPE_FIELD:
+        case UINT8_FLAG_FIELD:
+        case UINT8_TYPE_FIELD:
+        case UINT8_FLAG_TYPE_FIELD:
+            return 1;
+        case SINT16_FIELD:
+        case UINT16_FIELD:
+        case SINT16_FLAG_FIELD:
+        case SINT16_TYPE_FIELD:
+        case SINT16_FLAG_TYPE_FIELD:
+        case UINT16_FLAG_FIELD:
+        case UINT16_TYPE_FIELD:
+        case UINT16_FLAG_TYPE_FIELD:
+            return 2;
+        case SINT32_FIELD:
+        case UINT32_FIELD:
+        case FLOAT32_FIELD:
+        case RADIAN_FIELD:
+        case FORMID_FIELD:
+        case MGEFCODE_FIELD:
+        case ACTORVALUE_FIELD:
+        case UNKNOWN_OR_SINT32_FIELD:
+        case RESOLVED_MGEFCODE_FIELD:
+        case STATIC_MGEFCODE_FIELD:
+        case RESOLVED_ACTORVALUE_FIELD:
+        case STATIC_ACTORVALUE_FIELD:
+        case CHAR4_FIELD:
+        case SINT32_FLAG_FIELD:
+        case SINT32_TYPE_FIELD:
+        case SINT32_FLAG_TYPE_FIELD:
+        case UINT32_FLAG_FIELD:
+        case UINT32_TYPE_FIELD:
+        case UINT32_FLAG_TYPE_FIELD:
+            return 4;
+        default:
+            //Strings, lists, arrays and unresolved types have no fixed size
+            return 0;
+        }
+    }
+
+FieldColumnRetriever::FieldColumnRetriever(const FieldSpec &_Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t _ValueSize, FORMIDARRAY _FormIDs, void *_Values, UINT8ARRAY _Present, const uint32_t _MaxRecords, const bool _WinningOnly):
+    RecordOp(),
+    Field(_Field),
+    ValueSize(_ValueSize),
+    FormIDs(_FormIDs),
+    Values((UINT8ARRAY)_Values),
+    Present(_Present),
+    MaxRecords(_MaxRecords),
+    WinningOnly(_WinningOnly)
+    {
+    //Pointers into the records have to stay valid, so only copied values can come from a partial read
+    if(ValueSize != 0)
+        for(uint32_t x = 0; x < NumTypes; ++x)
+            projection.insert(SubrecordTypes[x]);
+    }
+
+FieldColumnRetriever::~FieldColumnRetriever()
+    {
+    //
+    }
+
+bool FieldColumnRetriever::Accept(Record *&curRecord)
+    {
+    if(count >= MaxRecords)
+        {
+        stop = true;
+        return stop;
+        }
+
+    if(WinningOnly && !curRecord->GetParentMod()->Parent->IsWinningRecord(curRecord))
+        return stop;
+
+    //Ensure the record is read
+    //Values are copied out before the record is unloaded, so only the projected subrecords are needed
+    RecordReader reader(curRecord);
+    reader.SetProjection(&projection);
+    reader.Accept(curRecord);
+
+    uint32_t FieldType = UNKNOWN_FIELD;
+    void *value = GetFieldValue(curRecord, Field, FieldType);
+
+    //Copied values must be of a fixed size type that fills the column exactly
+    //Fields that do not exist on the record are left to be reported as absent
+    if(ValueSize != 0 && FieldType != UNKNOWN_FIELD && FieldType != MISSING_FIELD && GetFieldValueSize(FieldType) != ValueSize)
+        {
+        if(reader.result && !curRecord->IsChanged())
+            curRecord->Unload();
+        throw std::runtime_error("The field can not be copied into values of the given size.");
+        }
+
+    FormIDs[count] = curRecord->formID;
+    if(ValueSize == 0)
+        ((void **)Values)[count] = value;
+    else if(value != NULL)
+        memcpy(&Values[count * ValueSize], value, ValueSize);
+    else
+        memset(&Values[count * ValueSize], 0x00, ValueSize);
+
+    if(value != NULL)
+        Present[count >> 3] |= (uint8_t)(1 << (count & 7));
+    else
+        Present[count >> 3] &= (uint8_t)~(1 << (count & 7));
+    ++count;
+
+    //If the record was read, but not changed, unload it again
+    //Returned pointers refer to the loaded record, so it has to stay loaded in that case
+    if(reader.result && !curRecord->IsChanged() && ValueSize != 0)
+        curRecord->Unload();
+
+    return stop;
+    }
+
+RecordPredicateFilter::RecordPredicateFilter(const FieldPredicate *_Predicates, const uint32_t _NumPredicates, RECORDIDARRAY _RecordIDs, const uint32_t _MaxRecords):
+    RecordOp(),
+    Predicates(_Predicates),
+    NumPredicates(_NumPredicates),
+    RecordIDs(_RecordIDs),
+    MaxRecords(_MaxRecords)
+    {
+    //A partial read is enough if every predicate says where its field lives
+    for(uint32_t x = 0; x < NumPredicates; ++x)
+        {
+        if(Predicates[x].SubrecordType == 0)
+            {
+            projection.clear();
+            break;
+            }
+        projection.insert(Predicates[x].SubrecordType);
+        }
+    }
+
+RecordPredicateFilter::~RecordPredicateFilter()
+    {
+    //
+    }
+
+bool RecordPredicateFilter::Compare(const FieldPredicate &Predicate, const double &value)
+    {
+    switch(Predicate.Operator)
+        {
+        case eOpEqual:
+            return value == Predicate.Value;
+        case eOpNotEqual:
+            return value != Predicate.Value;
+        case eOpLess:
+            return value < Predicate.Value;
+        case eOpLessEqual:
+            return value <= Predicate.Value;
+        case eOpGreater:
+            return value > Predicate.Value;
+        case eOpGreaterEqual:
+            return value >= Predicate.Value;
+        default:
+            return false;
+        }
+    }
+
+bool RecordPredicateFilter::Evaluate(Record *curRecord, const FieldPredicate &Predicate)
+    {
+    uint32_t FieldType = UNKNOWN_FIELD;
+    void *value = GetFieldValue(curRecord, Predicate.Field, FieldType);
+    //Fields the record doesn't have, or whose union it can't resolve, never match
+    if(FieldType == UNKNOWN_FIELD || FieldType == MISSING_FIELD)
+        return false;
+    if(GetFieldValueSize(FieldType) == 0 && FieldType != STRING_FIELD && FieldType != ISTRING_FIELD)
+        throw std::runtime_error("The field's type can not be compared by a predicate.");
+    if(value == NULL)
+        return false;
+
+    switch(FieldType)
+        {
+        case BOOL_FIELD:
+        case UINT8_FIELD:
+        case UINT8_FLAG_FIELD:
+        case UINT8_TYPE_FIELD:
+        case UINT8_FLAG_TYPE_FIELD:
+            return Compare(Predicate, *(uint8_t *)value);
+        case SINT8_FIELD:
+        case CHAR_FIELD:
+        case SINT8_FLAG_FIELD:
+        case SINT8_TYPE_FIELD:
+        case SINT8_FLAG_TYPE_FIELD:
+            return Compare(Predicate, *(int8_t *)value);
+        case UINT16_FIELD:
+        case UINT16_FLAG_FIELD:
+        case UINT16_TYPE_FIELD:
+        case UINT16_FLAG_TYPE_FIELD:
+            return Compare(Predicate, *(uint16_t *)value);
+        case SINT16_FIELD:
+        case SINT16_FLAG_FIELD:
+        case SINT16_TYPE_FIELD:
+        case SINT16_FLAG_TYPE_FIELD:
+            return Compare(Predicate, *(int16_t *)value);
+        case SINT32_FIELD:
+        case SINT32_FLAG_FIELD:
+        case SINT32_TYPE_FIELD:
+        case SINT32_FLAG_TYPE_FIELD:
+        case UNKNOWN_OR_SINT32_FIELD:
+            return Compare(Predicate, *(int32_t *)value);
+        case FLOAT32_FIELD:
+        case RADIAN_FIELD:
+            return Compare(Predicate, *(float *)value);
+        case STRING_FIELD:
+        case ISTRING_FIELD:
+            if(Predicate.String == NULL)
+                return false;
+            switch(Predicate.Operator)
+                {
+                case eOpEqual:
+                    return (FieldType == ISTRING_FIELD ? icmps((char *)value, Predicate.String) : cmps((char *)value, Predicate.String)) == 0;
+                case eOpNotEqual:
+                    return (FieldType == ISTRING_FIELD ? icmps((char *)value, Predicate.String) : cmps((char *)value, Predicate.String)) != 0;
+                default:
+                    return false;
+                }
+        case CHAR4_FIELD:
+            if(Predicate.String == NULL)
+                return false;
+            switch(Predicate.Operator)
+                {
+                case eOpEqual:
+                    return strncmp((char *)value, Predicate.String, 4) == 0;
+                case eOpNotEqual:
+                    return strncmp((char *)value, Predicate.String, 4) != 0;
+                default:
+                    return false;
+                }
+        case UINT32_FIELD:
+        case FORMID_FIELD:
+        case MGEFCODE_FIELD:
+        case ACTORVALUE_FIELD:
+        case RESOLVED_MGEFCODE_FIELD:
+        case STATIC_MGEFCODE_FIELD:
+        case RESOLVED_ACTORVALUE_FIELD:
+        case STATIC_ACTORVALUE_FIELD:
+        case UINT32_FLAG_FIELD:
+        case UINT32_TYPE_FIELD:
+        case UINT32_FLAG_TYPE_FIELD:
+            return Compare(Predicate, *(uint32_t *)value);
+        default:
+            throw std::runtime_error("The field's type can not be compared by a predicate.");
+        }
+    }
+
+bool RecordPredicateFilter::Accept(Record *&curRecord)
+    {
+    if(count >= MaxRecords)
+        {
+        stop = true;
+        return stop;
+        }
+
+    //Ensure the record is read
+    RecordReader reader(curRecord);
+    reader.SetProjection(&projection);
+    reader.Accept(curRecord);
+
+    //Disjunction of conjunctions: AND binds tighter than OR
+    bool matched = false, clause = true;
+    for(uint32_t x = 0; x < NumPredicates && !matched; ++x)
+        {
+        if(x != 0 && Predicates[x].Join == eJoinOr)
+            {
+            matched = clause;
+            clause = true;
+            }
+        if(clause)
+            clause = Evaluate(curRecord, Predicates[x]);
+        }
+    matched = matched || clause;
+
+    if(matched)
+        RecordIDs[count++] = curRecord;
+
+    //If the record was read, but not changed, unload it again
+    if(reader.result && !curRecord->IsChanged())
+        curRecord->Unload();
+
+    return stop;
+    }
+
+RecordCursorFiller::RecordCursorFiller(RecordCursor &Cursor, const bool _WinningOnly):
+    RecordOp(),
+    records(Cursor.records),
+    WinningOnly(_WinningOnly)
+    {
+    //
+    }
+
+RecordCursorFiller::~RecordCursorFiller()
+    {
+    //
+    }
+
+bool RecordCursorFiller::Accept(Record *&curRecord)
+    {
+    if(WinningOnly && !curRecord->GetParentMod()->Parent->IsWinningRecord(curRecord))
+        return stop;
+    records.push_back(curRecord);
+    ++count;
+    return stop;
+    }
+
+//Plugin strings are Windows-1252, JSON wants UTF-8
+static const uint16_t Windows1252High[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+    };
+
+static uint32_t *FieldIDAtDepth(FieldSpec &Field, const uint32_t depth)
+    {
+    switch(depth)
+        {
+        case 0:
+            return &Field.FieldID;
+        case 1:
+            return &Field.ListFieldID;
+        case 2:
+            return &Field.ListX2FieldID;
+        default:
+            return &Field.ListX3FieldID;
+        }
+    }
+
+static uint32_t *ListIndexAtDepth(FieldSpec &Field, const uint32_t depth)
+    {
+    switch(depth)
+        {
+        case 1:
+            return &Field.ListIndex;
+        case 2:
+            return &Field.ListX2Index;
+        default:
+            return &Field.ListX3Index;
+        }
+    }
+
+static uint32_t GetSpecAttribute(Record *curRecord, const FieldSpec &Field, const uint32_t WhichAttribute)
+    {
+    return curRecord->GetFieldAttribute(Field.FieldID, Field.ListIndex, Field.ListFieldID, Field.ListX2Index, Field.ListX2FieldID, Field.ListX3Index, Field.ListX3FieldID, WhichAttribute);
+    }
+
+static void *GetSpecField(Record *curRecord, const FieldSpec &Field, void **FieldValues)
+    {
+    return curRecord->GetField(Field.FieldID, Field.ListIndex, Field.ListFieldID, Field.ListX2Index, Field.ListX2FieldID, Field.ListX3Index, Field.ListX3FieldID, FieldValues);
+    }
+
+RecordJSONExporter::RecordJSONExporter(char * const FileName, bool (*_LineCallback)(const char *)):
+    RecordOp(),
+    file(NULL),
+    LineCallback(_LineCallback)
+    {
+    formatter.imbue(std::locale::classic());
+    formatter.precision(9);
+    if(FileName != NULL)
+        {
+        file = fopen(FileName, "wb");
+        if(file == NULL)
+            throw std::runtime_error("Unable to open the export file.");
+        }
+    }
+
+RecordJSONExporter::~RecordJSONExporter()
+    {
+    Close();
+    }
+
+bool RecordJSONExporter::Close()
+    {
+    if(file == NULL)
+        return true;
+    bool IsWritten = ferror(file) == 0;
+    if(fclose(file) != 0)
+        IsWritten = false;
+    file = NULL;
+    return IsWritten;
+    }
+
+uint32_t RecordJSONExporter::LastFieldID(Record *curRecord, FieldSpec &Field, const uint32_t depth)
+    {
+    //Field IDs are unique within a record type, and list field IDs within their list
+    uint64_t key = ((uint64_t)curRecord->GetType() << 32) | ((uint64_t)(Field.FieldID & 0x3FF) << 20);
+    if(depth > 1)
+        key |= (Field.ListFieldID & 0x3FF) << 10;
+    if(depth > 2)
+        key |= Field.ListX2FieldID & 0x3FF;
+    boost::unordered_map<uint64_t, uint32_t>::iterator cached = last_field_ids.find(key);
+    if(cached != last_field_ids.end())
+        return cached->second;
+
+    //Field 0 is the record type, so probing starts at 1. There may be gaps.
+    uint32_t *FieldID = FieldIDAtDepth(Field, depth);
+    const uint32_t MaxFieldID = depth == 0 ? 512 : 128;
+    uint32_t last = 0;
+    for(uint32_t x = 1; x <= MaxFieldID; ++x)
+        {
+        *FieldID = x;
+        if(GetSpecAttribute(curRecord, Field, 0) != UNKNOWN_FIELD)
+            last = x;
+        }
+    *FieldID = 0;
+    last_field_ids[key] = last;
+    return last;
+    }
+
+void RecordJSONExporter::WriteString(const char *value, const uint32_t length)
+    {
+    line.push_back('"');
+    for(uint32_t x = 0; x < length && value[x] != 0; ++x)
+        {
+        unsigned char c = (unsigned char)value[x];
+        if(c == '"' || c == '\\')
+            {
+            line.push_back('\\');
+            line.push_back(c);
+            }
+        else if(c < 0x20)
+            {
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", c);
+            line.append(escaped);
+            }
+        else if(c < 0x80)
+            line.push_back(c);
+        else
+            {
+            uint32_t point = c < 0xA0 ? Windows1252High[c - 0x80] : c;
+            if(point < 0x800)
+                {
+                line.push_back((char)(0xC0 | (point >> 6)));
+                line.push_back((char)(0x80 | (point & 0x3F)));
+                }
+            else
+                {
+                line.push_back((char)(0xE0 | (point >> 12)));
+                line.push_back((char)(0x80 | ((point >> 6) & 0x3F)));
+                line.push_back((char)(0x80 | (point & 0x3F)));
+                }
+            }
+        }
+    line.push_back('"');
+    }
+
+void RecordJSONExporter::WriteFormID(Record *curRecord, const FORMID value, const bool IsMGEFCode)
+    {
+    //Long FormIDs are written as [master name, object ID], the same pair GetLongIDName() gives
+    //Resolved MGEF codes keep their mod index in the low byte instead
+    uint8_t ModIndex = IsMGEFCode ? (uint8_t)(value & 0x000000FF) : (uint8_t)(value >> 24);
+    if(value == 0 || ModIndex == 0xFF)
+        {
+        line.append(value == 0 ? "null" : std::to_string(value));
+        return;
+        }
+    ModFile *curModFile = curRecord->GetParentMod();
+    uint8_t CollapsedIndex = curModFile->FormIDHandler.CollapseTable[ModIndex];
+    char *ModName = CollapsedIndex >= curModFile->TES4.MAST.size() ? curModFile->ModName : curModFile->TES4.MAST[CollapsedIndex];
+    line.push_back('[');
+    WriteString(ModName, 0xFFFFFFFF);
+    line.push_back(',');
+    line.append(std::to_string(IsMGEFCode ? value >> 8 : value & 0x00FFFFFF));
+    line.push_back(']');
+    }
+
+void RecordJSONExporter::WriteNumber(const uint32_t FieldType, const void *value)
+    {
+    switch(FieldType)
+        {
+        case BOOL_FIELD:
+        case UINT8_FIELD:
+        case UINT8_FLAG_FIELD:
+        case UINT8_TYPE_FIELD:
+        case UINT8_FLAG_TYPE_FIELD:
+        case UINT8_ARRAY_FIELD:
+            line.append(std::to_string(*(const uint8_t *)value));
+            break;
+        case SINT8_FIELD:
+        case CHAR_FIELD:
+        case SINT8_FLAG_FIELD:
+        case SINT8_TYPE_FIELD:
+        case SINT8_FLAG_TYPE_FIELD:
+        case SINT8_ARRAY_FIELD:
+            line.append(std::to_string(*(const int8_t *)value));
+            break;
+        case UINT16_FIELD:
+        case UINT16_FLAG_FIELD:
+        case UINT16_TYPE_FIELD:
+        case UINT16_FLAG_TYPE_FIELD:
+        case UINT16_ARRAY_FIELD:
+            line.append(std::to_string(*(const uint16_t *)value));
+            break;
+        case SINT16_FIELD:
+        case SINT16_FLAG_FIELD:
+        case SINT16_TYPE_FIELD:
+        case SINT16_FLAG_TYPE_FIELD:
+        case SINT16_ARRAY_FIELD:
+            line.append(std::to_string(*(const int16_t *)value));
+            break;
+        case SINT32_FIELD:
+        case SINT32_FLAG_FIELD:
+        case SINT32_TYPE_FIELD:
+        case SINT32_FLAG_TYPE_FIELD:
+        case SINT32_ARRAY_FIELD:
+        case UNKNOWN_OR_SINT32_FIELD:
+            line.append(std::to_string(*(const int32_t *)value));
+            break;
+        case FLOAT32_FIELD:
+        case RADIAN_FIELD:
+        case FLOAT32_ARRAY_FIELD:
+        case RADIAN_ARRAY_FIELD:
+            {
+            float number = *(const float *)value;
+            //JSON has no representation for NaN or infinity
+            if(number != number || number - number != 0.0f)
+                line.append("null");
+            else
+                {
+                //Formatted as %.9g would be, but without the C locale's decimal separator
+                formatter.str(std::string());
+                formatter << number;
+                line.append(formatter.str());
+                }
+            }
+            break;
+        default:
+            //Flags, codes and the remaining 32-bit fields
+            line.append(std::to_string(*(const uint32_t *)value));
+            break;
+        }
+    }
+
+bool RecordJSONExporter::WriteField(Record *curRecord, FieldSpec &Field, const uint32_t depth)
+    {
+    uint32_t FieldType = GetSpecAttribute(curRecord, Field, 0);
+    switch(FieldType)
+        {
+        case UNKNOWN_FIELD:
+        case MISSING_FIELD:
+        case JUNK_FIELD:
+        case PARENTRECORD_FIELD:
+        case SUBRECORD_FIELD:
+        case SUBRECORD_ARRAY_FIELD:
+        case UNDEFINED_FIELD:
+            //Child records are exported on their own lines
+            return false;
+        case LIST_FIELD:
+            {
+            uint32_t size = GetSpecAttribute(curRecord, Field, 1);
+            if(size == 0 || depth >= 3)
+                return false;
+            uint32_t *ListIndex = ListIndexAtDepth(Field, depth + 1);
+            line.push_back('[');
+            for(uint32_t x = 0; x < size; ++x)
+                {
+                if(x != 0)
+                    line.push_back(',');
+                *ListIndex = x;
+                WriteFields(curRecord, Field, depth + 1);
+                }
+            *ListIndex = 0;
+            line.push_back(']');
+            }
+            return true;
+        case STRING_ARRAY_FIELD:
+        case ISTRING_ARRAY_FIELD:
+            {
+            uint32_t size = GetSpecAttribute(curRecord, Field, 1);
+            if(size == 0)
+                return false;
+            std::vector<void *> values(size, (void *)NULL);
+            GetSpecField(curRecord, Field, &values[0]);
+            line.push_back('[');
+            for(uint32_t x = 0; x < size; ++x)
+                {
+                if(x != 0)
+                    line.push_back(',');
+                if(values[x] != NULL)
+                    WriteString((char *)values[x], 0xFFFFFFFF);
+                else
+                    line.append("null");
+                }
+            line.push_back(']');
+            }
+            return true;
+        case SINT8_ARRAY_FIELD:
+        case UINT8_ARRAY_FIELD:
+        case SINT16_ARRAY_FIELD:
+        case UINT16_ARRAY_FIELD:
+        case SINT32_ARRAY_FIELD:
+        case UINT32_ARRAY_FIELD:
+        case FLOAT32_ARRAY_FIELD:
+        case RADIAN_ARRAY_FIELD:
+        case FORMID_ARRAY_FIELD:
+        case FORMID_OR_UINT32_ARRAY_FIELD:
+        case MGEFCODE_OR_UINT32_ARRAY_FIELD:
+            {
+            uint32_t size = GetSpecAttribute(curRecord, Field, 1);
+            void *values = NULL;
+            if(size != 0)
+                GetSpecField(curRecord, Field, &values);
+            if(values == NULL)
+                return false;
+            uint32_t ElementSize = 4;
+            switch(FieldType)
+                {
+                case SINT8_ARRAY_FIELD:
+                case UINT8_ARRAY_FIELD:
+                    ElementSize = 1;
+                    break;
+                case SINT16_ARRAY_FIELD:
+                case UINT16_ARRAY_FIELD:
+                    ElementSize = 2;
+                    break;
+                default:
+                    break;
+                }
+            //Each element of a variant array says which type it is through the list below the array
+            const bool IsVariant = (FieldType == FORMID_OR_UINT32_ARRAY_FIELD || FieldType == MGEFCODE_OR_UINT32_ARRAY_FIELD) && depth < 3;
+            uint32_t *ElementFieldID = FieldIDAtDepth(Field, depth + 1);
+            uint32_t *ElementIndex = ListIndexAtDepth(Field, depth + 1);
+            line.push_back('[');
+            for(uint32_t x = 0; x < size; ++x)
+                {
+                if(x != 0)
+                    line.push_back(',');
+                const unsigned char *element = (const unsigned char *)values + x * ElementSize;
+                uint32_t ElementType = FieldType;
+                if(IsVariant)
+                    {
+                    *ElementFieldID = 1;
+                    *ElementIndex = x;
+                    ElementType = GetSpecAttribute(curRecord, Field, 2);
+                    }
+                if(ElementType == FORMID_FIELD || ElementType == FORMID_ARRAY_FIELD)
+                    WriteFormID(curRecord, *(const FORMID *)element);
+                else if(ElementType == RESOLVED_MGEFCODE_FIELD)
+                    WriteFormID(curRecord, *(const FORMID *)element, true);
+                else
+                    WriteNumber(FieldType, element);
+                }
+            if(IsVariant)
+                {
+                *ElementFieldID = 0;
+                *ElementIndex = 0;
+                }
+            line.push_back(']');
+            }
+            return true;
+        case FORMID_OR_UINT32_FIELD:
+        case FORMID_OR_FLOAT32_FIELD:
+        case UINT8_OR_UINT32_FIELD:
+        case FORMID_OR_STRING_FIELD:
+        case UNKNOWN_OR_FORMID_OR_UINT32_FIELD:
+        case UNKNOWN_OR_UINT32_FLAG_FIELD:
+        case MGEFCODE_OR_CHAR4_FIELD:
+        case FORMID_OR_MGEFCODE_OR_ACTORVALUE_OR_UINT32_FIELD:
+        case STRING_OR_FLOAT32_OR_SINT32_FIELD:
+            //The record knows which of the types applies
+            FieldType = GetSpecAttribute(curRecord, Field, 2);
+            break;
+        default:
+            break;
+        }
+
+    void *unused = NULL;
+    void *value = GetSpecField(curRecord, Field, &unused);
+    if(value == NULL)
+        return false;
+    switch(FieldType)
+        {
+        case STRING_FIELD:
+        case ISTRING_FIELD:
+            WriteString((const char *)value, 0xFFFFFFFF);
+            break;
+        case CHAR4_FIELD:
+            WriteString((const char *)value, 4);
+            break;
+        case FORMID_FIELD:
+            WriteFormID(curRecord, *(FORMID *)value);
+            break;
+        case RESOLVED_MGEFCODE_FIELD:
+            WriteFormID(curRecord, *(FORMID *)value, true);
+            break;
+        default:
+            WriteNumber(FieldType, value);
+            break;
+        }
+    return true;
+    }
+
+void RecordJSONExporter::WriteFields(Record *curRecord, FieldSpec &Field, const uint32_t depth)
+    {
+    uint32_t last = LastFieldID(curRecord, Field, depth);
+    uint32_t *FieldID = FieldIDAtDepth(Field, depth);
+    bool IsFirst = true;
+    line.push_back('{');
+    for(uint32_t x = 1; x <= last; ++x)
+        {
+        size_t start = line.size();
+        if(!IsFirst)
+            line.push_back(',');
+        line.push_back('"');
+        line.append(std::to_string(x));
+        line.append("\":");
+        *FieldID = x;
+        if(WriteField(curRecord, Field, depth))
+            IsFirst = false;
+        else
+            line.resize(start);
+        }
+    *FieldID = 0;
+    line.push_back('}');
+    }
+
+bool RecordJSONExporter::Accept(Record *&curRecord)
+    {
+    if(stop)
+        return stop;
+
+    //Ensure the record is read
+    RecordReader reader(curRecord);
+    reader.Accept(curRecord);
+
+    line.clear();
+    uint32_t RecordType = curRecord->GetType();
+    line.append("{\"mod\":");
+    WriteString(curRecord->GetParentMod()->ModName, 0xFFFFFFFF);
+    line.append(",\"type\":");
+    WriteString((const char *)&RecordType, 4);
+    line.append(",\"formid\":");
+    WriteFormID(curRecord, curRecord->formID);
+    Record *curParent = curRecord->GetParentRecord();
+    if(curParent != NULL)
+        {
+        line.append(",\"parent\":");
+        WriteFormID(curRecord, curParent->formID);
+        }
+    line.append(",\"fields\":");
+    FieldSpec Field = {0, 0, 0, 0, 0, 0, 0};
+    WriteFields(curRecord, Field, 0);
+    line.push_back('}');
+
+    //If the record was read, but not changed, unload it again
+    if(reader.result && !curRecord->IsChanged())
+        curRecord->Unload();
+
+    if(file != NULL)
+        {
+        line.push_back('\n');
+        fwrite(line.data(), 1, line.size(), file);
+        line.resize(line.size() - 1);
+        }
+    ++count;
+    if(LineCallback != NULL && !LineCallback(line.c_str()))
+        stop = true;
+    return stop;
+    }
+
+bool ModDiffer::DiffEntry::operator <(const DiffEntry &other) const
+    {
+    if(IsKeyedByEditorID != other.IsKeyedByEditorID)
+        return !IsKeyedByEditorID;
+    if(IsKeyedByEditorID)
+        return editorID < other.editorID;
+    return formID < other.formID;
+    }
+
+ModDiffer::ModDiffer(ModFile *_ModID, ModFile *_OtherModID):
+    ModID(_ModID),
+    OtherModID(_OtherModID),
+    IsSameLoadOrder(true)
+    {
+    //Give each mod name an index shared by both mods, so that formIDs from
+    // either mod can be compared directly. Indexes follow the first mod's load order.
+    std::map<std::string, uint8_t> names;
+    ModFile *curModFiles[2] = {ModID, OtherModID};
+    for(uint32_t p = 0; p < 2; ++p)
+        {
+        std::vector<char *> &LoadOrder255 = curModFiles[p]->FormIDHandler.LoadOrder255;
+        memset(&CanonicalTables[p][0], 0xFF, sizeof(CanonicalTables[p]));
+        for(uint32_t x = 0; x < LoadOrder255.size(); ++x)
+            {
+            std::string name(LoadOrder255[x]);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            std::map<std::string, uint8_t>::iterator found = names.find(name);
+            if(found == names.end())
+                {
+                if(names.size() >= 255)
+                    throw std::runtime_error("ModDiffer: The two mods reference more than 255 distinct masters.");
+                found = names.insert(std::make_pair(name, (uint8_t)names.size())).first;
+                }
+            CanonicalTables[p][x] = found->second;
+            }
+        }
+
+    //In-memory formIDs are only directly comparable if both mods resolve them the same way
+    IsSameLoadOrder = memcmp(&CanonicalTables[0][0], &CanonicalTables[1][0], sizeof(CanonicalTables[0])) == 0;
+    }
+
+ModDiffer::~ModDiffer()
+    {
+    //
+    }
+
+void ModDiffer::Collect(ModFile *curModFile, const uint8_t (&CanonicalTable)[256], std::vector<DiffEntry> &Entries)
+    {
+    RecordCursor collected;
+    RecordCursorFiller filler(collected);
+    curModFile->VisitAllRecords(filler);
+
+    Entries.resize(collected.records.size());
+    for(uint32_t x = 0; x < collected.records.size(); ++x)
+        {
+        Record *curRecord = collected.records[x];
+        DiffEntry &entry = Entries[x];
+        entry.record = curRecord;
+        entry.IsKeyedByEditorID = curRecord->IsKeyedByEditorID() && curRecord->GetEditorIDKey() != NULL;
+        entry.formID = (CanonicalTable[curRecord->formID >> 24] << 24) | (curRecord->formID & 0x00FFFFFF);
+        if(entry.IsKeyedByEditorID)
+            {
+            entry.editorID = curRecord->GetEditorIDKey();
+            std::transform(entry.editorID.begin(), entry.editorID.end(), entry.editorID.begin(), ::tolower);
+            }
+        }
+    std::sort(Entries.begin(), Entries.end());
+    }
+
+//Splits serialized subrecords by signature, keeping the bytes of repeated subrecords in order
+static void SplitSubrecords(unsigned char *buffer, unsigned char *end_buffer, std::vector<uint32_t> &Order, std::map<uint32_t, std::string> &Subrecords)
+    {
+    uint32_t subType = 0, subSize = 0;
+    while(buffer < end_buffer)
+        {
+        unsigned char *start_buffer = buffer;
+        subType = *(uint32_t *)buffer;
+        if(subType == REV32(XXXX))
+            {
+            subSize = *(uint32_t *)&buffer[6];
+            subType = *(uint32_t *)&buffer[10];
+            buffer += 16 + subSize;
+            }
+        else
+            buffer += 6 + *(uint16_t *)&buffer[4];
+        if(buffer > end_buffer)
+            buffer = end_buffer;
+        std::map<uint32_t, std::string>::iterator found = Subrecords.find(subType);
+        if(found == Subrecords.end())
+            {
+            Order.push_back(subType);
+            found = Subrecords.insert(std::make_pair(subType, std::string())).first;
+            }
+        found->second.append((const char *)start_buffer, buffer - start_buffer);
+        }
+    }
+
+bool ModDiffer::ChangedSubrecords(Record *curRecord, Record *otherRecord, std::vector<uint32_t> &Changed)
+    {
+    Changed.clear();
+    serializer.Serialize(curRecord, CanonicalTables[0]);
+    other_serializer.Serialize(otherRecord, CanonicalTables[1]);
+
+    bool IsHeaderChanged = memcmp(&serializer.header[0], &other_serializer.header[0], sizeof(serializer.header)) != 0;
+    if(!IsHeaderChanged && serializer.GetSize() == other_serializer.GetSize() &&
+        memcmp(serializer.GetData(), other_serializer.GetData(), serializer.GetSize()) == 0)
+        return false;
+
+    std::vector<uint32_t> order, other_order;
+    std::map<uint32_t, std::string> subrecords, other_subrecords;
+    SplitSubrecords(serializer.GetData(), serializer.GetData() + serializer.GetSize(), order, subrecords);
+    SplitSubrecords(other_serializer.GetData(), other_serializer.GetData() + other_serializer.GetSize(), other_order, other_subrecords);
+
+    for(uint32_t x = 0; x < order.size(); ++x)
+        {
+        std::map<uint32_t, std::string>::iterator found = other_subrecords.find(order[x]);
+        if(found == other_subrecords.end() || found->second != subrecords[order[x]])
+            Changed.push_back(order[x]);
+        }
+    for(uint32_t x = 0; x < other_order.size(); ++x)
+        if(subrecords.find(other_order[x]) == subrecords.end())
+            Changed.push_back(other_order[x]);
+
+    //The bytes differ, but the typed comparison may still consider the records equal
+    // (case insensitive strings, for instance). It can only be trusted if formIDs resolve the same way.
+    if(!IsHeaderChanged && IsSameLoadOrder && curRecord->GetType() == otherRecord->GetType())
+        {
+        RecordReader reader(curRecord), other_reader(otherRecord);
+        reader.Accept(curRecord);
+        other_reader.Accept(otherRecord);
+        bool IsEqual = curRecord->equals(otherRecord);
+        if(reader.result && !curRecord->IsChanged())
+            curRecord->Unload();
+        if(other_reader.result && !otherRecord->IsChanged())
+            otherRecord->Unload();
+        if(IsEqual)
+            {
+            Changed.clear();
+            return false;
+            }
+        }
+    return true;
+    }
+
+int32_t ModDiffer::Diff(DiffCallback _DiffCallback)
+    {
+    std::vector<DiffEntry> entries, other_entries;
+    Collect(ModID, CanonicalTables[0], entries);
+    Collect(OtherModID, CanonicalTables[1], other_entries);
+
+    //Match the records up front so that unchanged pairs can be rejected by fingerprint in bulk
+    std::vector<Record *> matched, other_matched;
+    for(uint32_t x = 0, y = 0; x < entries.size() && y < other_entries.size();)
+        {
+        if(entries[x] < other_entries[y])
+            ++x;
+        else if(other_entries[y] < entries[x])
+            ++y;
+        else
+            {
+            matched.push_back(entries[x++].record);
+            other_matched.push_back(other_entries[y++].record);
+            }
+        }
+
+    std::vector<uint64_t> hashes, other_hashes;
+    ModID->Parent->FingerprintRecords(matched, hashes);
+    OtherModID->Parent->FingerprintRecords(other_matched, other_hashes);
+
+    int32_t differences = 0;
+    uint32_t match = 0;
+    std::vector<uint32_t> changed;
+    for(uint32_t x = 0, y = 0; x < entries.size() || y < other_entries.size();)
+        {
+        Record *curRecord = NULL, *otherRecord = NULL;
+        uint32_t change = eDiffModified;
+        if(y >= other_entries.size() || (x < entries.size() && entries[x] < other_entries[y]))
+            {
+            curRecord = entries[x++].record;
+            change = eDiffRemoved;
+            }
+        else if(x >= entries.size() || other_entries[y] < entries[x])
+            {
+            otherRecord = other_entries[y++].record;
+            change = eDiffAdded;
+            }
+        else
+            {
+            curRecord = entries[x++].record;
+            otherRecord = other_entries[y++].record;
+            bool IsSameFingerprint = hashes[match] == other_hashes[match];
+            ++match;
+            if(IsSameFingerprint || !ChangedSubrecords(curRecord, otherRecord, changed))
+                continue;
+            }
+
+        ++differences;
+        if(_DiffCallback != NULL && !_DiffCallback(change, curRecord, otherRecord,
+                                                   change == eDiffModified && !changed.empty() ? &changed[0] : NULL,
+                                                   change == eDiffModified ? (uint32_t)changed.size() : 0))
+            break;
+        }
+    return differences;
+    }
+
+//Leveled list entries are stored differently by each game, but all have a level, listId, and count
+static LVLLVLO &EntryData(LVLLVLO *Entry)
+    {
+    return *Entry;
+    }
+
+static LVLLVLO &EntryData(FNVLVLO *Entry)
+    {
+    return Entry->LVLO.value;
+    }
+
+static Sk::SKLVLO &EntryData(Sk::SKLVLO *Entry)
+    {
+    return *Entry;
+    }
+
+static Sk::SKLVLO &EntryData(Sk::SKLVLOCOED *Entry)
+    {
+    return Entry->LVLO.value;
+    }
+
+static uint8_t GetListFlags(ReqSimpleSubRecord<uint8_t> &LVLF)
+    {
+    return LVLF.value;
+    }
+
+static uint8_t GetListFlags(SemiOptSimpleSubRecord<uint8_t> &LVLF)
+    {
+    return LVLF.IsLoaded() ? *LVLF.value : 0;
+    }
+
+static void SetListFlags(ReqSimpleSubRecord<uint8_t> &LVLF, const uint8_t Flags)
+    {
+    LVLF.value = Flags;
+    }
+
+static void SetListFlags(SemiOptSimpleSubRecord<uint8_t> &LVLF, const uint8_t Flags)
+    {
+    LVLF.Load();
+    *LVLF.value = Flags;
+    }
+
+template<class T>
+bool compLeveledEntries(T *lhs, T *rhs)
+    {
+    if(EntryData(lhs).level != EntryData(rhs).level)
+        return EntryData(lhs).level < EntryData(rhs).level;
+    if(EntryData(lhs).listId != EntryData(rhs).listId)
+        return EntryData(lhs).listId < EntryData(rhs).listId;
+    return EntryData(lhs).count < EntryData(rhs).count;
+    }
+
+//Collects the entries that reference listId, in list order
+template<class T>
+void EntriesFor(std::vector<T *> &Entries, const FORMID listId, std::vector<T *> &Found)
+    {
+    Found.clear();
+    for(uint32_t x = 0; x < Entries.size(); ++x)
+        if(EntryData(Entries[x]).listId == listId)
+            Found.push_back(Entries[x]);
+    }
+
+template<class T>
+bool SameEntries(std::vector<T *> &lhs, std::vector<T *> &rhs)
+    {
+    if(lhs.size() != rhs.size())
+        return false;
+    for(uint32_t x = 0; x < lhs.size(); ++x)
+        if(*lhs[x] != *rhs[x])
+            return false;
+    return true;
+    }
+
+template<class T>
+T *CloneEntry(T *Entry)
+    {
+    T *Clone = new T;
+    *Clone = *Entry;
+    return Clone;
+    }
+
+//Merges the override chain of a single leveled list (in load order, the original first)
+// and writes the result to the patch mod if it differs from the winning version.
+//Versions tagged Relev take precedence for the levels and counts of entries they change,
+// and for the chance none and flags. Versions tagged Delev remove entries they drop.
+// Every version contributes the entries it adds.
+template<class R, class T>
+bool MergeLeveledList(Collection *Parent, ModFile *PatchModFile, std::vector<Record *> &Versions, std::vector<uint32_t> &VersionTags)
+    {
+    std::vector<T *> merged, found, base_found;
+    boost::unordered_set<FORMID> base_ids, cur_ids, merged_ids;
+    uint8_t chance_none = 0, flags = 0;
+    bool IsWinnerSame = true;
+
+    //The original stays loaded, since every later version is compared against it
+    R *baseList = (R *)Versions[0];
+    RecordReader base_reader(Versions[0]);
+    base_reader.Accept(Versions[0]);
+    bool IsBaseRead = base_reader.result;
+
+    try
+        {
+        for(uint32_t v = 0; v < Versions.size(); ++v)
+            {
+            Record *curRecord = Versions[v];
+            R *curList = (R *)curRecord;
+            RecordReader reader(curRecord);
+            if(v != 0)
+                reader.Accept(curRecord);
+            std::vector<T *> &Entries = curList->Entries.value;
+
+            if(v == 0)
+                {
+                chance_none = curList->LVLD.value;
+                flags = GetListFlags(curList->LVLF);
+                for(uint32_t x = 0; x < Entries.size(); ++x)
+                    {
+                    merged.push_back(CloneEntry(Entries[x]));
+                    base_ids.insert(EntryData(Entries[x]).listId);
+                    }
+                merged_ids = base_ids;
+                }
+            else
+                {
+                std::vector<T *> &BaseEntries = baseList->Entries.value;
+
+                cur_ids.clear();
+                for(uint32_t x = 0; x < Entries.size(); ++x)
+                    cur_ids.insert(EntryData(Entries[x]).listId);
+
+                if(VersionTags[v] & fIsRelev)
+                    {
+                    chance_none = curList->LVLD.value;
+                    flags = GetListFlags(curList->LVLF);
+                    //Entries whose levels or counts were changed replace the merged ones
+                    for(boost::unordered_set<FORMID>::iterator id = cur_ids.begin(); id != cur_ids.end(); ++id)
+                        {
+                        if(base_ids.count(*id) == 0)
+                            continue;
+                        EntriesFor(Entries, *id, found);
+                        EntriesFor(BaseEntries, *id, base_found);
+                        if(SameEntries(found, base_found))
+                            continue;
+                        for(uint32_t x = 0; x < merged.size();)
+                            if(EntryData(merged[x]).listId == *id)
+                                {
+                                delete merged[x];
+                                merged.erase(merged.begin() + x);
+                                }
+                            else
+                                ++x;
+                        for(uint32_t x = 0; x < found.size(); ++x)
+                            merged.push_back(CloneEntry(found[x]));
+                        //An earlier Delev may have dropped it, so the new entries below mustn't add it again
+                        merged_ids.insert(*id);
+                        }
+                    }
+                else
+                    {
+                    if(curList->LVLD.value != baseList->LVLD.value)
+                        chance_none = curList->LVLD.value;
+                    flags |= GetListFlags(curList->LVLF);
+                    }
+
+                if(VersionTags[v] & fIsDelev)
+                    {
+                    for(uint32_t x = 0; x < merged.size();)
+                        {
+                        FORMID listId = EntryData(merged[x]).listId;
+                        if(base_ids.count(listId) != 0 && cur_ids.count(listId) == 0)
+                            {
+                            merged_ids.erase(listId);
+                            delete merged[x];
+                            merged.erase(merged.begin() + x);
+                            }
+                        else
+                            ++x;
+                        }
+                    }
+
+                //New entries are added once, with every level and count the version gives them
+                for(uint32_t x = 0; x < Entries.size(); ++x)
+                    if(merged_ids.count(EntryData(Entries[x]).listId) == 0)
+                        {
+                        EntriesFor(Entries, EntryData(Entries[x]).listId, found);
+                        for(uint32_t y = 0; y < found.size(); ++y)
+                            merged.push_back(CloneEntry(found[y]));
+                        merged_ids.insert(EntryData(Entries[x]).listId);
+                        }
+                }
+
+            std::sort(merged.begin(), merged.end(), compLeveledEntries<T>);
+
+            //Only the winning version matters for deciding whether the patch needs the record
+            if(v == Versions.size() - 1)
+                {
+                std::vector<T *> winning(Entries.begin(), Entries.end());
+                std::sort(winning.begin(), winning.end(), compLeveledEntries<T>);
+                IsWinnerSame = SameEntries(merged, winning) && chance_none == curList->LVLD.value && flags == GetListFlags(curList->LVLF);
+                }
+
+            if(reader.result && !curRecord->IsChanged())
+                curRecord->Unload();
+            }
+
+        if(IsBaseRead && !Versions[0]->IsChanged())
+            Versions[0]->Unload();
+        IsBaseRead = false;
+
+        Record *PatchRecord = NULL;
+        Parent->LookupRecord(PatchModFile, Versions.back()->formID, PatchRecord);
+        if(IsWinnerSame && PatchRecord == NULL)
+            {
+            for(uint32_t x = 0; x < merged.size(); ++x)
+                delete merged[x];
+            return false;
+            }
+
+        //Existing overrides are read from the patch, new copies from the winning mod's data
+        bool IsExisting = PatchRecord != NULL;
+        if(!IsExisting)
+            PatchRecord = Parent->CopyRecord(Versions.back(), PatchModFile, 0, 0, NULL, fSetAsOverride);
+        if(PatchRecord == NULL)
+            throw std::runtime_error("MergeLeveledLists: Unable to copy the leveled list into the patch.");
+        if(IsExisting)
+            {
+            RecordReader reader(PatchRecord);
+            reader.Accept(PatchRecord);
+            }
+        else
+            {
+            RecordReader reader(Versions.back()->GetParentMod()->FormIDHandler, Parent->Expanders);
+            reader.Accept(PatchRecord);
+            }
+
+        R *PatchList = (R *)PatchRecord;
+        PatchList->Entries.Unload();
+        PatchList->Entries.value = merged;
+        merged.clear();
+        PatchList->LVLD.value = chance_none;
+        SetListFlags(PatchList->LVLF, flags);
+
+        FormIDMasterUpdater checker(PatchModFile->FormIDHandler);
+        PatchRecord->VisitFormIDs(checker);
+        PatchRecord->IsChanged(true);
+        return true;
+        }
+    catch(...)
+        {
+        for(uint32_t x = 0; x < merged.size(); ++x)
+            delete merged[x];
+        if(IsBaseRead && !Versions[0]->IsChanged())
+            Versions[0]->Unload();
+        throw;
+        }
+    }
+
+int32_t Collection::MergeLeveledLists(ModFile *PatchModFile, const uint32_t RecordType, boost::unordered_map<ModFile *, uint32_t> &Tags)
+    {
+    typedef bool (*MergeFunction)(Collection *, ModFile *, std::vector<Record *> &, std::vector<uint32_t> &);
+    MergeFunction merge = NULL;
+    switch(CollectionType)
+        {
+        case eIsOblivion:
+            switch(RecordType)
+                {
+                case REV32(LVLC):
+                    merge = &MergeLeveledList<Ob::LVLCRecord, LVLLVLO>;
+                    break;
+                case REV32(LVLI):
+                    merge = &MergeLeveledList<Ob::LVLIRecord, LVLLVLO>;
+                    break;
+                case REV32(LVSP):
+                    merge = &MergeLeveledList<Ob::LVSPRecord, LVLLVLO>;
+                    break;
+                }
+            break;
+        case eIsFalloutNewVegas:
+            switch(RecordType)
+                {
+                case REV32(LVLC):
+                    merge = &MergeLeveledList<FNV::LVLCRecord, FNVLVLO>;
+                    break;
+                case REV32(LVLI):
+                    merge = &MergeLeveledList<FNV::LVLIRecord, FNVLVLO>;
+                    break;
+                case REV32(LVLN):
+                    merge = &MergeLeveledList<FNV::LVLNRecord, FNVLVLO>;
+                    break;
+                }
+            break;
+        case eIsSkyrim:
+            switch(RecordType)
+                {
+                case REV32(LVLI):
+                    merge = &MergeLeveledList<Sk::LVLIRecord, Sk::SKLVLOCOED>;
+                    break;
+                case REV32(LVLN):
+                    merge = &MergeLeveledList<Sk::LVLNRecord, Sk::SKLVLO>;
+                    break;
+                case REV32(LVSP):
+                    merge = &MergeLeveledList<Sk::LVSPRecord, Sk::SKLVLO>;
+                    break;
+                }
+            break;
+        default:
+            break;
+        }
+
+    if(merge == NULL)
+        {
+        log_error << "MergeLeveledLists: Error - Record type is not a leveled list of this game.\n";
+        return -1;
+        }
+
+    //Gather every version of each list, in load order
+    std::map<FORMID, std::vector<Record *> > chains;
+    for(uint32_t p = 0; p < LoadOrder255.size(); ++p)
+        {
+        ModFile *curModFile = LoadOrder255[p];
+        if(curModFile == PatchModFile)
+            continue;
+        RecordCursor collected;
+        RecordCursorFiller filler(collected);
+        curModFile->VisitRecords(RecordType, filler);
+        for(uint32_t x = 0; x < collected.records.size(); ++x)
+            chains[collected.records[x]->formID].push_back(collected.records[x]);
+        }
+
+    int32_t merged = 0;
+    std::vector<uint32_t> tags;
+    for(std::map<FORMID, std::vector<Record *> >::iterator chain = chains.begin(); chain != chains.end(); ++chain)
+        {
+        //Lists that were never overridden have nothing to merge
+        if(chain->second.size() < 2)
+            continue;
+        tags.clear();
+        for(uint32_t x = 0; x < chain->second.size(); ++x)
+            {
+            boost::unordered_map<ModFile *, uint32_t>::iterator tag = Tags.find(chain->second[x]->GetParentMod());
+            tags.push_back(tag != Tags.end() ? tag->second : 0);
+            }
+        if(merge(this, PatchModFile, chain->second, tags))
+            ++merged;
+        }
+    return merged;
+    }
+
+//Decodes the heights of every LAND in a worldspace that lies within Bounds (min x, min y, max x, max y)
+// into one grid, with neighbouring cells sharing their edge vertices.
+//If Heights is NULL, Bounds is instead set to the cells spanned by the worldspace's LANDs.
+//Any mod that overrides the worldspace may add cells, so the cells of every version are used,
+// and each cell and LAND is resolved to its winning override.
+template<class W, class C, class L>
+int32_t ReadWorldHeightmap(Collection *Parent, Record *WorldRecord, int32_t (&Bounds)[4], float *Heights)
+    {
+    //The LAND of each cell, from whichever version of the cell has one
+    std::map<FORMID, FORMID> cellLands;
+    std::vector<Record *> worlds;
+    for(FormID_Range range = Parent->FormID_ModFile_Record.equal_range(WorldRecord->formID); range.first != range.second; ++range.first)
+        if(range.first->second->GetType() == REV32(WRLD))
+            worlds.push_back(range.first->second);
+    if(worlds.empty())
+        worlds.push_back(WorldRecord);
+    for(uint32_t w = 0; w < worlds.size(); ++w)
+        {
+        W *curWorld = (W *)worlds[w];
+        for(uint32_t x = 0; x < curWorld->CELLS.size(); ++x)
+            {
+            C *curCell = (C *)curWorld->CELLS[x];
+            if(curCell->LAND != NULL)
+                cellLands.insert(std::make_pair(curCell->formID, curCell->LAND->formID));
+            }
+        }
+
+    const size_t width = Heights != NULL ? (size_t)((int64_t)Bounds[2] - Bounds[0] + 1) * 32 + 1 : 0;
+    float cellHeights[33][33];
+    int32_t count = 0;
+    ModFile *WinningModFile = NULL;
+    Record *curCellRecord = NULL;
+    Record *curLandRecord = NULL;
+    for(std::map<FORMID, FORMID>::iterator cellLand = cellLands.begin(); cellLand != cellLands.end(); ++cellLand)
+        {
+        Parent->LookupWinningRecord(cellLand->first, WinningModFile, curCellRecord);
+        Parent->LookupWinningRecord(cellLand->second, WinningModFile, curLandRecord);
+        if(curCellRecord == NULL || curLandRecord == NULL || curLandRecord->GetType() != REV32(LAND))
+            continue;
+        C *curCell = (C *)curCellRecord;
+        L *curLand = (L *)curLandRecord;
+
+        //Read through a reader, so that the concurrent read lock is honored
+        RecordReader cellReader(curCellRecord);
+        cellReader.Accept(curCellRecord);
+        bool bCellRead = cellReader.result;
+        bool bHasGrid = curCell->XCLC.IsLoaded();
+        int32_t posX = bHasGrid ? curCell->XCLC->posX : 0;
+        int32_t posY = bHasGrid ? curCell->XCLC->posY : 0;
+        if(bCellRead && !curCell->IsChanged())
+            curCell->Unload();
+        if(!bHasGrid)
+            continue;
+
+        if(Heights == NULL)
+            {
+            if(count == 0 || posX < Bounds[0])
+                Bounds[0] = posX;
+            if(count == 0 || posY < Bounds[1])
+                Bounds[1] = posY;
+            if(count == 0 || posX > Bounds[2])
+                Bounds[2] = posX;
+            if(count == 0 || posY > Bounds[3])
+                Bounds[3] = posY;
+            ++count;
+            continue;
+            }
+
+        if(posX < Bounds[0] || posY < Bounds[1] || posX > Bounds[2] || posY > Bounds[3])
+            continue;
+
+        RecordReader landReader(curLandRecord);
+        landReader.Accept(curLandRecord);
+        bool bLandRead = landReader.result;
+        if(curLand->VHGT.IsLoaded())
+            {
+            curLand->CalcHeights(cellHeights);
+            float *origin = Heights + (size_t)((int64_t)posY - Bounds[1]) * 32 * width + (size_t)((int64_t)posX - Bounds[0]) * 32;
+            for(uint32_t row = 0; row < 33; ++row)
+                memcpy(origin + row * width, cellHeights[row], sizeof(cellHeights[row]));
+            ++count;
+            }
+        if(bLandRead && !curLand->IsChanged())
+            curLand->Unload();
+        }
+    return count;
+    }
+
+int32_t Collection::GetWorldHeightmap(Record *WorldRecord, int32_t (&Bounds)[4], float *Heights)
+    {
+    if(WorldRecord->GetType() != REV32(WRLD))
+        {
+        log_error << "GetWorldHeightmap: Error - Record (" << WorldRecord->GetStrType() << ") is not a worldspace.\n";
+        return -1;
+        }
+
+    switch(CollectionType)
+        {
+        case eIsOblivion:
+            return ReadWorldHeightmap<Ob::WRLDRecord, Ob::CELLRecord, Ob::LANDRecord>(this, WorldRecord, Bounds, Heights);
+        case eIsFalloutNewVegas:
+            return ReadWorldHeightmap<FNV::WRLDRecord, FNV::CELLRecord, FNV::LANDRecord>(this, WorldRecord, Bounds, Heights);
+        case eIsSkyrim:
+            return ReadWorldHeightmap<Sk::WRLDRecord, Sk::CELLRecord, Sk::LANDRecord>(this, WorldRecord, Bounds, Heights);
+        default:
+            return -1;
+        }
+    }
+
+//Returns a worldspace's LAND grid, first rebuilding it from the worldspace's cells if an edit left it stale.
+//Positions are taken the same way as while loading, so a cell without an XCLC is at (0, 0).
+template<class W, class C>
+LandGrid * WorldLandGrid(Record *WorldRecord)
+    {
+    W *curWorld = (W *)WorldRecord;
+    if(!curWorld->LANDs.IsStale())
+        return &curWorld->LANDs;
+
+    curWorld->LANDs.clear();
+    for(uint32_t x = 0; x < curWorld->CELLS.size(); ++x)
+        {
+        C *curCell = (C *)curWorld->CELLS[x];
+        if(curCell->LAND == NULL)
+            continue;
+
+        Record *curCellRecord = curCell;
+        RecordReader reader(curCellRecord);
+        reader.Accept(curCellRecord);
+        if(curCell->XCLC.IsLoaded())
+            curWorld->LANDs.Insert(curCell->XCLC->posX, curCell->XCLC->posY, curCell->LAND);
+        else
+            curWorld->LANDs.Insert(0, 0, curCell->LAND);
+        if(reader.result && !curCell->IsChanged())
+            curCell->Unload();
+        }
+    return &curWorld->LANDs;
+    }
+
+LandGrid * Collection::GetLandGrid(Record *WorldRecord)
+    {
+    if(WorldRecord->GetType() != REV32(WRLD))
+        {
+        log_error << "GetLandGrid: Error - Record (" << WorldRecord->GetStrType() << ") is not a worldspace.\n";
+        return NULL;
+        }
+
+    switch(CollectionType)
+        {
+        case eIsOblivion:
+            return WorldLandGrid<Ob::WRLDRecord, Ob::CELLRecord>(WorldRecord);
+        case eIsFalloutNewVegas:
+            return WorldLandGrid<FNV::WRLDRecord, FNV::CELLRecord>(WorldRecord);
+        case eIsSkyrim:
+            return WorldLandGrid<Sk::WRLDRecord, Sk::CELLRecord>(WorldRecord);
+        default:
+            return NULL;
+        }
+    }
+
+//Called after a CELL or LAND is created, copied or edited, since it may have moved a LAND within its worldspace.
+//Only grids that were built while loading are kept up to date.
+void Collection::InvalidateLandGrid(Record *curRecord)
+    {
+    if(curRecord != NULL && curRecord->GetType() == REV32(LAND))
+        curRecord = curRecord->GetParentRecord();
+    if(curRecord == NULL || curRecord->GetType() != REV32(CELL))
+        return;
+
+    Record *WorldRecord = curRecord->GetParentRecord();
+    if(WorldRecord == NULL || WorldRecord->GetType() != REV32(WRLD) || !WorldRecord->GetParentMod()->Flags.IsIndexLANDs)
+        return;
+
+    switch(CollectionType)
+        {
+        case eIsOblivion:
+            ((Ob::WRLDRecord *)WorldRecord)->LANDs.Invalidate();
+            break;
+        case eIsFalloutNewVegas:
+            ((FNV::WRLDRecord *)WorldRecord)->LANDs.Invalidate();
+            break;
+        case eIsSkyrim:
+            ((Sk::WRLDRecord *)WorldRecord)->LANDs.Invalidate();
+            break;
+        default:
+            break;
+        }
+    }
@@ -41,6 +41,11 @@
 #include "Skyrim/TES5File.h"
 #include <vector>
 #include <map>
+#include <boost/unordered_map.hpp>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <sstream>
 #include "Visitors.h"
 
 //class SortedRecords
@@ -72,7 +77,9 @@ struct Collection
     private:
         char * ModsDir;
         bool IsLoaded;
-        std::vector<Record *> sortedConflicts;
+        std::mutex read_locks[NUMREADLOCKS];
+
+        friend struct Snapshot;
 
     public:
         whichGameTypes CollectionType;
@@ -91,13 +98,26 @@ struct Collection
         FormID_Map ExtendedFormID_ModFile_Record;
 
         boost::unordered_set<Record *> identical_records;
+        ModFile *conflict_mod; //The mod the conflict matrix was built for, if any
+        std::vector<Record *> conflict_rows;
+        std::vector<uint32_t> conflict_offsets;
+        std::vector<Record *> conflict_records;
         boost::unordered_set<Record *> changed_records;
         std::vector<GenericOp *> closing_ops;
 
+        //Cached fingerprints of unchanged records, keyed alongside the record data they were computed from
+        boost::unordered_map<Record *, std::pair<unsigned char *, uint64_t> > fingerprints;
+
         boost::unordered_set<uint32_t> filter_records;
         boost::unordered_set<FORMID> filter_wspaces;
         bool filter_inclusive;
 
+        //While set, records are only read under a lock, and never unloaded
+        bool IsConcurrentReads;
+
+        //Set while a LoadTask owns the collection
+        LoadMonitor *Monitor;
+
         Collection(char * const &ModsPath, uint32_t _CollectionType);
         ~Collection();
 
@@ -114,7 +134,7 @@ struct Collection
             return MappedModFiles[name];
         }
 
-        // Callback(position, maximum, modfile-name);
+        // Callback(position, maximum, modfile-name); returning false cancels the load
         int32_t Load(bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *) = NULL);
         void   UndeleteRecords(std::vector<std::pair<ModFile *, std::vector<Record *> > > &DeletedRecords);
         int32_t Unload();
@@ -124,9 +144,19 @@ struct Collection
         FormID_Iterator LookupWinningRecord(const FORMID &RecordFormID, ModFile *&WinningModFile, Record *&WinningRecord, const bool GetExtendedConflicts=false);
         EditorID_Iterator LookupWinningRecord(char * const &RecordEditorID, ModFile *&WinningModFile, Record *&WinningRecord, const bool GetExtendedConflicts=false);
 
+        bool IsWinningRecord(Record *curRecord, const bool GetExtendedConflicts=false);
         uint32_t GetNumRecordConflicts(Record *&curRecord, const bool GetExtendedConflicts);
         int32_t GetRecordConflicts(Record *&curRecord, RECORDIDARRAY RecordIDs, const bool GetExtendedConflicts);
         int32_t GetRecordHistory(Record *&curRecord, RECORDIDARRAY RecordIDs);
+        uint32_t BuildConflictMatrix(ModFile *curModFile, const uint32_t RecordType, const bool GetExtendedConflicts);
+        void SetConcurrentReads(const bool Enable);
+        std::mutex &ReadLock(Record *curRecord);
+
+        void FingerprintRecords(std::vector<Record *> &Records, std::vector<uint64_t> &Fingerprints);
+        int32_t MergeLeveledLists(ModFile *PatchModFile, const uint32_t RecordType, boost::unordered_map<ModFile *, uint32_t> &Tags);
+        int32_t GetWorldHeightmap(Record *WorldRecord, int32_t (&Bounds)[4], float *Heights);
+        LandGrid * GetLandGrid(Record *WorldRecord);
+        void InvalidateLandGrid(Record *curRecord);
 
         uint32_t NextFreeExpandedFormID(ModFile *&curModFile, uint32_t depth = 0);
         Record * CreateRecord(ModFile *&curModFile, const uint32_t &RecordType, FORMID RecordFormID, char * const &RecordEditorID, const FORMID &ParentFormID, uint32_t CreateFlags);
@@ -136,11 +166,45 @@ struct Collection
         int32_t SetIDFields(Record *&RecordID, FORMID FormID, char * const &EditorID);
     };
 
+//Loads a collection on its own thread
+struct LoadTask
+    {
+    private:
+        std::thread worker;
+        std::mutex state_lock;
+        std::condition_variable state_changed;
+
+        void Run();
+
+    public:
+        Collection *Parent;
+        LoadMonitor monitor;
+        loadStates state;
+
+        LoadTask(Collection *_Parent);
+        ~LoadTask();
+
+        loadStates GetState();
+        loadStates Wait(const uint32_t Timeout);
+    };
+
+struct RecordCursor
+    {
+    std::vector<Record *> records;
+    uint32_t position;
+
+    RecordCursor();
+    ~RecordCursor();
+    };
+
 class RecordReader : public RecordOp
     {
     private:
         FormIDResolver expander;
         std::vector<FormIDResolver *> &Expanders;
+        const SubrecordProjection *Projection;
+
+        void Read(Record *&curRecord);
 
     public:
         RecordReader(FormIDHandlerClass &_FormIDHandler, std::vector<FormIDResolver *> &_Expanders);
@@ -148,6 +212,7 @@ class RecordReader : public RecordOp
         RecordReader(ModFile *ModID);
         ~RecordReader();
 
+        void SetProjection(const SubrecordProjection *_Projection);
         bool Accept(Record *&curRecord);
     };
 
@@ -186,22 +251,44 @@ class RecordDeindexer : public RecordOp
         bool Accept(Record *&curRecord);
     };
 
+class RecordFingerprinter : public RecordOp
+    {
+    private:
+        FileWriter writer;
+        FormIDNormalizer normalizer;
+
+    public:
+        uint64_t fingerprint;
+        uint32_t header[3];
+
+        RecordFingerprinter();
+        ~RecordFingerprinter();
+
+        void Serialize(Record *curRecord, const uint8_t *CanonicalTable=NULL);
+        unsigned char *GetData();
+        uint32_t GetSize();
+
+        bool Accept(Record *&curRecord);
+    };
+
 class IdenticalToMasterRetriever : public RecordOp
     {
     private:
-        EditorID_Map &EditorID_ModFile_Record;
-        FormID_Map &FormID_ModFile_Record;
+        Collection *Parent;
+        RecordReader reader;
         const uint8_t &MasterIndex;
         boost::unordered_set<Record *> &identical_records;
+        EditorID_Map &EditorID_ModFile_Record;
+        FormID_Map &FormID_ModFile_Record;
         std::vector<FormIDResolver *> &Expanders;
-
-        RecordReader reader;
+        std::vector<std::pair<Record *, Record *> > candidates;
 
     public:
         IdenticalToMasterRetriever(ModFile *ModID);
         ~IdenticalToMasterRetriever();
 
         bool Accept(Record *&curRecord);
+        void Compare();
     };
 
 class RecordFormIDSwapper : public RecordOp
@@ -279,4 +366,116 @@ class RecordChanger : public RecordOp
         ~RecordChanger();
 
         bool Accept(Record *&curRecord);
-    };
\ No newline at end of file
+    };
+
+void *GetFieldValue(Record *curRecord, const FieldSpec &Field, uint32_t &FieldType);
+uint32_t GetFieldValueSize(const uint32_t FieldType);
+
+class FieldColumnRetriever : public RecordOp
+    {
+    private:
+        const FieldSpec &Field;
+        const uint32_t ValueSize;
+        FORMIDARRAY FormIDs;
+        UINT8ARRAY Values;
+        UINT8ARRAY Present;
+        const uint32_t MaxRecords;
+        const bool WinningOnly;
+        SubrecordProjection projection;
+
+    public:
+        FieldColumnRetriever(const FieldSpec &_Field, const uint32_t *SubrecordTypes, const uint32_t NumTypes, const uint32_t _ValueSize, FORMIDARRAY _FormIDs, void *_Values, UINT8ARRAY _Present, const uint32_t _MaxRecords, const bool _WinningOnly=false);
+        ~FieldColumnRetriever();
+
+        bool Accept(Record *&curRecord);
+    };
+
+class RecordPredicateFilter : public RecordOp
+    {
+    private:
+        const FieldPredicate *Predicates;
+        const uint32_t NumPredicates;
+        RECORDIDARRAY RecordIDs;
+        const uint32_t MaxRecords;
+        SubrecordProjection projection;
+
+        bool Compare(const FieldPredicate &Predicate, const double &value);
+        bool Evaluate(Record *curRecord, const FieldPredicate &Predicate);
+
+    public:
+        RecordPredicateFilter(const FieldPredicate *_Predicates, const uint32_t _NumPredicates, RECORDIDARRAY _RecordIDs, const uint32_t _MaxRecords);
+        ~RecordPredicateFilter();
+
+        bool Accept(Record *&curRecord);
+    };
+
+class RecordCursorFiller : public RecordOp
+    {
+    private:
+        std::vector<Record *> &records;
+        const bool WinningOnly;
+
+    public:
+        RecordCursorFiller(RecordCursor &Cursor, const bool _WinningOnly=false);
+        ~RecordCursorFiller();
+
+        bool Accept(Record *&curRecord);
+    };
+
+//Writes each record as a line of JSON, reading it only for as long as it takes
+class RecordJSONExporter : public RecordOp
+    {
+    private:
+        FILE *file;
+        bool (*LineCallback)(const char *);
+        std::string line;
+        std::ostringstream formatter; //Imbued with the classic locale, since JSON always uses a '.'
+        //The highest field ID of each record type and list, found once by probing
+        boost::unordered_map<uint64_t, uint32_t> last_field_ids;
+
+        uint32_t LastFieldID(Record *curRecord, FieldSpec &Field, const uint32_t depth);
+        void WriteString(const char *value, const uint32_t length);
+        void WriteFormID(Record *curRecord, const FORMID value, const bool IsMGEFCode=false);
+        void WriteNumber(const uint32_t FieldType, const void *value);
+        bool WriteField(Record *curRecord, FieldSpec &Field, const uint32_t depth);
+        void WriteFields(Record *curRecord, FieldSpec &Field, const uint32_t depth);
+
+    public:
+        RecordJSONExporter(char * const FileName, bool (*_LineCallback)(const char *));
+        ~RecordJSONExporter();
+
+        bool Accept(Record *&curRecord);
+        bool Close();
+    };
+
+typedef bool (*DiffCallback)(const uint32_t, Record *, Record *, const uint32_t *, const uint32_t);
+
+class ModDiffer
+    {
+    private:
+        struct DiffEntry
+            {
+            bool IsKeyedByEditorID;
+            uint32_t formID;
+            std::string editorID;
+            Record *record;
+
+            bool operator <(const DiffEntry &other) const;
+            };
+
+        ModFile *ModID;
+        ModFile *OtherModID;
+        uint8_t CanonicalTables[2][256];
+        bool IsSameLoadOrder;
+        RecordFingerprinter serializer;
+        RecordFingerprinter other_serializer;
+
+        void Collect(ModFile *curModFile, const uint8_t (&CanonicalTable)[256], std::vector<DiffEntry> &Entries);
+        bool ChangedSubrecords(Record *curRecord, Record *otherRecord, std::vector<uint32_t> &Changed);
+
+    public:
+        ModDiffer(ModFile *_ModID, ModFile *_OtherModID);
+        ~ModDiffer();
+
+        int32_t Diff(DiffCallback _DiffCallback);
+    };
@@ -36,8 +36,39 @@
 // Common.cpp
 #include "Common.h"
 #include "zlib.h"
+#include <mutex>
+#include <string>
+#include <stdlib.h>
+#include <stdarg.h>
 
-int (*printer)(const char * _Format, ...) = &printf;
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define vsnprintf _vsnprintf
+#endif
+
+//Output goes to the thread's LogCapture if one is active, and otherwise to the LoggingCallback or stdout
+int message_printer(const char * _Format, ...)
+    {
+    int nSize = 0;
+    va_list args;
+    va_start(args, _Format);
+    LogCapture *capture = LogCapture::Current();
+    if(capture == NULL && LoggingCallback == NULL)
+        nSize = vprintf(_Format, args);
+    else
+        {
+        char buff[1024];
+        nSize = vsnprintf(buff, sizeof(buff), _Format, args);
+        buff[sizeof(buff) - 1] = 0;
+        if(capture != NULL)
+            capture->messages.push_back(std::make_pair(-1, std::string(buff)));
+        else
+            LoggingCallback(buff);
+        }
+    va_end(args);
+    return nSize;
+    }
+
+int (*printer)(const char * _Format, ...) = &message_printer;
 int32_t (*LoggingCallback)(const char *) = NULL;
 void (*RaiseCallback)(const char *) = NULL;
 
@@ -53,14 +84,6 @@ void (*RaiseCallback)(const char *) = NULL;
     unsigned long debug_temp4 = 0;
 #endif
 
-#ifdef CBASH_CALLTIMING
-    std::map<char *, double> CallTime;
-#endif
-
-#ifdef CBASH_CALLCOUNT
-    std::map<char *, unsigned long> CallCount;
-#endif
-
 const char * Ex_NULL::__CLR_OR_THIS_CALL what() const NOEXCEPT
     {
     return "NULL Pointer";
@@ -108,6 +131,101 @@ int cmps(const char * lhs, const char * rhs)
     return strcmp(lhs, rhs);
     }
 
+uint64_t HashBytes(const void * data, uint32_t length, uint64_t hash)
+    {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for(uint32_t x = 0; x < length; ++x)
+        {
+        hash ^= bytes[x];
+        hash *= 0x100000001B3ULL;
+        }
+    return hash;
+    }
+
+uint64_t HashName(const char * name, uint64_t hash)
+    {
+    if(name == NULL)
+        return hash;
+    for(; *name != 0; ++name)
+        {
+        hash ^= (unsigned char)tolower((unsigned char)*name);
+        hash *= 0x100000001B3ULL;
+        }
+    //Terminate so that consecutive names can't run together
+    hash ^= 0xFF;
+    hash *= 0x100000001B3ULL;
+    return hash;
+    }
+
+struct SharedMapping
+    {
+    boost::iostreams::mapped_file_source file_map;
+    uint32_t users;
+    };
+
+static std::mutex SharedMappingsLock;
+static std::map<std::string, SharedMapping> SharedMappings;
+
+boost::iostreams::mapped_file_source AcquireMapping(const char * FileName)
+    {
+    //Key on the full path, so that collections with different mod directories still share,
+    //and on the modification time and size, so that a file replaced on disk is mapped afresh
+    std::string key;
+    #ifdef _WIN32
+        char full_path[_MAX_PATH];
+        if(_fullpath(full_path, FileName, _MAX_PATH) != NULL)
+            key = full_path;
+        else
+            key = FileName;
+        for(std::string::iterator it = key.begin(); it != key.end(); ++it)
+            *it = (char)tolower((unsigned char)*it);
+    #else
+        char *full_path = realpath(FileName, NULL);
+        if(full_path != NULL)
+            {
+            key = full_path;
+            free(full_path);
+            }
+        else
+            key = FileName;
+    #endif
+    struct stat buf;
+    if(stat(FileName, &buf) == 0)
+        key += "|" + std::to_string((long long)buf.st_mtime) + "|" + std::to_string((long long)buf.st_size);
+
+    std::lock_guard<std::mutex> lock(SharedMappingsLock);
+    std::map<std::string, SharedMapping>::iterator it = SharedMappings.find(key);
+    if(it == SharedMappings.end())
+        {
+        SharedMapping mapping;
+        mapping.file_map.open(FileName);
+        mapping.users = 0;
+        it = SharedMappings.insert(std::make_pair(key, mapping)).first;
+        }
+    ++it->second.users;
+    return it->second.file_map;
+    }
+
+void ReleaseMapping(boost::iostreams::mapped_file_source &file_map)
+    {
+    if(!file_map.is_open())
+        return;
+    const char *data = file_map.data();
+    //Only drop this user's handle. Closing it would unmap the file for every user.
+    file_map = boost::iostreams::mapped_file_source();
+
+    std::lock_guard<std::mutex> lock(SharedMappingsLock);
+    for(std::map<std::string, SharedMapping>::iterator it = SharedMappings.begin(); it != SharedMappings.end(); ++it)
+        {
+        if(it->second.file_map.data() == data)
+            {
+            if(--it->second.users == 0)
+                SharedMappings.erase(it);
+            return;
+            }
+        }
+    }
+
 bool sameStr::operator()( const char * s1, const char * s2 ) const
     {
     return icmps(s1, s2) < 0;
@@ -227,9 +345,11 @@ char * GetTemporaryFileName(char * FileName, bool IsBackup)
     }
 
 RenameOp::RenameOp(char * _original_name, char * _destination_name):
+    GenericOp(),
     original_name(_original_name),
     destination_name(_destination_name),
-    GenericOp()
+    backup_name(NULL),
+    IsPerformed(false)
     {
     //
     }
@@ -237,6 +357,23 @@ RenameOp::RenameOp(char * _original_name, char * _destination_name):
 RenameOp::~RenameOp()
     {
     delete []original_name;
+    delete []backup_name;
+    }
+
+//Puts back any file that perform() backed up, and removes the new file
+void RenameOp::rollback()
+    {
+    if(IsPerformed && rename(destination_name, original_name) != 0)
+        printer("RenameOp: Error - Unable to move \"%s\" back to \"%s\".\n", destination_name, original_name);
+    IsPerformed = false;
+    if(backup_name != NULL)
+        {
+        if(rename(backup_name, destination_name) != 0)
+            printer("RenameOp: Error - Unable to restore \"%s\" from \"%s\".\n", destination_name, backup_name);
+        delete []backup_name;
+        backup_name = NULL;
+        }
+    remove(original_name);
     }
 
 bool RenameOp::perform()
@@ -258,7 +395,7 @@ bool RenameOp::perform()
     if(FileExists(destination_name))
         {
         stat(destination_name, &o_time);
-        char * backup_name = GetTemporaryFileName(destination_name, true);
+        backup_name = GetTemporaryFileName(destination_name, true);
 
         switch(rename(destination_name, backup_name))
             {
@@ -281,13 +418,19 @@ bool RenameOp::perform()
                 printer("RenameOp: Error - Unable to rename existing file from \"%s\" to \"%s\". Unknown details.\n", destination_name, backup_name);
                 break;
             }
-        delete []backup_name;
+        //Kept only if the backup was made, so that rollback() can restore it
+        if(FileExists(destination_name))
+            {
+            delete []backup_name;
+            backup_name = NULL;
+            }
         }
 
     //Replace any existing file with the new file
     switch(rename(original_name, destination_name))
         {
         case 0:
+            IsPerformed = true;
             return true;
         case EACCES:
             printer("RenameOp: Warning - Unable to rename temporary file from \"%s\" to \"%s\". File or directory specified by newname already exists or could not be created (invalid path); or oldname is a directory and newname specifies a different path.\n", original_name, destination_name);
@@ -338,7 +481,10 @@ FileWriter::FileWriter(char * filename, uint32_t size):
     record_buffer_size(size),
     compressed_buffer_size(size),
     fh(-1),
-    FileName(filename)
+    FileName(filename),
+    localized_strings(false),
+    string_tables(NULL),
+    missing_strings(0)
     {
     if(size == 0)
         return;
@@ -501,6 +647,11 @@ uint32_t FileWriter::record_size()
     return record_buffer_used;
     }
 
+unsigned char * FileWriter::record_data()
+    {
+    return record_buffer;
+    }
+
 void FileWriter::record_flush()
     {
     file_write(record_buffer, record_buffer_used);
@@ -508,6 +659,12 @@ void FileWriter::record_flush()
     return;
     }
 
+void FileWriter::record_clear()
+    {
+    record_buffer_used = 0;
+    return;
+    }
+
 uint32_t FileWriter::file_tell()
     {
 #ifdef _WIN32
@@ -822,6 +979,7 @@ ModFlags::ModFlags():
     IsFixupPlaceables(false),
     IsCreateNew(false),
     IsIgnoreInactiveMasters(false),
+    IsFingerprintRecords(false),
     LoadedGRUPs(false)
     {
     //
@@ -843,6 +1001,7 @@ ModFlags::ModFlags(uint32_t _Flags):
     IsFixupPlaceables((_Flags & fIsFixupPlaceables) != 0),
     IsCreateNew((_Flags & fIsCreateNew) != 0),
     IsIgnoreInactiveMasters((_Flags & fIsIgnoreInactiveMasters) != 0),
+    IsFingerprintRecords((_Flags & fIsFingerprintRecords) != 0),
     LoadedGRUPs(false)
     {
     //
@@ -895,19 +1054,23 @@ uint32_t ModFlags::GetFlags()
         flags &= ~fIsAddMasters;
         flags |= fIsIgnoreInactiveMasters;
         }
+    if(IsFingerprintRecords)
+        flags |= fIsFingerprintRecords;
     return flags;
     }
 
 SaveFlags::SaveFlags():
     IsCleanMasters(true),
-    IsCloseCollection(false)
+    IsCloseCollection(false),
+    IsWriteStrings(false)
     {
     //
     }
 
 SaveFlags::SaveFlags(uint32_t _Flags):
     IsCleanMasters((_Flags & fIsCleanMasters) != 0),
-    IsCloseCollection((_Flags & fIsCloseCollection) != 0)
+    IsCloseCollection((_Flags & fIsCloseCollection) != 0),
+    IsWriteStrings((_Flags & fIsWriteStrings) != 0)
     {
     //
     }
@@ -3328,4 +3491,4 @@ const float flt_1 = 1.0f;
 const float flt_0 = 0.0f;
 const float flt_n2147483648 = -2147483648.0f;
 
-Logger logger = Logger::getInstance();
\ No newline at end of file
+Logger logger;
\ No newline at end of file
@@ -63,10 +63,10 @@
 #include "Types.h"
 #include "Logger.h"
 
-#define log_info (*logger.getLogger(0))
-#define log_warning (*logger.getLogger(1))<<"WARNING: "
-#define log_debug (*logger.getLogger(2))<<"DEBUG: "
-#define log_error (*logger.getLogger(3))<<"ERROR: "
+#define log_info LOG_AT(eLogInfo, "")
+#define log_warning LOG_AT(eLogWarning, "WARNING: ")
+#define log_debug LOG_AT(eLogDebug, "DEBUG: ")
+#define log_error LOG_AT(eLogError, "ERROR: ")
 
 extern int (*printer)(const char * _Format, ...);
 extern int32_t (*LoggingCallback)(const char *);
@@ -194,9 +194,25 @@ class Ex_INVALIDMODINDEX : public std::exception
 int icmps(const char * lhs, const char * rhs);
 int cmps(const char * lhs, const char * rhs);
 
+//64-bit FNV-1a, used to fingerprint record data
+#ifndef FINGERPRINT_SEED
+    #define FINGERPRINT_SEED 0xCBF29CE484222325ULL
+#endif
+uint64_t HashBytes(const void * data, uint32_t length, uint64_t hash=FINGERPRINT_SEED);
+//Case insensitive, to match how mod names are compared
+uint64_t HashName(const char * name, uint64_t hash=FINGERPRINT_SEED);
+
+//Read only file mappings are shared by every collection in the process.
+//A file is mapped once per path and modification time, and unmapped when its last user releases it.
+//Only the bytes are shared. The records parsed from them belong to each collection, since loading
+// rewrites their formIDs for its load order. Changes are only ever made to the parsed copies.
+boost::iostreams::mapped_file_source AcquireMapping(const char * FileName);
+void ReleaseMapping(boost::iostreams::mapped_file_source &file_map);
+
 struct ModFile;
 struct Record;
 class StringRecord;
+class StringTableWriter;
 
 struct sameStr
     {
@@ -245,14 +261,6 @@ extern const float flt_1;
 extern const float flt_3;
 extern const float flt_n2147483648;
 
-extern Logger logger;
-
-#ifdef CBASH_CALLTIMING
-    extern std::map<char *, double> CallTime;
-#endif
-#ifdef CBASH_CALLCOUNT
-    extern std::map<char *, unsigned long> CallCount;
-#endif
 
 #ifdef CBASH_DEBUG_CHUNK
     void peek_around(unsigned char *position, uint32_t length);
@@ -272,12 +280,15 @@ class RenameOp : public GenericOp
     private:
         char * original_name;
         char * destination_name;
+        char * backup_name;
+        bool IsPerformed;
 
     public:
         RenameOp(char * _original_name, char * _destination_name);
         ~RenameOp();
 
         bool perform();
+        void rollback();
     };
 
 char * DeGhostModName(char * const ModName);
@@ -295,6 +306,13 @@ class FileWriter
         char * FileName;
 
     public:
+        //Set while saving a localized plugin, whose localized strings are written as ids
+        bool localized_strings;
+        //Set if the plugin's string files are being written. Localized strings are added to them.
+        StringTableWriter *string_tables;
+        //Localized strings that couldn't be written, because they have no id or only an id
+        uint32_t missing_strings;
+
         FileWriter(char * filename, uint32_t size);
         ~FileWriter();
 
@@ -306,7 +324,9 @@ class FileWriter
         void   record_write_subrecord(uint32_t signature, const void *source, uint32_t length);
         uint32_t record_compress();
         uint32_t record_size();
+        unsigned char * record_data();
         void   record_flush();
+        void   record_clear();
 
         uint32_t file_tell();
         void   file_write(const void *source_buffer, uint32_t source_buffer_used);
@@ -518,6 +538,7 @@ class ModFlags
         bool IsFixupPlaceables;
         bool IsCreateNew;
         bool IsIgnoreInactiveMasters;
+        bool IsFingerprintRecords;
 
         //For internal use, may not be set by constructor
         bool LoadedGRUPs;
@@ -534,6 +555,7 @@ class SaveFlags
 
         bool IsCleanMasters;
         bool IsCloseCollection;
+        bool IsWriteStrings;
     };
 
 class StringRecord
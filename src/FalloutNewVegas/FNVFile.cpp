@@ -225,12 +225,16 @@ int32_t FNVFile::Load(RecordOp &read_parser, RecordOp &indexer, std::vector<Form
     processor.SetFilter(filter_inclusive, filter_records, filter_wspaces);
 
     while(buffer_position < buffer_end){
+        if(!ContinueLoad())
+            break;
+        PROFILE_SCOPE("GRUP scan");
         buffer_position += 4; //Skip "GRUP"
         GRUPSize = *(uint32_t *)buffer_position;
         group_buffer_end = buffer_position + GRUPSize - 4;
         buffer_position += 4;
         GRUPLabel = *(uint32_t *)buffer_position;
         buffer_position += 8; //Skip type (tops will all == 0)
+        TRACE_SPAN("GRUP", ModName, GRUPLabel);
 
         //printer("%c%c%c%c\n", ((char *)&GRUPLabel)[0], ((char *)&GRUPLabel)[1], ((char *)&GRUPLabel)[2], ((char *)&GRUPLabel)[3]);
         switch(GRUPLabel)
@@ -1598,6 +1602,9 @@ int32_t FNVFile::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
                 CELL.navm_pool.destroy(cell_record->NAVM[ListIndex]);
                 }
 
+            //Keep the worldspace's grid index from pointing at the deleted LAND
+            if(cell_record->LAND != NULL && cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+                ((FNV::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(cell_record->LAND);
             deindexer.Accept(cell_record->LAND);
             WRLD.land_pool.destroy(cell_record->LAND);
 
@@ -1938,6 +1945,8 @@ int32_t FNVFile::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
                 }
 
             cell_record->LAND = NULL;
+            if(cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+                ((FNV::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(curRecord);
             deindexer.Accept(curRecord);
             WRLD.land_pool.destroy(curRecord);
             }
@@ -2149,7 +2158,7 @@ int32_t FNVFile::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
     return 0;
     }
 
-int32_t FNVFile::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer)
+int32_t FNVFile::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer, StringTableWriter *Strings)
     {
     if(!Flags.IsSaveable)
         {
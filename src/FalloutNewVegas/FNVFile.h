@@ -256,7 +256,7 @@ class FNVFile : public ModFile
         char *   GetMasterName(uint8_t &CollapsedIndex);
         Record * CreateRecord(const uint32_t &RecordType, char * const &RecordEditorID, Record *&SourceRecord, Record *&ParentRecord, CreationFlags &options);
         int32_t   DeleteRecord(Record *&curRecord, RecordOp &deindexer);
-        int32_t   Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer);
+        int32_t   Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer, StringTableWriter *Strings);
 
         void     SetFilter(bool inclusive, boost::unordered_set<uint32_t> &RecordTypes, boost::unordered_set<FORMID> &WorldSpaces);
 
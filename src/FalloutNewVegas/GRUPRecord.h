@@ -244,6 +244,7 @@ class FNVGRUPRecords<FNV::DIALRecord, RecType, AllocUnit, IsKeyedByEditorID>
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             dial_pool.MakeRecordsVector(Records);
             uint32_t numDIALRecords = (uint32_t)Records.size(); //Parent Records
@@ -746,6 +747,7 @@ class FNVGRUPRecords<FNV::CELLRecord, RecType, AllocUnit, IsKeyedByEditorID>
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             cell_pool.MakeRecordsVector(Records);
             uint32_t numCELLRecords = (uint32_t)Records.size();
@@ -1117,7 +1119,6 @@ class FNVGRUPRecords<FNV::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
             FNV::CELLRecord *last_cell_record = NULL, *orphaned_cell_records = NULL;
             uint32_t numWRLD = 0, numCELL = 0, numACHR = 0, numACRE = 0, numREFR = 0, numPGRE = 0, numPMIS = 0, numPBEA = 0, numPFLA = 0, numPCBE = 0, numNAVM = 0, numLAND = 0;
 
-            std::map<int32_t, std::map<int32_t, FNV::LANDRecord *> > GridXY_LAND;
             std::vector<std::pair<uint32_t, unsigned char *> > GRUPs;
             std::pair<uint32_t, unsigned char *> GRUP_End;
             GRUP_End.first = eTop;
@@ -1429,7 +1430,7 @@ class FNVGRUPRecords<FNV::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 read_parser.Accept((Record *&)last_cell_record); //may already be loaded, but just to be sure.
                                 //CELL will be unloaded if needed after a second round of indexing when all records are loaded
                                 last_cell_record->XCLC.Load(); //in-case no XCLC chunk is specified
-                                GridXY_LAND[last_cell_record->XCLC->posX][last_cell_record->XCLC->posY] = (FNV::LANDRecord *)curRecord;
+                                last_wrld_record->LANDs.Insert(last_cell_record->XCLC->posX, last_cell_record->XCLC->posY, curRecord);
                                 }
                             break;
                         case REV32(ACHR):
@@ -1729,10 +1730,10 @@ class FNVGRUPRecords<FNV::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 last_land_record = (FNV::LANDRecord *)last_cell_record->LAND;
                                 if(last_land_record != NULL)
                                     {
-                                    last_land_record->NorthLand = GridXY_LAND[posX][posY + 1];
-                                    last_land_record->SouthLand = GridXY_LAND[posX][posY - 1];
-                                    last_land_record->EastLand = GridXY_LAND[posX + 1][posY];
-                                    last_land_record->WestLand = GridXY_LAND[posX - 1][posY];
+                                    last_land_record->NorthLand = (FNV::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY + 1);
+                                    last_land_record->SouthLand = (FNV::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY - 1);
+                                    last_land_record->EastLand = (FNV::LANDRecord *)last_wrld_record->LANDs.Find(posX + 1, posY);
+                                    last_land_record->WestLand = (FNV::LANDRecord *)last_wrld_record->LANDs.Find(posX - 1, posY);
                                     }
                                 }
 
@@ -1849,6 +1850,7 @@ class FNVGRUPRecords<FNV::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
         template<typename U>
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod, FormIDHandlerClass &FormIDHandler, U &CELL, RecordOp &indexer)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             wrld_pool.MakeRecordsVector(Records);
             uint32_t numWrldRecords = (uint32_t)Records.size();
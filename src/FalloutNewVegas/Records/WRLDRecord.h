@@ -36,6 +36,7 @@
 #pragma once
 #include "../../Common.h"
 #include "../../GenericRecord.h"
+#include "../../LandGrid.h"
 
 namespace FNV
 {
@@ -92,6 +93,7 @@ class WRLDRecord : public FNVRecord //Worldspace
         //Record *ROAD;
         Record *CELL;
         std::vector<Record *> CELLS;
+        LandGrid LANDs; //Filled while loading with fIsIndexLANDs, and rebuilt by Collection::GetLandGrid once stale
 
         WRLDRecord(unsigned char *_recData=NULL);
         WRLDRecord(WRLDRecord *srcRecord);
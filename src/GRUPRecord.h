@@ -150,6 +150,7 @@ class GRUPRecords
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             pool.MakeRecordsVector(Records);
             uint32_t numRecords = (uint32_t)Records.size();
@@ -304,6 +305,7 @@ class FNVGRUPRecords
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             pool.MakeRecordsVector(Records);
             uint32_t numRecords = (uint32_t)Records.size();
@@ -461,6 +463,7 @@ class TES5GRUPRecords
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
         {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             pool.MakeRecordsVector(Records);
             uint32_t numRecords = (uint32_t)Records.size();
@@ -126,7 +126,7 @@ bool Record::SetParent(void *_Parent, bool IsMod)
     if(Parent != NULL)
         return false;
 
-    SETBIT(CBash_Flags, _fIsParentMod, IsMod);
+    SetCBashFlag(_fIsParentMod, IsMod);
     Parent = _Parent;
     return true;
     }
@@ -160,7 +160,7 @@ bool Record::IsWinningDetermined() const
 
 void Record::IsWinningDetermined(bool value)
     {
-    SETBIT(CBash_Flags, _fIsWinningDetermined, value);
+    SetCBashFlag(_fIsWinningDetermined, value);
     }
 
 bool Record::IsWinning() const
@@ -171,7 +171,7 @@ bool Record::IsWinning() const
 void Record::IsWinning(bool value)
     {
     IsWinningDetermined(true);
-    SETBIT(CBash_Flags, _fIsWinning, value);
+    SetCBashFlag(_fIsWinning, value);
     }
 
 bool Record::IsExtendedWinning() const
@@ -182,7 +182,7 @@ bool Record::IsExtendedWinning() const
 void Record::IsExtendedWinning(bool value)
     {
     IsWinningDetermined(true);
-    SETBIT(CBash_Flags, _fIsExtendedWinning, value);
+    SetCBashFlag(_fIsExtendedWinning, value);
     }
 
 //bool Record::HasInvalidFormIDs() const
@@ -237,37 +237,100 @@ bool Record::VisitFormIDs(FormIDOp &op)
     }
 
 
-bool Record::ReadRecord(int32_t sizeDistance)
+//Compacts the subrecords in [buffer, end_buffer) that are in the projection into dest_buffer, and returns the new end
+//EDID is always kept since records may be keyed by it
+unsigned char *ProjectSubrecords(unsigned char *buffer, unsigned char *end_buffer, unsigned char *dest_buffer, const SubrecordProjection &Projection)
+{
+	uint32_t subType = 0;
+	uint32_t subSize = 0;
+	while (buffer < end_buffer)
+	{
+		unsigned char *start_buffer = buffer;
+		subType = *(uint32_t *)buffer;
+		if (subType == REV32(XXXX))
+		{
+			subSize = *(uint32_t *)&buffer[6];
+			subType = *(uint32_t *)&buffer[10];
+			buffer += 16 + subSize;
+		}
+		else
+			buffer += 6 + *(uint16_t *)&buffer[4];
+
+		if (subType == REV32(EDID) || Projection.find(subType) != Projection.end())
+		{
+			memmove(dest_buffer, start_buffer, buffer - start_buffer);
+			dest_buffer += buffer - start_buffer;
+		}
+	}
+	return dest_buffer;
+}
+
+bool Record::ReadRecord(int32_t sizeDistance, const SubrecordProjection *Projection)
 {
 	if (IsLoaded() || IsChanged())
 		return false;
+	//A partial read is discarded before the record is read again
+	if (IsPartiallyLoaded())
+		Unload();
 	uint32_t recSize = *(uint32_t*)&recData[-sizeDistance];
 
+	unsigned char localBuffer[BUFFERSIZE];
+	unsigned char *buffer = NULL;
+	unsigned char *end_buffer = NULL;
 	//Check against the original record flags to see if it is compressed since the current flags may have changed
-	if ((*(uint32_t*)&recData[-sizeDistance + 4] & fIsCompressed) != 0)
+	bool CompressedOnDisk = (*(uint32_t*)&recData[-sizeDistance + 4] & fIsCompressed) != 0;
+	if (CompressedOnDisk)
 	{
-		unsigned char localBuffer[BUFFERSIZE];
 		uLongf expandedRecSize = *(uint32_t*)recData;
-		unsigned char *buffer = (expandedRecSize >= BUFFERSIZE) ? new unsigned char[expandedRecSize] : &localBuffer[0];
-		uncompress(buffer, (uLongf*)&expandedRecSize, &recData[4], recSize - 4);
-		ParseRecord(buffer, buffer + expandedRecSize, true);
-		if (buffer != &localBuffer[0])
-			delete[] buffer;
+		buffer = (expandedRecSize >= BUFFERSIZE) ? new unsigned char[expandedRecSize] : &localBuffer[0];
+		{
+			PROFILE_SCOPE("inflate");
+			uncompress(buffer, (uLongf*)&expandedRecSize, &recData[4], recSize - 4);
+			if (IsTracing)
+				LocalTraceCounters().inflated += expandedRecSize;
+		}
+		end_buffer = buffer + expandedRecSize;
+		//The inflated buffer is scratch space, so it can be compacted in place
+		if (Projection != NULL)
+			end_buffer = ProjectSubrecords(buffer, end_buffer, buffer, *Projection);
+	}
+	else if (Projection != NULL)
+	{
+		buffer = (recSize >= BUFFERSIZE) ? new unsigned char[recSize] : &localBuffer[0];
+		end_buffer = ProjectSubrecords(recData, recData + recSize, buffer, *Projection);
+		//Values can't point into a scratch buffer, so parse it as if it were compressed
+		CompressedOnDisk = true;
 	}
 	else
-		ParseRecord(recData, recData + recSize);
+	{
+		buffer = recData;
+		end_buffer = recData + recSize;
+	}
+
+	{
+		PROFILE_SCOPE("ParseRecord");
+		ParseRecord(buffer, end_buffer, CompressedOnDisk);
+	}
+	if (buffer != &localBuffer[0] && buffer != recData)
+		delete[] buffer;
 
-	IsLoaded(true);
+	if (Projection != NULL)
+		SetCBashFlag(_fIsPartiallyLoaded, true);
+	else
+		IsLoaded(true);
 	return true;
 }
 
-bool Record::Read()
+bool Record::Read(const SubrecordProjection *Projection)
 {
-		return ReadRecord(16);
+		return ReadRecord(16, Projection);
 }
 
 uint32_t Record::Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders)
     {
+    PROFILE_SCOPE("write");
+    if(IsTracing)
+        ++LocalTraceCounters().records;
     uint32_t recSize = 0;
     uint32_t recType = GetType();
     collapser.Accept(formID);
@@ -301,7 +364,7 @@ uint32_t Record::Write(FileWriter &writer, const bool &bMastersChanged, FormIDRe
                         }
                 if(index == -1)
                     {
-                    printer("Unable to find the correct expander!\n");
+                    log_error << LogFormat("Write: Error - Unable to find the correct expander for record (%s, %08X)!\n", GetStrType(), formID);
                     VisitFormIDs(expander);
                     }
                 else
@@ -588,6 +651,14 @@ void Record::SetHeaderUnknownFlagMask(uint32_t Mask)
     flagsUnk = Mask;
     }
 
+void Record::SetCBashFlag(const uint32_t Mask, const bool value)
+    {
+    if(value)
+        CBash_Flags |= Mask;
+    else
+        CBash_Flags &= ~Mask;
+    }
+
 bool Record::IsLoaded() const
     {
     return (CBash_Flags & _fIsLoaded) != 0;
@@ -595,7 +666,14 @@ bool Record::IsLoaded() const
 
 void Record::IsLoaded(bool value)
     {
-    SETBIT(CBash_Flags, _fIsLoaded, value);
+    SetCBashFlag(_fIsLoaded, value);
+    //Both loading and unloading supersede a partial read
+    SetCBashFlag(_fIsPartiallyLoaded, false);
+    }
+
+bool Record::IsPartiallyLoaded() const
+    {
+    return (CBash_Flags & _fIsPartiallyLoaded) != 0;
     }
 
 bool Record::IsChanged()
@@ -605,7 +683,7 @@ bool Record::IsChanged()
 
 void Record::IsChanged(bool value)
     {
-    SETBIT(CBash_Flags, _fIsChanged, value);
+    SetCBashFlag(_fIsChanged, value);
     }
 
 FNVRecord::FNVRecord(unsigned char *_recData):
@@ -620,9 +698,9 @@ FNVRecord::~FNVRecord()
     //
     }
 
-bool FNVRecord::Read()
+bool FNVRecord::Read(const SubrecordProjection *Projection)
 {
-	return ReadRecord(20);
+	return ReadRecord(20, Projection);
 }
 
 uint32_t FNVRecord::Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders)
@@ -662,7 +740,7 @@ uint32_t FNVRecord::Write(FileWriter &writer, const bool &bMastersChanged, FormI
                         }
                 if(index == -1)
                     {
-                    printer("Unable to find the correct expander!\n");
+                    log_error << LogFormat("Write: Error - Unable to find the correct expander for record (%s, %08X)!\n", GetStrType(), formID);
                     VisitFormIDs(expander);
                     }
                 else
@@ -753,9 +831,9 @@ TES5Record::~TES5Record()
     //
     }
 
-bool TES5Record::Read()
+bool TES5Record::Read(const SubrecordProjection *Projection)
 {
-		return ReadRecord(20);
+		return ReadRecord(20, Projection);
 }
 
 uint32_t TES5Record::Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders)
@@ -795,7 +873,7 @@ uint32_t TES5Record::Write(FileWriter &writer, const bool &bMastersChanged, Form
                         }
                 if(index == -1)
                     {
-                    printer("Unable to find the correct expander!\n");
+                    log_error << LogFormat("Write: Error - Unable to find the correct expander for record (%s, %08X)!\n", GetStrType(), formID);
                     VisitFormIDs(expander);
                     }
                 else
@@ -37,10 +37,14 @@
 // BaseRecord.h
 #include "Common.h"
 #include "GenericChunks.h"
+#include <atomic>
 
 struct Record;
 struct ModFile;
 
+//Set of subrecord types to decode when a record is only partially read
+typedef boost::unordered_set<uint32_t> SubrecordProjection;
+
 class RecordOp
     {
     protected:
@@ -210,12 +214,16 @@ struct Record
             _fIsWinning           = 0x00000010,
             _fIsExtendedWinning   = 0x00000020,
             //_fHasInvalidFormIDs = 0x00000040
+            _fIsPartiallyLoaded   = 0x00000080
             };
         void *Parent;
 
+        void SetCBashFlag(const uint32_t Mask, const bool value);
+
     public:
         unsigned char *recData;
-        uint32_t CBash_Flags;
+        //Atomic, since readers may check whether a record is loaded while another thread reads it under its lock
+        std::atomic<uint32_t> CBash_Flags;
 
         uint32_t flags;
         FORMID formID;
@@ -259,7 +267,7 @@ struct Record
 
         virtual bool VisitFormIDs(FormIDOp &op);
 
-        virtual bool   Read();
+        virtual bool   Read(const SubrecordProjection *Projection=NULL);
         virtual uint32_t Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders);
         bool           IsValid(FormIDResolver &expander);
 
@@ -268,7 +276,7 @@ struct Record
         virtual bool equals(Record *other) = 0;
         virtual bool deep_equals(Record *master, RecordOp &read_self, RecordOp &read_master, boost::unordered_set<Record *> &identical_records);
 
-		bool ReadRecord(int32_t sizeDistance);
+		bool ReadRecord(int32_t sizeDistance, const SubrecordProjection *Projection=NULL);
         bool IsDeleted() const;
         void IsDeleted(bool value);
         bool IsBorderRegion();
@@ -311,6 +319,7 @@ struct Record
 
         bool IsLoaded() const;
         void IsLoaded(bool value);
+        bool IsPartiallyLoaded() const;
 
         bool IsChanged();
         void IsChanged(bool value);
@@ -362,7 +371,7 @@ class FNVRecord : public Record
         FNVRecord(unsigned char *_recData=NULL);
         virtual ~FNVRecord();
 
-        bool Read();
+        bool Read(const SubrecordProjection *Projection=NULL);
         uint32_t Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders);
     };
 
@@ -413,6 +422,6 @@ class TES5Record : public Record
         TES5Record(TES5Record *srcRecord);
         virtual ~TES5Record();
 
-        bool Read();
+        bool Read(const SubrecordProjection *Projection=NULL);
         uint32_t Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders);
     };
@@ -0,0 +1,181 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// LandGrid.cpp
+#include "LandGrid.h"
+#include <algorithm>
+
+LandGrid::LandGrid():
+    count(0),
+    stale(false)
+    {
+    //
+    }
+
+LandGrid::~LandGrid()
+    {
+    //
+    }
+
+uint32_t LandGrid::Slot(const int32_t posX, const int32_t posY) const
+    {
+    uint32_t hash = (uint32_t)posX * 0x9E3779B1u ^ (uint32_t)posY * 0x85EBCA77u;
+    hash ^= hash >> 15;
+    return hash & (uint32_t)(entries.size() - 1);
+    }
+
+void LandGrid::Grow()
+    {
+    std::vector<Entry> old_entries;
+    old_entries.swap(entries);
+    Entry empty = {0, 0, NULL};
+    entries.assign(old_entries.empty() ? 64 : old_entries.size() * 2, empty);
+    count = 0;
+    for(uint32_t x = 0; x < old_entries.size(); ++x)
+        if(old_entries[x].land != NULL)
+            Insert(old_entries[x].posX, old_entries[x].posY, old_entries[x].land);
+    }
+
+uint32_t LandGrid::size() const
+    {
+    return count;
+    }
+
+void LandGrid::clear()
+    {
+    entries.clear();
+    count = 0;
+    stale = false;
+    }
+
+bool LandGrid::IsStale() const
+    {
+    return stale;
+    }
+
+void LandGrid::Invalidate()
+    {
+    stale = true;
+    }
+
+void LandGrid::Insert(const int32_t posX, const int32_t posY, Record *land)
+    {
+    //Kept at most half full so probes stay short
+    if((count + 1) * 2 > entries.size())
+        Grow();
+
+    const uint32_t mask = (uint32_t)(entries.size() - 1);
+    uint32_t slot = Slot(posX, posY);
+    while(entries[slot].land != NULL && (entries[slot].posX != posX || entries[slot].posY != posY))
+        slot = (slot + 1) & mask;
+    if(entries[slot].land == NULL)
+        ++count;
+    entries[slot].posX = posX;
+    entries[slot].posY = posY;
+    entries[slot].land = land;
+    }
+
+void LandGrid::Erase(Record *land)
+    {
+    if(land == NULL)
+        return;
+
+    //The LAND's cell may no longer be loaded, so its position is found by scanning
+    uint32_t slot = 0;
+    while(slot < entries.size() && entries[slot].land != land)
+        ++slot;
+    if(slot == entries.size())
+        return;
+
+    //Pull later entries of the same probe run back into the gap
+    const uint32_t mask = (uint32_t)(entries.size() - 1);
+    for(uint32_t next = (slot + 1) & mask; entries[next].land != NULL; next = (next + 1) & mask)
+        {
+        uint32_t home = Slot(entries[next].posX, entries[next].posY);
+        if(((next - home) & mask) >= ((next - slot) & mask))
+            {
+            entries[slot] = entries[next];
+            slot = next;
+            }
+        }
+    entries[slot].land = NULL;
+    --count;
+    }
+
+Record * LandGrid::Find(const int32_t posX, const int32_t posY) const
+    {
+    if(count == 0)
+        return NULL;
+
+    const uint32_t mask = (uint32_t)(entries.size() - 1);
+    for(uint32_t slot = Slot(posX, posY); entries[slot].land != NULL; slot = (slot + 1) & mask)
+        if(entries[slot].posX == posX && entries[slot].posY == posY)
+            return entries[slot].land;
+    return NULL;
+    }
+
+void LandGrid::Find(const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, std::vector<Record *> &lands) const
+    {
+    if(count == 0 || MaxX < MinX || MaxY < MinY)
+        return;
+
+    //Small areas are probed cell by cell, large ones by scanning every entry
+    //Either way, the LANDs are returned from south to north, then west to east
+    //Sides can each span 2^32 cells, so the area is compared without forming it
+    const uint64_t width = (uint64_t)((int64_t)MaxX - MinX) + 1;
+    const uint64_t height = (uint64_t)((int64_t)MaxY - MinY) + 1;
+    if(width <= entries.size() && height <= entries.size() / width)
+        {
+        for(int64_t posY = MinY; posY <= MaxY; ++posY)
+            for(int64_t posX = MinX; posX <= MaxX; ++posX)
+                {
+                Record *land = Find((int32_t)posX, (int32_t)posY);
+                if(land != NULL)
+                    lands.push_back(land);
+                }
+        return;
+        }
+
+    std::vector<std::pair<std::pair<int32_t, int32_t>, Record *> > found;
+    for(uint32_t x = 0; x < entries.size(); ++x)
+        {
+        const Entry &entry = entries[x];
+        if(entry.land != NULL && entry.posX >= MinX && entry.posX <= MaxX && entry.posY >= MinY && entry.posY <= MaxY)
+            found.push_back(std::make_pair(std::make_pair(entry.posY, entry.posX), entry.land));
+        }
+    std::sort(found.begin(), found.end());
+    for(uint32_t x = 0; x < found.size(); ++x)
+        lands.push_back(found[x].second);
+    }
@@ -0,0 +1,77 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#pragma once
+// LandGrid.h
+#include "Common.h"
+#include <vector>
+
+//Indexes a worldspace's LAND records by the grid position of their cell.
+//Open addressed with linear probing, so lookups never allocate, and
+// positions without a LAND are never stored.
+//Edits that may move a LAND only mark the grid as stale, and the owner
+// rebuilds it before its next use.
+class LandGrid
+    {
+    private:
+        struct Entry
+            {
+            int32_t posX, posY;
+            Record *land; //NULL if the slot is empty
+            };
+
+        std::vector<Entry> entries;
+        uint32_t count;
+        bool stale;
+
+        uint32_t Slot(const int32_t posX, const int32_t posY) const;
+        void Grow();
+
+    public:
+        LandGrid();
+        ~LandGrid();
+
+        uint32_t size() const;
+        void clear();
+
+        bool IsStale() const;
+        void Invalidate();
+
+        void Insert(const int32_t posX, const int32_t posY, Record *land);
+        void Erase(Record *land);
+
+        Record * Find(const int32_t posX, const int32_t posY) const;
+        void Find(const int32_t MinX, const int32_t MinY, const int32_t MaxX, const int32_t MaxY, std::vector<Record *> &lands) const;
+    };
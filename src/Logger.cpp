@@ -1,63 +1,571 @@
-#include "Logger.h"
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// Logger.cpp
+#include "Common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 #include <ctime>
+#include <chrono>
 
-Logger::~Logger() {
-	if (logFile.is_open())
-		logFile.close();
-}
-
-Logger& Logger::getInstance() {
-	static Logger instance = Logger();
-	return instance;
-}
-
-void Logger::init(int argc, char * argv[]) {
-	if (logFile.is_open())
-		return;
-
-	if (argc < 4)
-		return;
-
-	std::string logFileName = argv[3];
-	logFileName += "Logs_";
-	std::time_t t = time(0);
-	struct tm* now = localtime(&t);
-	char buffer[20];
-	strftime(buffer, 20, "%d.%m.%y_%H.%M.%S", now);
-	logFileName += buffer;
-	logFileName += ".txt";
-	logFile.open(logFileName, std::ios::out | std::ios::trunc);
-	if (!logFile) {
-		std::cout << "Couldn't open log file\n";
-		return;
-	}
-
-	if (argc > 4)
-		logLevel = atoi(argv[4]);
-
-	logFile << "Arguments: " << argv[1] << " " << argv[2] << " " << argv[3] << " " << logLevel << std::endl << std::endl;
-
-	Log info;
-	info.logFile = &logFile;
-	info.isHigherLevel = (logLevel <= 0);
-	loggers.push_back(info);
-
-	Log warning;
-	warning.logFile = &logFile;
-	warning.isHigherLevel = (logLevel <= 1);
-	loggers.push_back(warning);
-
-	Log debug;
-	debug.logFile = &logFile;
-	debug.isHigherLevel = (logLevel <= 2);
-	loggers.push_back(debug);
-
-	Log error;
-	error.logFile = &logFile;
-	error.isHigherLevel = (logLevel <= 3);
-	loggers.push_back(error);
-}
-
-Log* Logger::getLogger(int level) {
-	return &loggers[level];
-}
\ No newline at end of file
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define vsnprintf _vsnprintf
+#endif
+
+#define LOG_POLL_MS    50
+#define LOG_IDLE_POLLS 20 //The flusher exits after this many empty polls in a row
+
+struct LogSlot
+    {
+    std::atomic<size_t> Sequence;
+    int32_t Level;
+    uint32_t Length;
+    char Text[LOG_LINE_SIZE];
+    };
+
+//A bounded queue with many producers and a single consumer at a time.
+//Producers claim a slot by advancing EnqueuePos, and publish it through the slot's Sequence.
+struct LogQueue
+    {
+    LogSlot Slots[LOG_QUEUE_SIZE];
+    std::atomic<size_t> EnqueuePos;
+    std::atomic<uint64_t> Dropped;
+
+    //Everything below is only touched while holding consumer_lock
+    std::mutex consumer_lock;
+    size_t DequeuePos;
+    FILE *File;
+    std::string LastLine;
+    uint32_t Repeats;
+
+    LogQueue():
+        EnqueuePos(0),
+        Dropped(0),
+        DequeuePos(0),
+        File(NULL),
+        Repeats(0)
+        {
+        for(size_t x = 0; x < LOG_QUEUE_SIZE; ++x)
+            Slots[x].Sequence.store(x, std::memory_order_relaxed);
+        }
+
+    ~LogQueue()
+        {
+        if(File != NULL)
+            fclose(File);
+        }
+
+    bool TryPush(const int32_t level, const char *text, const uint32_t length)
+        {
+        size_t pos = EnqueuePos.load(std::memory_order_relaxed);
+        LogSlot *slot = NULL;
+        for(;;)
+            {
+            slot = &Slots[pos & (LOG_QUEUE_SIZE - 1)];
+            size_t seq = slot->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if(diff == 0)
+                {
+                if(EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+                }
+            else if(diff < 0)
+                return false; //Full
+            else
+                pos = EnqueuePos.load(std::memory_order_relaxed);
+            }
+        slot->Level = level;
+        slot->Length = length;
+        memcpy(slot->Text, text, length);
+        //Sequentially consistent, so that an exiting flusher either drains it or the producer sees it has stopped
+        slot->Sequence.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+        }
+
+    //Written through printer, so that messages reach the LoggingCallback like any other output
+    void WriteLine(const char *text, const size_t length)
+        {
+        if(File != NULL)
+            fwrite(text, 1, length, File);
+        printer("%.*s", (int)length, text);
+        }
+
+    void WriteRepeats()
+        {
+        if(Repeats == 0)
+            return;
+        std::string notice = "Last message repeated " + std::to_string(Repeats) + " times\n";
+        WriteLine(notice.c_str(), notice.size());
+        Repeats = 0;
+        }
+
+    //Returns the number of messages written
+    uint32_t Drain()
+        {
+        uint32_t drained = 0;
+        for(;;)
+            {
+            LogSlot &slot = Slots[DequeuePos & (LOG_QUEUE_SIZE - 1)];
+            if(slot.Sequence.load(std::memory_order_seq_cst) != DequeuePos + 1)
+                break;
+            if(slot.Length == LastLine.size() && memcmp(slot.Text, LastLine.data(), slot.Length) == 0)
+                ++Repeats;
+            else
+                {
+                WriteRepeats();
+                LastLine.assign(slot.Text, slot.Length);
+                WriteLine(slot.Text, slot.Length);
+                }
+            slot.Sequence.store(DequeuePos + LOG_QUEUE_SIZE, std::memory_order_release);
+            ++DequeuePos;
+            ++drained;
+            }
+        uint64_t dropped = Dropped.exchange(0, std::memory_order_relaxed);
+        if(dropped != 0)
+            {
+            WriteRepeats();
+            std::string notice = "Dropped " + std::to_string(dropped) + " messages because the log queue was full\n";
+            WriteLine(notice.c_str(), notice.size());
+            LastLine.clear();
+            }
+        if(drained != 0 || dropped != 0)
+            {
+            WriteRepeats();
+            if(File != NULL)
+                fflush(File);
+            fflush(stdout);
+            }
+        return drained;
+        }
+    };
+
+//Shared with the flusher, so that a detached flusher can tell the Logger is gone without touching it
+struct FlusherState
+    {
+    std::mutex lock;
+    bool IsStopped;
+
+    FlusherState():
+        IsStopped(false)
+        {
+        //
+        }
+    };
+
+//Set while the current thread is draining, so that a message logged from the LoggingCallback
+// is left to that drain instead of waiting on the consumer_lock it already holds
+static THREAD_LOCAL bool IsDraining = false;
+
+static int64_t NowMS()
+    {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+static const char * BaseName(const char *file)
+    {
+    const char *name = file;
+    for(const char *c = file; *c != 0; ++c)
+        if(*c == '/' || *c == '\\')
+            name = c + 1;
+    return name;
+    }
+
+LogFormat::LogFormat(const char *Format, ...)
+    {
+    va_list args;
+    va_start(args, Format);
+    int written = vsnprintf(text, LOG_LINE_SIZE, Format, args);
+    va_end(args);
+    //Older CRTs don't terminate truncated output
+    if(written < 0 || written >= LOG_LINE_SIZE)
+        text[LOG_LINE_SIZE - 1] = 0;
+    }
+
+Logger::Logger():
+    Level(eLogDebug),
+    Queue(NULL),
+    IsFlusherRunning(false),
+    IsClosing(false),
+    state(std::make_shared<FlusherState>())
+    {
+    for(uint32_t x = 0; x < LOG_SITES; ++x)
+        {
+        Sites[x].WindowStart.store(0, std::memory_order_relaxed);
+        Sites[x].Count.store(0, std::memory_order_relaxed);
+        Sites[x].Suppressed.store(0, std::memory_order_relaxed);
+        Sites[x].File.store(NULL, std::memory_order_relaxed);
+        Sites[x].Line.store(0, std::memory_order_relaxed);
+        }
+    }
+
+//Joining the flusher here could deadlock under the loader lock, so Close() is expected to have stopped it.
+//Nothing is written either, since the LoggingCallback may already be gone.
+Logger::~Logger()
+    {
+    IsClosing.store(true);
+    IsFlusherRunning.store(false);
+        {
+        //Waits out a drain in progress. Afterwards the flusher only sees the stopped state it shares,
+        // and exits without touching the Logger, its queue or the LoggingCallback.
+        std::lock_guard<std::mutex> guard(state->lock);
+        state->IsStopped = true;
+        }
+    if(flusher.joinable())
+        flusher.detach();
+    delete Queue.exchange(NULL);
+    }
+
+//Stops the flusher and writes anything still queued. A later message starts a new flusher.
+void Logger::Close()
+    {
+        {
+        std::lock_guard<std::mutex> guard(start_lock);
+        IsClosing.store(true);
+        IsFlusherRunning.store(false);
+        if(flusher.joinable())
+            flusher.join();
+        }
+    Flush();
+    IsClosing.store(false);
+    }
+
+LogQueue * Logger::GetQueue()
+    {
+    LogQueue *queue = Queue.load(std::memory_order_acquire);
+    if(queue != NULL)
+        return queue;
+    std::lock_guard<std::mutex> guard(start_lock);
+    queue = Queue.load(std::memory_order_relaxed);
+    if(queue == NULL)
+        {
+        queue = new LogQueue();
+        Queue.store(queue, std::memory_order_release);
+        }
+    return queue;
+    }
+
+void Logger::StartFlusher()
+    {
+    std::lock_guard<std::mutex> guard(start_lock);
+    if(IsFlusherRunning.load())
+        return;
+    //A flusher that decided to exit is finishing its last drain
+    if(flusher.joinable())
+        flusher.join();
+    IsFlusherRunning.store(true);
+    flusher = std::thread(FlushLoop, this, Queue.load(), state);
+    }
+
+//Returns the number of messages written
+uint32_t Logger::DrainQueue(LogQueue *queue)
+    {
+    if(IsDraining)
+        return 0;
+    std::lock_guard<std::mutex> guard(queue->consumer_lock);
+    IsDraining = true;
+    uint32_t drained = 0;
+    try
+        {
+        drained = queue->Drain();
+        }
+    catch(...)
+        {
+        IsDraining = false;
+        throw;
+        }
+    IsDraining = false;
+    return drained;
+    }
+
+//Holds state->lock whenever it uses logger or queue, and checks that the Logger hasn't been destroyed first
+void Logger::FlushLoop(Logger *logger, LogQueue *queue, std::shared_ptr<FlusherState> state)
+    {
+    uint32_t idle = 0;
+    for(;;)
+        {
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOG_POLL_MS));
+        std::lock_guard<std::mutex> guard(state->lock);
+        if(state->IsStopped)
+            return;
+        if(!logger->IsFlusherRunning.load(std::memory_order_relaxed))
+            break;
+        logger->ReportSuppressed(false);
+        idle = DrainQueue(queue) != 0 ? 0 : idle + 1;
+        if(idle >= LOG_IDLE_POLLS)
+            {
+            logger->IsFlusherRunning.store(false);
+            break;
+            }
+        }
+    //Anything queued before the flag was cleared is written here, anything after starts a new flusher
+    std::lock_guard<std::mutex> guard(state->lock);
+    if(!state->IsStopped)
+        DrainQueue(queue);
+    }
+
+void Logger::init(int argc, char * argv[])
+    {
+    if(argc < 4)
+        return;
+
+    LogQueue *queue = GetQueue();
+    std::lock_guard<std::mutex> guard(queue->consumer_lock);
+    if(queue->File != NULL)
+        return;
+
+    std::string logFileName = argv[3];
+    logFileName += "Logs_";
+    std::time_t t = time(0);
+    struct tm* now = localtime(&t);
+    char buffer[20];
+    strftime(buffer, 20, "%d.%m.%y_%H.%M.%S", now);
+    logFileName += buffer;
+    logFileName += ".txt";
+    queue->File = fopen(logFileName.c_str(), "w");
+    if(queue->File == NULL)
+        {
+        fputs("Couldn't open log file\n", stdout);
+        return;
+        }
+
+    if(argc > 4)
+        SetLevel(atoi(argv[4]));
+
+    fprintf(queue->File, "Arguments: %s %s %s %d\n\n", argv[1], argv[2], argv[3], GetLevel());
+    }
+
+void Logger::SetLevel(const int32_t level)
+    {
+    Level.store(level, std::memory_order_relaxed);
+    }
+
+int32_t Logger::GetLevel() const
+    {
+    return Level.load(std::memory_order_relaxed);
+    }
+
+bool Logger::Admit(const int32_t level, const char *file, const int32_t line)
+    {
+    if(level < Level.load(std::memory_order_relaxed))
+        return false;
+
+    LogSite &site = Sites[(((size_t)file >> 4) ^ (size_t)line * 2654435761u) & (LOG_SITES - 1)];
+    int64_t now = NowMS();
+    int64_t start = site.WindowStart.load(std::memory_order_relaxed);
+    if(now - start >= LOG_SITE_WINDOW_MS && site.WindowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+        site.Count.store(0, std::memory_order_relaxed);
+    if(site.Count.fetch_add(1, std::memory_order_relaxed) < LOG_SITE_BURST)
+        return true;
+    site.File.store(file, std::memory_order_relaxed);
+    site.Line.store(line, std::memory_order_relaxed);
+    site.Suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+    }
+
+//Called by the flusher once a site's window has passed, so that the count shows up even if the site goes quiet
+void Logger::ReportSuppressed(const bool IsFinal)
+    {
+    int64_t now = NowMS();
+    for(uint32_t x = 0; x < LOG_SITES; ++x)
+        {
+        LogSite &site = Sites[x];
+        if(site.Suppressed.load(std::memory_order_relaxed) == 0)
+            continue;
+        int64_t start = site.WindowStart.load(std::memory_order_relaxed);
+        if(!IsFinal && now - start < LOG_SITE_WINDOW_MS)
+            continue;
+        uint32_t suppressed = site.Suppressed.exchange(0, std::memory_order_relaxed);
+        const char *file = site.File.load(std::memory_order_relaxed);
+        if(suppressed == 0 || file == NULL)
+            continue;
+        LogFormat notice("Suppressed %u messages from %s:%d\n", suppressed, BaseName(file), site.Line.load(std::memory_order_relaxed));
+        Push(eLogNone, notice.text, (uint32_t)strlen(notice.text));
+        }
+    }
+
+void Logger::Push(const int32_t level, const char *text, uint32_t length)
+    {
+    LogQueue *queue = GetQueue();
+    if(length > LOG_LINE_SIZE)
+        length = LOG_LINE_SIZE;
+    if(!queue->TryPush(level, text, length))
+        queue->Dropped.fetch_add(1, std::memory_order_relaxed);
+    //Written now, along with everything queued before them, rather than after the API call has returned
+    if(level == eLogWarning || level == eLogError)
+        {
+        DrainQueue(queue);
+        return;
+        }
+    if(!IsFlusherRunning.load() && !IsClosing.load(std::memory_order_relaxed))
+        StartFlusher();
+    }
+
+void Logger::Flush()
+    {
+    LogQueue *queue = Queue.load(std::memory_order_acquire);
+    if(queue == NULL)
+        return;
+    ReportSuppressed(true);
+    DrainQueue(queue);
+    }
+
+static THREAD_LOCAL LogCapture *CurrentCapture = NULL;
+
+LogCapture::LogCapture():
+    previous(CurrentCapture)
+    {
+    CurrentCapture = this;
+    }
+
+LogCapture::~LogCapture()
+    {
+    CurrentCapture = previous;
+    }
+
+LogCapture * LogCapture::Current()
+    {
+    return CurrentCapture;
+    }
+
+void LogCapture::Report(std::vector<std::pair<int32_t, std::string> > &messages)
+    {
+    //Reported in order, as if they had come from the calling thread
+    for(uint32_t x = 0; x < messages.size(); ++x)
+        {
+        if(messages[x].first < 0)
+            printer("%s", messages[x].second.c_str());
+        else
+            logger.Push(messages[x].first, messages[x].second.c_str(), (uint32_t)messages[x].second.size());
+        }
+    messages.clear();
+    }
+
+LogMessage::LogMessage(const int32_t _level):
+    level(_level),
+    used(0)
+    {
+    //
+    }
+
+LogMessage::~LogMessage()
+    {
+    LogCapture *capture = LogCapture::Current();
+    if(capture != NULL)
+        capture->messages.push_back(std::make_pair(level, std::string(text, used)));
+    else
+        logger.Push(level, text, used);
+    }
+
+void LogMessage::append(const char *value, uint32_t length)
+    {
+    if(length > LOG_LINE_SIZE - used)
+        length = LOG_LINE_SIZE - used;
+    memcpy(text + used, value, length);
+    used += length;
+    }
+
+LogMessage & LogMessage::operator<<(const char *value)
+    {
+    if(value != NULL)
+        append(value, (uint32_t)strlen(value));
+    return *this;
+    }
+
+LogMessage & LogMessage::operator<<(const std::string &value)
+    {
+    append(value.data(), (uint32_t)value.size());
+    return *this;
+    }
+
+LogMessage & LogMessage::operator<<(const LogFormat &value)
+    {
+    append(value.text, (uint32_t)strlen(value.text));
+    return *this;
+    }
+
+LogMessage & LogMessage::operator<<(const char value)
+    {
+    append(&value, 1);
+    return *this;
+    }
+
+LogMessage & LogMessage::operator<<(const int value)
+    {
+    return *this << (long long)value;
+    }
+
+LogMessage & LogMessage::operator<<(const unsigned int value)
+    {
+    return *this << (unsigned long long)value;
+    }
+
+LogMessage & LogMessage::operator<<(const long value)
+    {
+    return *this << (long long)value;
+    }
+
+LogMessage & LogMessage::operator<<(const unsigned long value)
+    {
+    return *this << (unsigned long long)value;
+    }
+
+LogMessage & LogMessage::operator<<(const long long value)
+    {
+    char buffer[24];
+    sprintf(buffer, "%lld", value);
+    return *this << buffer;
+    }
+
+LogMessage & LogMessage::operator<<(const unsigned long long value)
+    {
+    char buffer[24];
+    sprintf(buffer, "%llu", value);
+    return *this << buffer;
+    }
+
+LogMessage & LogMessage::operator<<(const double value)
+    {
+    char buffer[32];
+    sprintf(buffer, "%g", value);
+    return *this << buffer;
+    }
+
+LogMessage & LogMessage::operator<<(std::ostream & (*)(std::ostream &))
+    {
+    //std::endl is the only manipulator in use
+    return *this << '\n';
+    }
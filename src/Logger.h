@@ -1,44 +1,172 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
 #pragma once
-#include <fstream>
-#include <iostream>
+// Logger.h
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
 #include <vector>
+#include <ostream>
 
-struct Log {
-	std::ofstream* logFile = NULL;
-	bool isHigherLevel = false;
-
-	template <typename T>
-	Log& operator<<(T const& obj) {
-		if (logFile != NULL)
-			(*logFile) << obj;
-
-		if (isHigherLevel)
-			std::cout << obj;
-
-		return *this;
-	}
-
-	Log& operator<<(std::ostream& (*pf)(std::ostream&)) {
-		if (logFile != NULL)
-			(*logFile) << pf;
-
-		if (isHigherLevel)
-			std::cout << pf;
-
-		return *this;
-	}
-};
-
-class Logger {
-private:
-	int logLevel = 2; // Debug and above
-	std::ofstream logFile;
-	std::vector<Log> loggers;
-	Logger() {}
-public:
-	~Logger();
-	Logger(Logger& copy) {}
-	static Logger& getInstance();
-	void init(int argc, char * argv[]);
-	Log* getLogger(int level);
-};
\ No newline at end of file
+#ifndef LOG_LINE_SIZE
+    #define LOG_LINE_SIZE      512  //Longer messages are truncated
+#endif
+
+#ifndef LOG_QUEUE_SIZE
+    #define LOG_QUEUE_SIZE     1024 //Must be a power of two
+#endif
+
+#ifndef LOG_SITES
+    #define LOG_SITES          256  //Call sites that hash to the same slot share a rate limit
+#endif
+
+#ifndef LOG_SITE_BURST
+    #define LOG_SITE_BURST     16   //Messages a call site may log in each window before the rest are suppressed
+#endif
+
+#ifndef LOG_SITE_WINDOW_MS
+    #define LOG_SITE_WINDOW_MS 1000
+#endif
+
+struct LogQueue;
+struct FlusherState;
+
+//printf style formatting for log_* messages, so that it only happens once the level check has passed
+class LogFormat
+    {
+    public:
+        char text[LOG_LINE_SIZE];
+
+        LogFormat(const char *Format, ...);
+    };
+
+//Messages are queued without locking and written by a flusher thread.
+//The flusher is started by the first message and exits once the queue has been idle for a while.
+//Warnings and errors are written before Push returns, so they aren't reported after the call that failed.
+//Close() must be called before the library is unloaded, since the destructor can't safely join the flusher.
+class Logger
+    {
+    private:
+        struct LogSite
+            {
+            std::atomic<int64_t> WindowStart;
+            std::atomic<uint32_t> Count;
+            std::atomic<uint32_t> Suppressed;
+            std::atomic<const char *> File; //The last call site seen, named in the suppression notice
+            std::atomic<int32_t> Line;
+            };
+
+        std::atomic<int32_t> Level;
+        LogSite Sites[LOG_SITES];
+        std::atomic<LogQueue *> Queue;
+        std::atomic<bool> IsFlusherRunning;
+        std::atomic<bool> IsClosing;
+        std::mutex start_lock;
+        std::thread flusher;
+        std::shared_ptr<FlusherState> state;
+
+        LogQueue * GetQueue();
+        void StartFlusher();
+        void ReportSuppressed(const bool IsFinal);
+        static uint32_t DrainQueue(LogQueue *queue);
+        static void FlushLoop(Logger *logger, LogQueue *queue, std::shared_ptr<FlusherState> state);
+
+    public:
+        Logger();
+        ~Logger();
+
+        void init(int argc, char * argv[]);
+        void SetLevel(const int32_t level);
+        int32_t GetLevel() const;
+
+        bool Admit(const int32_t level, const char *file, const int32_t line);
+        void Push(const int32_t level, const char *text, uint32_t length);
+        void Flush();
+        void Close();
+    };
+
+extern Logger logger;
+
+//A single message, queued when the statement that built it ends
+class LogMessage
+    {
+    private:
+        int32_t level;
+        uint32_t used;
+        char text[LOG_LINE_SIZE];
+
+        void append(const char *value, uint32_t length);
+
+    public:
+        LogMessage(const int32_t _level);
+        ~LogMessage();
+
+        LogMessage & operator<<(const char *value);
+        LogMessage & operator<<(const std::string &value);
+        LogMessage & operator<<(const LogFormat &value);
+        LogMessage & operator<<(const char value);
+        LogMessage & operator<<(const int value);
+        LogMessage & operator<<(const unsigned int value);
+        LogMessage & operator<<(const long value);
+        LogMessage & operator<<(const unsigned long value);
+        LogMessage & operator<<(const long long value);
+        LogMessage & operator<<(const unsigned long long value);
+        LogMessage & operator<<(const double value);
+        LogMessage & operator<<(std::ostream & (*manipulator)(std::ostream &));
+    };
+
+//While one is in scope, messages logged or printed by the current thread are collected in it,
+// so that a worker thread can leave them for the thread that started it to report
+class LogCapture
+    {
+    private:
+        LogCapture *previous;
+
+    public:
+        std::vector<std::pair<int32_t, std::string> > messages; //The level of each message, or -1 for printer output
+
+        LogCapture();
+        ~LogCapture();
+
+        static LogCapture * Current();
+        static void Report(std::vector<std::pair<int32_t, std::string> > &messages);
+    };
+
+//The level and rate limit are checked before anything to the right of the macro is evaluated
+#define LOG_AT(level, prefix) if(!logger.Admit(level, __FILE__, __LINE__)) {} else LogMessage(level) << prefix
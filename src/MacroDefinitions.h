@@ -88,18 +88,10 @@
     #define PEEK_SIZE 32
 #endif
 
-//These require CBASH_PROFILING to be defined
-#ifdef CBASH_PROFILING
-    //define or undef as desired
-    #define CBASH_CALLTIMING
-    #define CBASH_CALLCOUNT
-    #undef CBASH_TRACE
-#else
-    //don't touch
-    #undef CBASH_CALLTIMING
-    #undef CBASH_CALLCOUNT
-    #undef CBASH_TRACE
-#endif
+//Profiling is always compiled in, and switched at runtime with SetProfiling()
+//Defining CBASH_PROFILING switches it on from the start, and prints the report once the last collection is deleted
+//Trace spans for the load and save timeline are likewise switched with SetTracing()
+#include "Profiler.h"
 
 #ifdef CBASH_TRACE
     #define TRACE_FUNC printer("%s\n", __FUNCTION__)
@@ -107,93 +99,11 @@
     #define TRACE_FUNC
 #endif
 
-#ifdef CBASH_PROFILING
-    #define PROFILE_FUNC TRACE_FUNC;COUNT_FUNC;TIME_FUNC;
-#else
-    #define PROFILE_FUNC
-#endif
-
-#ifdef CBASH_CALLTIMING
-    #include <windows.h>
-    #include <map>
-
-    extern std::map<char *, double> CallTime;
-
-    typedef struct
-        {
-        LARGE_INTEGER start;
-        LARGE_INTEGER stop;
-        } stopWatch;
-
-    class CStopWatch
-        {
-        private:
-            stopWatch timer;
-            LARGE_INTEGER frequency;
-            char *FunctionName;
-            bool did_end;
-
-        public:
-            CStopWatch(char *FName):
-                FunctionName(FName),
-                did_end(false)
-                {
-                timer.start.QuadPart=0;
-                timer.stop.QuadPart=0;
-                QueryPerformanceFrequency(&frequency);
-                QueryPerformanceCounter(&timer.start);
-                }
-
-            ~CStopWatch()
-                {
-                end();
-                }
-            void end()
-                {
-                if(did_end)
-                    return;
-                QueryPerformanceCounter(&timer.stop);
-                LARGE_INTEGER time;
-                time.QuadPart = timer.stop.QuadPart - timer.start.QuadPart;
-                CallTime[FunctionName] = CallTime[FunctionName] + ((double)time.QuadPart / (double)frequency.QuadPart);
-                did_end = true;
-                }
-        };
-    #define TIME_FUNC CStopWatch cbtimer(__FUNCTION__)
-#else
-    #define TIME_FUNC
-#endif
-
-#ifdef CBASH_CALLCOUNT
-    #include <map>
-    extern std::map<char *, unsigned long> CallCount;
-
-    class CCounter
-        {
-        private:
-            char *FunctionName;
-            bool did_end;
-
-        public:
-            CCounter(char *FName):
-                FunctionName(FName),
-                did_end(false)
-                {
-                end();
-                }
-            void end()
-                {
-                if(did_end)
-                    return;
-                CallCount[FunctionName] = ++CallCount[FunctionName];
-                did_end = true;
-                }
-        };
-
-    #define COUNT_FUNC CCounter cbcounter(__FUNCTION__)
-#else
-    #define COUNT_FUNC
-#endif
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) static ProfilePoint PROFILE_CONCAT(cbpoint, __LINE__); ProfileScope PROFILE_CONCAT(cbprofile, __LINE__)(PROFILE_CONCAT(cbpoint, __LINE__), name)
+#define PROFILE_FUNC TRACE_FUNC; PROFILE_SCOPE(__FUNCTION__);
+#define TRACE_SPAN(...) TraceSpan PROFILE_CONCAT(cbspan, __LINE__)(__VA_ARGS__)
 
 #ifdef CBASH_DEBUG_VARS
     #include <map>
@@ -231,8 +141,12 @@
 #define PRINT_ERROR printer("%s: Error - An unhandled exception occurred.\n", __FUNCTION__)
 #endif
 
+#ifndef NUMREADLOCKS
+    #define NUMREADLOCKS    64
+#endif
+
 #ifndef NUMTHREADS
-    #define NUMTHREADS    boost::thread::hardware_concurrency()
+    #define NUMTHREADS    std::max(std::thread::hardware_concurrency(), 1u)
 #endif
 
 //Using 64KB buffers
@@ -330,10 +244,8 @@ typedef Record ** RECORDIDARRAY;
     SIZE_CHECK_MSG(type, size, #type " must be " #size " bytes")
 
 
-#define CBASH_SUBTYPE_UNKNOWN char unknownSubBuffer[150]; \
-	sprintf(unknownSubBuffer, "%s: %08X - Unknown subType = %04x [%c%c%c%c]\n\tSize = %i\n\tCurPos = %08x\n\n", GetStrType(), formID, subType, (subType >> 0) & 0xFF, (subType >> 8) & 0xFF, (subType >> 16) & 0xFF, (subType >> 24) & 0xFF, subSize, buffer - 6); \
-	log_error << unknownSubBuffer;
+#define CBASH_SUBTYPE_UNKNOWN \
+	log_error << LogFormat("%s: %08X - Unknown subType = %04x [%c%c%c%c]\n\tSize = %i\n\tCurPos = %08x\n\n", GetStrType(), formID, subType, (subType >> 0) & 0xFF, (subType >> 8) & 0xFF, (subType >> 16) & 0xFF, (subType >> 24) & 0xFF, subSize, buffer - 6);
 
-#define CBASH_SUBTYPE_NOT_IMPLEMENTED char notImpSubBuffer[150]; \
-	sprintf(notImpSubBuffer, "%s: %08X - Not Implemented subType = %04x [%c%c%c%c]\n\tSize = %i\n\tCurPos = %08x\n\n", GetStrType(), formID, subType, (subType >> 0) & 0xFF, (subType >> 8) & 0xFF, (subType >> 16) & 0xFF, (subType >> 24) & 0xFF, subSize, buffer - 6); \
-	log_warning << notImpSubBuffer;
\ No newline at end of file
+#define CBASH_SUBTYPE_NOT_IMPLEMENTED \
+	log_warning << LogFormat("%s: %08X - Not Implemented subType = %04x [%c%c%c%c]\n\tSize = %i\n\tCurPos = %08x\n\n", GetStrType(), formID, subType, (subType >> 0) & 0xFF, (subType >> 8) & 0xFF, (subType >> 16) & 0xFF, (subType >> 24) & 0xFF, subSize, buffer - 6);
\ No newline at end of file
@@ -38,8 +38,22 @@
 #include "ModFile.h"
 #include "GenericRecord.h"
 
+LoadMonitor::LoadMonitor():
+    IsCancelled(false),
+    ModIndex(0),
+    NumMods(0),
+    ModBytesRead(0),
+    ModBytesTotal(0),
+    BytesRead(0),
+    BytesTotal(0),
+    BytesDone(0)
+    {
+    //
+    }
+
 ModFile::ModFile(Collection *_Parent, char * filename, char * modname, const uint32_t _flags):
     Parent(_Parent),
+    Monitor(NULL),
     Flags(_flags),
     TES4(),
     FormIDHandler(TES4.MAST, TES4.HEDR.value.nextObject),
@@ -119,7 +133,7 @@ bool ModFile::Open()
         return false;
     try
         {
-        file_map.open(FileName);
+        file_map = AcquireMapping(FileName);
         }
     catch(std::ios::failure const &ex)
         {
@@ -151,10 +165,21 @@ bool ModFile::Close()
     if(!file_map.is_open())
         return false;
 
-    file_map.close();
+    ReleaseMapping(file_map);
     return true;
     }
 
+bool ModFile::ContinueLoad()
+    {
+    //Called between top level GRUPs, where stopping leaves no record half indexed
+    if(Monitor == NULL)
+        return true;
+    uint64_t read = (uint64_t)(buffer_position - buffer_start);
+    Monitor->ModBytesRead = read;
+    Monitor->BytesRead = Monitor->BytesDone + read;
+    return !Monitor->IsCancelled;
+    }
+
 FormIDMasterUpdater::FormIDMasterUpdater(FormIDHandlerClass &_FormIDHandler):
     FormIDOp(),
     FormIDHandler(_FormIDHandler),
@@ -38,9 +38,25 @@
 #include "Common.h"
 #include "GenericRecord.h"
 #include "TES4Record.h" //Is shared across all mod types
+#include <atomic>
 
 struct Collection;
 
+//Progress of a collection load, shared with whoever is watching it from another thread
+struct LoadMonitor
+    {
+    std::atomic<bool> IsCancelled;
+    std::atomic<uint32_t> ModIndex;
+    std::atomic<uint32_t> NumMods; //Zero until the load order is settled
+    std::atomic<uint64_t> ModBytesRead;
+    std::atomic<uint64_t> ModBytesTotal;
+    std::atomic<uint64_t> BytesRead;
+    std::atomic<uint64_t> BytesTotal;
+    uint64_t BytesDone; //Bytes in the mods already loaded, only touched by the loading thread
+
+    LoadMonitor();
+    };
+
 struct ModFile
     {
     public:
@@ -61,6 +77,7 @@ struct ModFile
         uint32_t ModID;
 
         Collection *Parent;
+        LoadMonitor *Monitor;
 
         TES4Record TES4;
 
@@ -75,13 +92,14 @@ struct ModFile
 
         bool   Open();
         bool   Close();
+        bool   ContinueLoad();
 
         virtual int32_t   LoadTES4() = 0;
         virtual int32_t   Load(RecordOp &read_parser, RecordOp &indexer, std::vector<FormIDResolver *> &Expanders, std::vector<Record *> &DeletedRecords) = 0;
         virtual size_t   GetNumRecords(const uint32_t &RecordType) = 0;
         virtual Record * CreateRecord(const uint32_t &RecordType, char * const &RecordEditorID, Record *&SourceRecord, Record *&ParentRecord, CreationFlags &options) = 0;
         virtual int32_t   DeleteRecord(Record *&curRecord, RecordOp &deindexer) = 0;
-        virtual int32_t   Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer) = 0;
+        virtual int32_t   Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer, StringTableWriter *Strings) = 0;
 
         virtual void     SetFilter(bool inclusive, boost::unordered_set<uint32_t> &RecordTypes, boost::unordered_set<FORMID> &WorldSpaces) = 0;
 
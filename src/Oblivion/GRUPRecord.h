@@ -226,6 +226,7 @@ class GRUPRecords<Ob::DIALRecord, RecType, AllocUnit, IsKeyedByEditorID>
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             dial_pool.MakeRecordsVector(Records);
             uint32_t numDIALRecords = (uint32_t)Records.size(); //Parent Records
@@ -575,6 +576,7 @@ class GRUPRecords<Ob::CELLRecord, RecType, AllocUnit, IsKeyedByEditorID>
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             cell_pool.MakeRecordsVector(Records);
             uint32_t numCELLRecords = (uint32_t)Records.size();
@@ -870,7 +872,6 @@ class GRUPRecords<Ob::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
             Ob::CELLRecord *last_cell_record = NULL, *orphaned_cell_records = NULL;
             uint32_t numWRLD = 0, numCELL = 0, numACHR = 0, numACRE = 0, numREFR = 0, numPGRD = 0, numLAND = 0, numROAD = 0;
 
-            std::map<int32_t, std::map<int32_t, Ob::LANDRecord *> > GridXY_LAND;
             std::vector<std::pair<uint32_t, unsigned char *> > GRUPs;
             std::pair<uint32_t, unsigned char *> GRUP_End;
             GRUP_End.first = eTop;
@@ -1204,7 +1205,7 @@ class GRUPRecords<Ob::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 read_parser.Accept((Record *&)last_cell_record); //may already be loaded, but just to be sure.
                                 //CELL will be unloaded if needed after a second round of indexing when all records are loaded
                                 last_cell_record->XCLC.Load(); //in-case no XCLC chunk is specified
-                                GridXY_LAND[last_cell_record->XCLC->posX][last_cell_record->XCLC->posY] = (Ob::LANDRecord *)curRecord;
+                                last_wrld_record->LANDs.Insert(last_cell_record->XCLC->posX, last_cell_record->XCLC->posY, curRecord);
                                 }
                             break;
                         default:
@@ -1338,10 +1339,10 @@ class GRUPRecords<Ob::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 last_land_record = (Ob::LANDRecord *)last_cell_record->LAND;
                                 if(last_land_record != NULL)
                                     {
-                                    last_land_record->NorthLand = GridXY_LAND[posX][posY + 1];
-                                    last_land_record->SouthLand = GridXY_LAND[posX][posY - 1];
-                                    last_land_record->EastLand = GridXY_LAND[posX + 1][posY];
-                                    last_land_record->WestLand = GridXY_LAND[posX - 1][posY];
+                                    last_land_record->NorthLand = (Ob::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY + 1);
+                                    last_land_record->SouthLand = (Ob::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY - 1);
+                                    last_land_record->EastLand = (Ob::LANDRecord *)last_wrld_record->LANDs.Find(posX + 1, posY);
+                                    last_land_record->WestLand = (Ob::LANDRecord *)last_wrld_record->LANDs.Find(posX - 1, posY);
                                     }
                                 }
 
@@ -1392,6 +1393,7 @@ class GRUPRecords<Ob::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
         template<typename U>
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod, FormIDHandlerClass &FormIDHandler, U &CELL, RecordOp &indexer)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             wrld_pool.MakeRecordsVector(Records);
             uint32_t numWRLDRecords = (uint32_t)Records.size();
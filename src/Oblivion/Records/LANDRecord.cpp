@@ -335,6 +335,27 @@ float LANDRecord::CalcHeight(const uint32_t &row, const uint32_t &column)
     return fRetValue;
     }
 
+void LANDRecord::CalcHeights(float (&Heights)[33][33])
+    {
+    if(!VHGT.IsLoaded())
+        {
+        memset(Heights, 0, sizeof(Heights));
+        return;
+        }
+
+    //Same sums as CalcHeight, but each row continues from the previous vertex instead of starting over
+    float fRowStart = VHGT->offset * 8.0f;
+    for(uint32_t curRow = 0; curRow < 33; ++curRow)
+        {
+        const int8_t *deltas = VHGT->VHGT[curRow];
+        float *heights = Heights[curRow];
+        fRowStart += deltas[0] * 8.0f;
+        heights[0] = fRowStart;
+        for(uint32_t curColumn = 1; curColumn < 33; ++curColumn)
+            heights[curColumn] = heights[curColumn - 1] + deltas[curColumn] * 8.0f;
+        }
+    }
+
 int32_t LANDRecord::ParseRecord(unsigned char *buffer, unsigned char *end_buffer, bool CompressedOnDisk)
     {
     uint32_t subType = 0;
@@ -170,12 +170,16 @@ int32_t TES4File::Load(RecordOp &read_parser, RecordOp &indexer, std::vector<For
     processor.SetFilter(filter_inclusive, filter_records, filter_wspaces);
 
     while(buffer_position < buffer_end){
+        if(!ContinueLoad())
+            break;
+        PROFILE_SCOPE("GRUP scan");
         buffer_position += 4; //Skip "GRUP"
         GRUPSize = *(uint32_t *)buffer_position;
         group_buffer_end = buffer_position + GRUPSize - 4;
         buffer_position += 4;
         GRUPLabel = *(uint32_t *)buffer_position;
         buffer_position += 8; //Skip type (tops will all == 0)
+        TRACE_SPAN("GRUP", ModName, GRUPLabel);
 
         //printer("%c%c%c%c\n", ((char *)&GRUPLabel)[0], ((char *)&GRUPLabel)[1], ((char *)&GRUPLabel)[2], ((char *)&GRUPLabel)[3]);
         switch(GRUPLabel)
@@ -1097,6 +1101,9 @@ int32_t TES4File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
             deindexer.Accept(cell_record->PGRD);
             CELL.pgrd_pool.destroy(cell_record->PGRD);
 
+            //Keep the worldspace's grid index from pointing at the deleted LAND
+            if(cell_record->LAND != NULL && cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+                ((Ob::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(cell_record->LAND);
             deindexer.Accept(cell_record->LAND);
             WRLD.land_pool.destroy(cell_record->LAND);
 
@@ -1248,6 +1255,8 @@ int32_t TES4File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
                 }
 
             cell_record->LAND = NULL;
+            if(cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+                ((Ob::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(curRecord);
             deindexer.Accept(curRecord);
             WRLD.land_pool.destroy(curRecord);
             }
@@ -1358,7 +1367,7 @@ int32_t TES4File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
     return 0;
     }
 
-int32_t TES4File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer)
+int32_t TES4File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer, StringTableWriter *Strings)
     {
     if(!Flags.IsSaveable)
         {
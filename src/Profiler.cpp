@@ -0,0 +1,457 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// Profiler.cpp
+#include "Profiler.h"
+#include <mutex>
+#include <vector>
+#include <stdio.h>
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
+#ifdef CBASH_PROFILING
+    std::atomic<bool> IsProfiling(true);
+#else
+    std::atomic<bool> IsProfiling(false);
+#endif
+std::atomic<bool> IsTracing(false);
+
+//The per thread state below is kept to pointers and counters, which is all THREAD_LOCAL can hold
+
+#ifndef PROFILE_TABLES
+    #define PROFILE_TABLES  64
+#endif
+
+//Each thread records into its own table, taken from a fixed set the first time it records.
+//When the thread exits, its counts are added to the retired table and its table is reused.
+//Threads that start while the set is used up all record into one shared overflow table.
+//Every counter is atomic, so a table that is shared, or being reset or reported, is never torn.
+struct ProfileCounters
+    {
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> longest;
+    std::atomic<uint64_t> buckets[PROFILE_BUCKETS]; //log2 of the duration, starting at 256ns
+    };
+
+struct ThreadProfile
+    {
+    ProfileCounters counters[PROFILE_POINTS];
+
+    ThreadProfile()
+        {
+        Reset();
+        }
+
+    void Reset()
+        {
+        for(uint32_t x = 0; x < PROFILE_POINTS; ++x)
+            {
+            ProfileCounters &counter = counters[x];
+            counter.calls.store(0, std::memory_order_relaxed);
+            counter.total.store(0, std::memory_order_relaxed);
+            counter.longest.store(0, std::memory_order_relaxed);
+            for(uint32_t y = 0; y < PROFILE_BUCKETS; ++y)
+                counter.buckets[y].store(0, std::memory_order_relaxed);
+            }
+        }
+
+    void Add(ThreadProfile &other)
+        {
+        for(uint32_t x = 0; x < PROFILE_POINTS; ++x)
+            {
+            ProfileCounters &counter = counters[x], &other_counter = other.counters[x];
+            counter.calls.fetch_add(other_counter.calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            counter.total.fetch_add(other_counter.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            uint64_t longest = other_counter.longest.load(std::memory_order_relaxed);
+            if(longest > counter.longest.load(std::memory_order_relaxed))
+                counter.longest.store(longest, std::memory_order_relaxed);
+            for(uint32_t y = 0; y < PROFILE_BUCKETS; ++y)
+                counter.buckets[y].fetch_add(other_counter.buckets[y].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+    };
+
+static std::mutex ProfilesLock;
+static std::vector<const char *> PointNames;
+static std::atomic<ThreadProfile *> ProfileTables[PROFILE_TABLES + 1]; //The last is the overflow table
+static ThreadProfile *RetiredProfile = NULL; //The counts of threads that have exited
+static std::vector<uint32_t> FreeProfileTables;
+static uint32_t NextProfileTable = 0;
+static uint32_t SharedProfileThreads = 0;
+static THREAD_LOCAL ThreadProfile *LocalProfile = NULL;
+
+static ThreadProfile * GetProfileTable(const uint32_t table)
+    {
+    if(ProfileTables[table].load() == NULL)
+        ProfileTables[table].store(new ThreadProfile());
+    return ProfileTables[table].load();
+    }
+
+//Called as the thread that took the table exits
+static void ReleaseProfileTable(const uint32_t table)
+    {
+    std::lock_guard<std::mutex> lock(ProfilesLock);
+    if(table == PROFILE_TABLES)
+        --SharedProfileThreads;
+    else
+        {
+        if(RetiredProfile == NULL)
+            RetiredProfile = new ThreadProfile();
+        ThreadProfile *profile = ProfileTables[table].load();
+        RetiredProfile->Add(*profile);
+        profile->Reset();
+        FreeProfileTables.push_back(table);
+        }
+    //Anything the thread still times on its way out goes to the overflow table, rather than taking a new one
+    LocalProfile = GetProfileTable(PROFILE_TABLES);
+    }
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    //__declspec(thread) runs no destructors, so a fiber local storage callback hands the table back instead
+    static DWORD ProfileTableSlot = FLS_OUT_OF_INDEXES;
+
+    static void WINAPI ReleaseProfileTableSlot(void *table)
+        {
+        if(table != NULL)
+            ReleaseProfileTable((uint32_t)((uintptr_t)table - 1));
+        }
+
+    //Called with ProfilesLock held
+    static void OwnProfileTable(const uint32_t table)
+        {
+        if(ProfileTableSlot == FLS_OUT_OF_INDEXES)
+            ProfileTableSlot = FlsAlloc(ReleaseProfileTableSlot);
+        if(ProfileTableSlot != FLS_OUT_OF_INDEXES)
+            FlsSetValue(ProfileTableSlot, (void *)(uintptr_t)(table + 1));
+        }
+#else
+    //Hands the thread's table back when the thread exits
+    struct ProfileTableOwner
+        {
+        uint32_t table;
+
+        ProfileTableOwner():
+            table(PROFILE_TABLES + 1)
+            {
+            //
+            }
+
+        ~ProfileTableOwner()
+            {
+            if(table <= PROFILE_TABLES)
+                ReleaseProfileTable(table);
+            }
+        };
+
+    static thread_local ProfileTableOwner LocalProfileOwner;
+
+    //Called with ProfilesLock held
+    static void OwnProfileTable(const uint32_t table)
+        {
+        LocalProfileOwner.table = table;
+        }
+#endif
+
+uint32_t RegisterProfilePoint(ProfilePoint &point, const char *name)
+    {
+    std::lock_guard<std::mutex> lock(ProfilesLock);
+    //Another thread may have registered it while this one waited
+    uint32_t id = point.id.load(std::memory_order_acquire);
+    if(id == 0)
+        {
+        PointNames.push_back(name);
+        id = (uint32_t)PointNames.size();
+        point.id.store(id, std::memory_order_release);
+        }
+    return id;
+    }
+
+void RecordProfileSample(const uint32_t id, const uint64_t nanoseconds)
+    {
+    if(id >= PROFILE_POINTS)
+        return;
+    if(LocalProfile == NULL)
+        {
+        std::lock_guard<std::mutex> lock(ProfilesLock);
+        uint32_t table = PROFILE_TABLES;
+        if(!FreeProfileTables.empty())
+            {
+            table = FreeProfileTables.back();
+            FreeProfileTables.pop_back();
+            }
+        else if(NextProfileTable < PROFILE_TABLES)
+            table = NextProfileTable++;
+        else
+            ++SharedProfileThreads;
+        LocalProfile = GetProfileTable(table);
+        OwnProfileTable(table);
+        }
+    ProfileCounters &counter = LocalProfile->counters[id];
+    counter.calls.fetch_add(1, std::memory_order_relaxed);
+    counter.total.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t longest = counter.longest.load(std::memory_order_relaxed);
+    while(nanoseconds > longest && !counter.longest.compare_exchange_weak(longest, nanoseconds, std::memory_order_relaxed))
+        {
+        //
+        }
+    uint32_t bucket = 0;
+    for(uint64_t scaled = nanoseconds >> 8; scaled > 1 && bucket < PROFILE_BUCKETS - 1; scaled >>= 1)
+        ++bucket;
+    counter.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+std::string BuildProfileReport()
+    {
+    std::lock_guard<std::mutex> lock(ProfilesLock);
+    std::vector<ThreadProfile *> tables;
+    for(uint32_t p = 0; p <= PROFILE_TABLES; ++p)
+        if(ProfileTables[p].load() != NULL)
+            tables.push_back(ProfileTables[p].load());
+    uint32_t NumTables = (uint32_t)tables.size();
+    if(RetiredProfile != NULL)
+        tables.push_back(RetiredProfile);
+
+    std::string report;
+    report += "{\"enabled\":";
+    report += IsProfiling ? "true" : "false";
+    report += ",\"tables\":" + std::to_string((unsigned long long)NumTables);
+    report += ",\"free_tables\":" + std::to_string((unsigned long long)FreeProfileTables.size());
+    report += ",\"shared_threads\":" + std::to_string((unsigned long long)SharedProfileThreads);
+    report += ",\"points\":[";
+    bool IsFirst = true;
+    uint32_t NumPoints = (uint32_t)PointNames.size() < PROFILE_POINTS ? (uint32_t)PointNames.size() : PROFILE_POINTS;
+    for(uint32_t x = 0; x < NumPoints; ++x)
+        {
+        uint64_t calls = 0, total = 0, longest = 0;
+        uint64_t buckets[PROFILE_BUCKETS] = {0};
+        for(uint32_t p = 0; p < tables.size(); ++p)
+            {
+            ProfileCounters &counter = tables[p]->counters[x];
+            calls += counter.calls.load(std::memory_order_relaxed);
+            total += counter.total.load(std::memory_order_relaxed);
+            uint64_t table_longest = counter.longest.load(std::memory_order_relaxed);
+            if(table_longest > longest)
+                longest = table_longest;
+            for(uint32_t y = 0; y < PROFILE_BUCKETS; ++y)
+                buckets[y] += counter.buckets[y].load(std::memory_order_relaxed);
+            }
+        if(calls == 0)
+            continue;
+
+        if(!IsFirst)
+            report += ",";
+        IsFirst = false;
+        report += "{\"name\":\"";
+        for(const char *name = PointNames[x]; *name != 0; ++name)
+            {
+            if(*name == '"' || *name == '\\')
+                report += '\\';
+            report += *name;
+            }
+        report += "\",\"calls\":" + std::to_string((unsigned long long)calls);
+        report += ",\"total_ns\":" + std::to_string((unsigned long long)total);
+        report += ",\"mean_ns\":" + std::to_string((unsigned long long)(total / calls));
+        report += ",\"max_ns\":" + std::to_string((unsigned long long)longest);
+        //Each pair is the lower bound of a bucket in nanoseconds, and the calls that fell in it
+        report += ",\"histogram\":[";
+        bool IsFirstBucket = true;
+        for(uint32_t y = 0; y < PROFILE_BUCKETS; ++y)
+            {
+            if(buckets[y] == 0)
+                continue;
+            if(!IsFirstBucket)
+                report += ",";
+            IsFirstBucket = false;
+            report += "[" + std::to_string(y == 0 ? 0ULL : (unsigned long long)(256ULL << y)) + "," + std::to_string((unsigned long long)buckets[y]) + "]";
+            }
+        report += "]}";
+        }
+    report += "]}";
+    return report;
+    }
+
+void ResetProfile()
+    {
+    //Samples recorded while resetting may survive it
+    std::lock_guard<std::mutex> lock(ProfilesLock);
+    for(uint32_t p = 0; p <= PROFILE_TABLES; ++p)
+        if(ProfileTables[p].load() != NULL)
+            ProfileTables[p].load()->Reset();
+    if(RetiredProfile != NULL)
+        RetiredProfile->Reset();
+    }
+
+struct TraceEvent
+    {
+    std::string name;
+    std::string ModName;
+    uint32_t label;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t duration;
+    uint64_t records;
+    uint64_t inflated;
+    };
+
+#ifndef TRACE_EVENTS
+    #define TRACE_EVENTS    65536 //Once this many spans are held, each new one replaces the oldest
+#endif
+
+static std::mutex TraceLock;
+static std::vector<TraceEvent> TraceEvents;
+static uint32_t OldestTraceEvent = 0;
+static uint64_t DroppedTraceEvents = 0;
+static std::atomic<uint32_t> NextTraceThread(0);
+static const std::chrono::steady_clock::time_point TraceEpoch = std::chrono::steady_clock::now();
+
+static THREAD_LOCAL uint32_t LocalTraceThread = 0; //Zero until the thread ends its first span
+static THREAD_LOCAL TraceCounters LocalTrace = {0, 0};
+
+TraceCounters &LocalTraceCounters()
+    {
+    return LocalTrace;
+    }
+
+TraceSpan::TraceSpan(const char *_name, const char *_ModName, const uint32_t _label):
+    IsActive(IsTracing.load(std::memory_order_relaxed)),
+    name(_name),
+    ModName(_ModName),
+    label(_label),
+    records(0),
+    inflated(0)
+    {
+    if(!IsActive)
+        return;
+    records = LocalTrace.records;
+    inflated = LocalTrace.inflated;
+    start = std::chrono::steady_clock::now();
+    }
+
+TraceSpan::~TraceSpan()
+    {
+    if(!IsActive)
+        return;
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    TraceEvent event;
+    event.name = name;
+    if(label != 0)
+        {
+        event.name += ' ';
+        event.name.append((const char *)&label, 4);
+        }
+    if(ModName != NULL)
+        event.ModName = ModName;
+    event.label = label;
+    if(LocalTraceThread == 0)
+        LocalTraceThread = ++NextTraceThread;
+    event.thread = LocalTraceThread;
+    event.start = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(start - TraceEpoch).count();
+    event.duration = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+    event.records = LocalTrace.records - records;
+    event.inflated = LocalTrace.inflated - inflated;
+    std::lock_guard<std::mutex> lock(TraceLock);
+    if(TraceEvents.size() < TRACE_EVENTS)
+        TraceEvents.push_back(event);
+    else
+        {
+        TraceEvents[OldestTraceEvent] = event;
+        OldestTraceEvent = (OldestTraceEvent + 1) % TRACE_EVENTS;
+        ++DroppedTraceEvents;
+        }
+    }
+
+static void ClearTraceEventsLocked()
+    {
+    TraceEvents.clear();
+    OldestTraceEvent = 0;
+    DroppedTraceEvents = 0;
+    }
+
+static void WriteJSONString(FILE *file, const std::string &value)
+    {
+    fputc('"', file);
+    for(std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+        {
+        unsigned char c = (unsigned char)*it;
+        if(c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if(c < 0x20)
+            fprintf(file, "\\u%04x", c);
+        else
+            fputc(c, file);
+        }
+    fputc('"', file);
+    }
+
+bool WriteTraceEvents(const char *FileName)
+    {
+    FILE *file = fopen(FileName, "wb");
+    if(file == NULL)
+        return false;
+
+    std::lock_guard<std::mutex> lock(TraceLock);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%llu},\"traceEvents\":[", (unsigned long long)DroppedTraceEvents);
+    for(uint32_t x = 0; x < TraceEvents.size(); ++x)
+        {
+        TraceEvent &event = TraceEvents[(OldestTraceEvent + x) % TraceEvents.size()];
+        fprintf(file, "%s\n{\"name\":", x == 0 ? "" : ",");
+        WriteJSONString(file, event.name);
+        fprintf(file, ",\"cat\":\"cbash\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu,\"args\":{",
+            event.thread, (unsigned long long)event.start, (unsigned long long)event.duration);
+        fprintf(file, "\"records\":%llu,\"inflated_bytes\":%llu", (unsigned long long)event.records, (unsigned long long)event.inflated);
+        if(!event.ModName.empty())
+            {
+            fprintf(file, ",\"mod\":");
+            WriteJSONString(file, event.ModName);
+            }
+        fprintf(file, "}}");
+        }
+    fprintf(file, "\n]}\n");
+    bool IsWritten = ferror(file) == 0;
+    if(fclose(file) != 0)
+        IsWritten = false;
+    ClearTraceEventsLocked();
+    return IsWritten;
+    }
+
+void ClearTraceEvents()
+    {
+    std::lock_guard<std::mutex> lock(TraceLock);
+    ClearTraceEventsLocked();
+    }
@@ -0,0 +1,127 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#pragma once
+// Profiler.h
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+//The v120 toolset lacks thread_local, and __declspec(thread) only takes plain values
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL thread_local
+#endif
+
+#ifndef PROFILE_POINTS
+    #define PROFILE_POINTS  256
+#endif
+
+#ifndef PROFILE_BUCKETS
+    #define PROFILE_BUCKETS 32
+#endif
+
+//Checked by every probe, so that a disabled profiler costs a single load
+extern std::atomic<bool> IsProfiling;
+
+//A named place in the code that is timed. It has no constructor, so a function local one is zero initialized
+// without the thread safe statics that the v120 toolset lacks. It is registered the first time it is timed.
+struct ProfilePoint
+    {
+    std::atomic<uint32_t> id; //One more than the point's index, or zero until registered
+    };
+
+uint32_t RegisterProfilePoint(ProfilePoint &point, const char *name);
+void RecordProfileSample(const uint32_t id, const uint64_t nanoseconds);
+std::string BuildProfileReport();
+void ResetProfile();
+
+class ProfileScope
+    {
+    private:
+        uint32_t id;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        ProfileScope(ProfilePoint &point, const char *name):
+            id(0)
+            {
+            if(!IsProfiling.load(std::memory_order_relaxed))
+                return;
+            id = point.id.load(std::memory_order_acquire);
+            if(id == 0)
+                id = RegisterProfilePoint(point, name);
+            start = std::chrono::steady_clock::now();
+            }
+
+        ~ProfileScope()
+            {
+            if(id != 0)
+                RecordProfileSample(id - 1, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            }
+    };
+
+//Chrome trace events are recorded while this is set
+extern std::atomic<bool> IsTracing;
+
+//Running totals that trace spans report the change in, kept per thread
+struct TraceCounters
+    {
+    uint64_t records;
+    uint64_t inflated;
+    };
+
+TraceCounters &LocalTraceCounters();
+bool WriteTraceEvents(const char *FileName);
+void ClearTraceEvents();
+
+//A timed span on the trace timeline, labelled with an optional mod name and record type
+class TraceSpan
+    {
+    private:
+        bool IsActive;
+        const char *name;
+        const char *ModName;
+        uint32_t label;
+        uint64_t records;
+        uint64_t inflated;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        TraceSpan(const char *_name, const char *_ModName=NULL, const uint32_t _label=0);
+        ~TraceSpan();
+    };
@@ -473,6 +473,7 @@ class TES5GRUPRecords<Sk::CELLRecord, RecType, AllocUnit, IsKeyedByEditorID>
 
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             cell_pool.MakeRecordsVector(Records);
             uint32_t numCELLRecords = (uint32_t)Records.size();
@@ -834,7 +835,6 @@ class TES5GRUPRecords<Sk::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
             uint32_t numWRLD = 0, numCELL = 0, numLAND = 0, numREFR = 0, numACHR = 0/*, numREFR = 0,
                    numPGRE = 0, numPMIS = 0, numPBEA = 0, numPFLA = 0, numPCBE = 0, numNAVM = 0*/;
 
-            std::map<int32_t, std::map<int32_t, Sk::LANDRecord *> > GridXY_LAND;
             std::vector<std::pair<uint32_t, unsigned char *> > GRUPs;
             std::pair<uint32_t, unsigned char *> GRUP_End;
             GRUP_End.first = eTop;
@@ -1144,7 +1144,7 @@ class TES5GRUPRecords<Sk::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 read_parser.Accept((Record *&)last_cell_record); //may already be loaded, but just to be sure.
                                 //CELL will be unloaded if needed after a second round of indexing when all records are loaded
                                 last_cell_record->XCLC.Load(); //in-case no XCLC chunk is specified
-                                GridXY_LAND[last_cell_record->XCLC->posX][last_cell_record->XCLC->posY] = (Sk::LANDRecord *)curRecord;
+                                last_wrld_record->LANDs.Insert(last_cell_record->XCLC->posX, last_cell_record->XCLC->posY, curRecord);
                                 }
                             break;
                         case REV32(ACHR):
@@ -1419,10 +1419,10 @@ class TES5GRUPRecords<Sk::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
                                 last_land_record = (Sk::LANDRecord *)last_cell_record->LAND;
                                 if(last_land_record != NULL)
                                     {
-                                    last_land_record->NorthLand = GridXY_LAND[posX][posY + 1];
-                                    last_land_record->SouthLand = GridXY_LAND[posX][posY - 1];
-                                    last_land_record->EastLand = GridXY_LAND[posX + 1][posY];
-                                    last_land_record->WestLand = GridXY_LAND[posX - 1][posY];
+                                    last_land_record->NorthLand = (Sk::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY + 1);
+                                    last_land_record->SouthLand = (Sk::LANDRecord *)last_wrld_record->LANDs.Find(posX, posY - 1);
+                                    last_land_record->EastLand = (Sk::LANDRecord *)last_wrld_record->LANDs.Find(posX + 1, posY);
+                                    last_land_record->WestLand = (Sk::LANDRecord *)last_wrld_record->LANDs.Find(posX - 1, posY);
                                     }
                                 }
 
@@ -1529,6 +1529,7 @@ class TES5GRUPRecords<Sk::WRLDRecord, RecType, AllocUnit, IsKeyedByEditorID>
         template<typename U>
         uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod, FormIDHandlerClass &FormIDHandler, U &CELL, RecordOp &indexer)
             {
+            TRACE_SPAN("Write", NULL, RecType);
             std::vector<Record *> Records;
             wrld_pool.MakeRecordsVector(Records);
             uint32_t numWrldRecords = (uint32_t)Records.size();
@@ -2247,6 +2248,7 @@ public:
 
 	uint32_t Write(FileWriter &writer, std::vector<FormIDResolver *> &Expanders, FormIDResolver &expander, FormIDResolver &collapser, const bool &bMastersChanged, bool CloseMod)
 	{
+		TRACE_SPAN("Write", NULL, RecType);
 		std::vector<Record *> Records;
 		dial_pool.MakeRecordsVector(Records);
 		uint32_t numDIALRecords = (uint32_t)Records.size(); //Parent Records
@@ -202,6 +202,7 @@ class LANDRecord : public TES5Record //Landscape
         uint8_t   CalcQuadrant(const uint32_t &row, const uint32_t &column);
         uint16_t  CalcPosition(const uint8_t &curQuadrant, const uint32_t &row, const uint32_t &column);
         float CalcHeight(const uint32_t &row, const uint32_t &column);
+        void CalcHeights(float (&Heights)[33][33]);
 
         uint32_t  GetFieldAttribute(DEFAULTED_FIELD_IDENTIFIERS, uint32_t WhichAttribute=0);
         void *  GetField(DEFAULTED_FIELD_IDENTIFIERS, void **FieldValues=NULL);
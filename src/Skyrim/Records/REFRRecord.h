@@ -141,6 +141,11 @@ class REFRRecord : public TES5Record //Texture Set
 		REFRRecord(REFRRecord *srcRecord);
 		~REFRRecord();
 
+		uint32_t GetFieldAttribute(DEFAULTED_FIELD_IDENTIFIERS, uint32_t WhichAttribute=0);
+		void * GetField(DEFAULTED_FIELD_IDENTIFIERS, void **FieldValues=NULL);
+		bool   SetField(DEFAULTED_FIELD_IDENTIFIERS, void *FieldValue=NULL, uint32_t ArraySize=0);
+		void   DeleteField(DEFAULTED_FIELD_IDENTIFIERS);
+
 		uint32_t  GetType();
 		char *  GetStrType();
 
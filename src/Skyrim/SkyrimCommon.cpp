@@ -36,13 +36,49 @@
  * ***** END LICENSE BLOCK ***** */
 // SkyrimCommon.cpp
 #include "SkyrimCommon.h"
-
-StringLookups::StringLookups()
+#include <algorithm>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+StringLookups::StringTable::StringTable():
+    directory(NULL),
+    data(NULL),
+    count(0),
+    dataSize(0)
 {
     //
 }
 
-char * StringLookups::GetFileName(char * ModName, char * Language, typeTypes Type) const
+StringLookups::StringLookups(char * ModName):
+    loaded(false)
+{
+    char Directory[1024];
+#ifdef _WIN32
+    bool HasDirectory = _getcwd(Directory, sizeof(Directory)) != NULL;
+#else
+    bool HasDirectory = getcwd(Directory, sizeof(Directory)) != NULL;
+#endif
+    const typeTypes Types[3] = {eStrings, eDLStrings, eILStrings};
+    for(uint32_t x = 0; x < 3; ++x)
+    {
+        /* TODO: Actually generate the applicible file names */
+        // For now, we'll assume ENGLISH is the language to use
+        char * FileName = GetFileName(ModName, "English", Types[x]);
+        FileNames[x] = HasDirectory ? std::string(Directory) + "/" + FileName : FileName;
+        delete [] FileName;
+    }
+}
+
+StringLookups::~StringLookups()
+{
+    Close();
+}
+
+char * StringLookups::GetFileName(char * ModName, const char * Language, typeTypes Type)
 {
     // Assume that cwd is set to the 'Data' directory still,
     // it should have been set by Collection.AddMod
@@ -73,37 +109,24 @@ char * StringLookups::GetFileName(char * ModName, char * Language, typeTypes Typ
     return FileName;
 }
 
-bool StringLookups::Open(char * ModName)
+bool StringLookups::Open()
 {
-    if (ModName == NULL || file_map_strings.is_open())
+    if (Tables[eStrings].file_map.is_open())
         return false;
 
-    /* TODO: Actually generate the applicible file names */
-    // .STRINGS file.  For now, we'll assume ENGLISH is the language to use
-    char * StringsFileName = GetFileName(ModName, "English", eStrings);
-    char * DLStringsFileName = GetFileName(ModName, "English", eDLStrings);
-    char * ILStringsFileName = GetFileName(ModName, "English", eILStrings);
-
     try
     {
-        Open(StringsFileName, file_map_strings);
-        Open(DLStringsFileName, file_map_dlstrings);
-        Open(ILStringsFileName, file_map_ilstrings);
+        Open(&FileNames[eStrings][0], Tables[eStrings].file_map);
+        Open(&FileNames[eDLStrings][0], Tables[eDLStrings].file_map);
+        Open(&FileNames[eILStrings][0], Tables[eILStrings].file_map);
     }
     catch(...)
     {
         Close();
-        delete [] StringsFileName;
-        delete [] DLStringsFileName;
-        delete [] ILStringsFileName;
-		return false;
+        return false;
         //throw;
     }
 
-    delete [] StringsFileName;
-    delete [] DLStringsFileName;
-    delete [] ILStringsFileName;
-
     return true;
 }
 
@@ -111,7 +134,7 @@ void StringLookups::Open(char * FileName, boost::iostreams::mapped_file_source &
 {
     try
     {
-        file_map.open(FileName);
+        file_map = AcquireMapping(FileName);
     }
     catch(std::ios::failure const &ex)
     {
@@ -132,68 +155,320 @@ void StringLookups::Open(char * FileName, boost::iostreams::mapped_file_source &
 
 bool StringLookups::Close()
     {
+        std::lock_guard<std::mutex> guard(load_lock);
+        loaded.store(false);
+
         // Cases where we care about the return value,
         // all files we either be open or closed.
-        bool ret = file_map_strings.is_open();
+        bool ret = Tables[eStrings].file_map.is_open();
 
         // Documentation isn't really clear if calling
         // close() on a closed file is bad, so check
         // anyway.
         if (ret)
-            file_map_strings.close();
-        if (file_map_dlstrings.is_open())
-            file_map_dlstrings.close();
-        if (file_map_ilstrings.is_open())
-            file_map_ilstrings.close();
+            ReleaseMapping(Tables[eStrings].file_map);
+        if (Tables[eDLStrings].file_map.is_open())
+            ReleaseMapping(Tables[eDLStrings].file_map);
+        if (Tables[eILStrings].file_map.is_open())
+            ReleaseMapping(Tables[eILStrings].file_map);
 
+        for(uint32_t x = 0; x < 3; ++x)
+        {
+            Tables[x].directory = NULL;
+            Tables[x].data = NULL;
+            Tables[x].count = 0;
+            Tables[x].dataSize = 0;
+            Tables[x].sorted.clear();
+        }
         return ret;
     }
 
 void StringLookups::Load()
 {
-    Strings.clear();
-    Load(file_map_strings, eStrings);
-    Load(file_map_dlstrings, eDLStrings);
-    Load(file_map_ilstrings, eILStrings);
+    if (!Open())
+        return;
+    for(uint32_t x = 0; x < 3; ++x)
+        Index(Tables[x]);
+}
+
+// A failed open isn't retried until Close(), so that a missing file is only reported once
+void StringLookups::EnsureLoaded()
+{
+    if (loaded.load(std::memory_order_acquire))
+        return;
+    std::lock_guard<std::mutex> guard(load_lock);
+    if (loaded.load(std::memory_order_relaxed))
+        return;
+    Load();
+    loaded.store(true, std::memory_order_release);
+}
+
+void StringLookups::Index(StringTable &Table)
+{
+    const uint8_t *buffer = reinterpret_cast<const uint8_t *>(Table.file_map.data());
+    const uint64_t size = Table.file_map.size();
+    if (size < 8)
+        return;
+
+    uint32_t stringCount = *reinterpret_cast<const uint32_t *>(buffer);
+    uint32_t dataSize = *reinterpret_cast<const uint32_t *>(buffer + 4);
+    if (8 + (uint64_t)stringCount * 8 + dataSize > size)
+    {
+        printer("StringLookups: Error - The string table is truncated. Its strings will not be used.\n");
+        return;
+    }
+    Table.directory = buffer + 8;
+    Table.data = Table.directory + (stringCount * 8);
+    Table.count = stringCount;
+    Table.dataSize = dataSize;
+
+    // The directory is normally sorted by id, so it can be searched in place
+    for(uint32_t i = 1; i < stringCount; ++i)
+    {
+        if (*reinterpret_cast<const uint32_t *>(Table.directory + i * 8) < *reinterpret_cast<const uint32_t *>(Table.directory + (i - 1) * 8))
+        {
+            Table.sorted.resize(stringCount);
+            for(uint32_t j = 0; j < stringCount; ++j)
+            {
+                const uint32_t *entry = reinterpret_cast<const uint32_t *>(Table.directory + j * 8);
+                Table.sorted[j] = std::make_pair(entry[0], entry[1]);
+            }
+            std::sort(Table.sorted.begin(), Table.sorted.end());
+            break;
+        }
+    }
+}
+
+char * StringLookups::Lookup(const StringTable &Table, typeTypes Type, uint32_t Id) const
+{
+    uint32_t offset = 0;
+    bool found = false;
+    if (!Table.sorted.empty())
+    {
+        std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = std::lower_bound(Table.sorted.begin(), Table.sorted.end(), std::make_pair(Id, (uint32_t)0));
+        found = it != Table.sorted.end() && it->first == Id;
+        if (found)
+            offset = it->second;
+    }
+    else
+    {
+        uint32_t low = 0, high = Table.count;
+        while(low < high)
+        {
+            uint32_t middle = low + (high - low) / 2;
+            const uint32_t *entry = reinterpret_cast<const uint32_t *>(Table.directory + middle * 8);
+            if (entry[0] < Id)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        const uint32_t *entry = reinterpret_cast<const uint32_t *>(Table.directory + low * 8);
+        found = low < Table.count && entry[0] == Id;
+        if (found)
+            offset = entry[1];
+    }
+    if (!found)
+        return NULL;
+
+    // .DLSTRINGS and .ILSTRINGS entries are prefixed by their length
+    uint64_t start = (uint64_t)offset + (Type == eStrings ? 0 : 4);
+    if (start >= Table.dataSize || memchr(Table.data + start, 0, Table.dataSize - (uint32_t)start) == NULL)
+        return NULL;
+    return const_cast<char *>(reinterpret_cast<const char *>(Table.data + start));
+}
+
+char * StringLookups::Lookup(uint32_t Id)
+{
+    EnsureLoaded();
+    for(uint32_t x = 0; x < 3; ++x)
+    {
+        char * value = Lookup(Tables[x], (typeTypes)x, Id);
+        if (value != NULL)
+            return value;
+    }
+    return NULL;
+}
+
+StringTableWriter::StringTableWriter():
+    NextId(1)
+{
+    //
 }
 
-void StringLookups::Load(boost::iostreams::mapped_file_source &file_map, typeTypes Type)
+StringTableWriter::~StringTableWriter()
 {
-    uint8_t *buffer, *dataBegin;
-    buffer = const_cast<uint8_t *>(reinterpret_cast<const uint8_t *>(file_map.data()));
+    //
+}
 
-    uint32_t stringCount = *reinterpret_cast<uint32_t *>(buffer);
-    buffer += 8; // 4 for stringCount, 4 for dataSize (skipped)
+StringLookups::typeTypes StringTableWriter::GetType(uint32_t _Type)
+{
+    switch(_Type)
+    {
+    case REV32(DESC):
+    case REV32(CNAM):
+        return StringLookups::eDLStrings;
+    case REV32(NAM1):
+        return StringLookups::eILStrings;
+    default:
+        return StringLookups::eStrings;
+    }
+}
 
-    dataBegin = buffer + (stringCount * 8) + (Type == 0 ? 0 : 4);    
+// Returns false if the existing string files couldn't be read
+bool StringTableWriter::Seed(StringLookups &Lookups)
+{
+    // Records that aren't rewritten still refer to the old ids, so every
+    // existing string is kept under its id
+    Lookups.EnsureLoaded();
+    if (!Lookups.Tables[StringLookups::eStrings].file_map.is_open())
+        return false;
+    for(uint32_t x = 0; x < 3; ++x)
+    {
+        const StringLookups::StringTable &Source = Lookups.Tables[x];
+        const uint32_t prefix = x == StringLookups::eStrings ? 0 : 4;
+        for(uint32_t i = 0; i < Source.count; ++i)
+        {
+            const uint32_t *entry = reinterpret_cast<const uint32_t *>(Source.directory + i * 8);
+            uint64_t start = (uint64_t)entry[1] + prefix;
+            if (start >= Source.dataSize || memchr(Source.data + start, 0, Source.dataSize - (uint32_t)start) == NULL)
+                continue;
+            const char *value = reinterpret_cast<const char *>(Source.data + start);
+
+            StringTable &Table = Tables[x];
+            boost::unordered_map<std::string, std::pair<uint32_t, uint32_t> >::iterator it = Table.strings.find(value);
+            uint32_t offset = it != Table.strings.end() ? it->second.second : Append(Table, (StringLookups::typeTypes)x, value);
+            if (it == Table.strings.end())
+                Table.strings.insert(std::make_pair(std::string(value), std::make_pair(entry[0], offset)));
+            Table.directory.push_back(std::make_pair(entry[0], offset));
+            if (entry[0] >= NextId)
+                NextId = entry[0] + 1;
+        }
+    }
+    return true;
+}
+
+uint32_t StringTableWriter::Append(StringTable &Table, StringLookups::typeTypes Type, const char * value)
+{
+    uint32_t offset = static_cast<uint32_t>(Table.data.size());
+    uint32_t size = static_cast<uint32_t>(strlen(value)) + 1;
+    // .DLSTRINGS and .ILSTRINGS entries are prefixed by their length
+    if (Type != StringLookups::eStrings)
+        Table.data.insert(Table.data.end(), reinterpret_cast<const char *>(&size), reinterpret_cast<const char *>(&size) + 4);
+    Table.data.insert(Table.data.end(), value, value + size);
+    return offset;
+}
+
+uint32_t StringTableWriter::Add(uint32_t _Type, const char * value)
+{
+    // Id 0 is the empty string
+    if (value == NULL || value[0] == 0x00)
+        return 0;
+
+    StringLookups::typeTypes Type = GetType(_Type);
+    StringTable &Table = Tables[Type];
+    std::pair<boost::unordered_map<std::string, std::pair<uint32_t, uint32_t> >::iterator, bool> it = Table.strings.insert(std::make_pair(std::string(value), std::make_pair(NextId, (uint32_t)0)));
+    if (!it.second)
+        return it.first->second.first;
+
+    it.first->second.second = Append(Table, Type, value);
+    Table.directory.push_back(it.first->second);
+    return NextId++;
+}
+
+// Each file is written to a temporary file, and a rename into place is added to ops,
+// so that the caller can replace them together with the plugin
+bool StringTableWriter::Write(char * ModName, std::vector<RenameOp *> &ops)
+{
+#ifdef _WIN32
+    _mkdir("Strings");
+#else
+    mkdir("Strings", 0777);
+#endif
+    const StringLookups::typeTypes Types[3] = {StringLookups::eStrings, StringLookups::eDLStrings, StringLookups::eILStrings};
+    for(uint32_t x = 0; x < 3; ++x)
+    {
+        char * FileName = StringLookups::GetFileName(ModName, "English", Types[x]);
+        FileNames[x] = FileName;
+        delete [] FileName;
+        char * temp_name = WriteTemporary(&FileNames[x][0], Tables[x]); //deleted when RenameOp is destroyed
+        if (temp_name == NULL)
+            return false;
+        ops.push_back(new RenameOp(temp_name, &FileNames[x][0]));
+    }
+    return true;
+}
 
-    for(uint32_t i = 0; i < stringCount; ++i)
+char * StringTableWriter::WriteTemporary(char * FileName, StringTable &Table)
+{
+    // Seeded ids come first in their old order, so they may need sorting
+    for(uint32_t i = 1; i < Table.directory.size(); ++i)
     {
-        uint32_t id = *reinterpret_cast<uint32_t *>(buffer);
-        uint32_t offset = *reinterpret_cast<uint32_t *>(buffer);
+        if (Table.directory[i].first < Table.directory[i - 1].first)
+        {
+            std::sort(Table.directory.begin(), Table.directory.end());
+            break;
+        }
+    }
+
+    char * temp_name = GetTemporaryFileName(FileName);
+    if (temp_name == NULL)
+        return NULL;
 
-        char * value = reinterpret_cast<char *>(dataBegin + offset);
-        Strings[id] = value;
+    FILE *file = fopen(temp_name, "wb");
+    if (file == NULL)
+    {
+        printer("StringTableWriter: Error - Unable to open \"%s\" for writing.\n", temp_name);
+        delete [] temp_name;
+        return NULL;
     }
+    uint32_t header[2] = {static_cast<uint32_t>(Table.directory.size()), static_cast<uint32_t>(Table.data.size())};
+    fwrite(header, sizeof(header), 1, file);
+    if (!Table.directory.empty())
+    {
+        std::vector<uint32_t> directory(Table.directory.size() * 2);
+        for(uint32_t i = 0; i < Table.directory.size(); ++i)
+        {
+            directory[i * 2] = Table.directory[i].first;
+            directory[i * 2 + 1] = Table.directory[i].second;
+        }
+        fwrite(&directory[0], sizeof(uint32_t), directory.size(), file);
+    }
+    if (!Table.data.empty())
+        fwrite(&Table.data[0], 1, Table.data.size(), file);
+    bool written = ferror(file) == 0;
+    written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        printer("StringTableWriter: Error - Unable to write \"%s\".\n", temp_name);
+        remove(temp_name);
+        delete [] temp_name;
+        return NULL;
+    }
+    return temp_name;
 }
 
 LStringRecord::LStringRecord()
-    : value(NULL),
-      IsOnDisk(false)
+    : IsOnDisk(false),
+      value(NULL),
+      Id(0)
 {
     //
 }
 
 LStringRecord::LStringRecord(const LStringRecord &p)
-    : value(NULL),
-      IsOnDisk(false)
+    : IsOnDisk(false),
+      value(NULL),
+      Id(0)
 {
     if (!p.IsLoaded())
         return;
 
     if (p.IsOnDisk)
     {
+        // Ids belong to the plugin's own string files, so a copy keeps one only if
+        // it has no text to be given a new id from
         value = p.value;
+        Id = p.value == NULL ? p.Id : 0;
         IsOnDisk = true;
     }
     else
@@ -217,7 +492,7 @@ uint32_t LStringRecord::GetSize() const
 
 bool LStringRecord::IsLoaded() const
 {
-    return value != NULL;
+    return value != NULL || Id != 0;
 }
 
 void LStringRecord::Load()
@@ -231,6 +506,7 @@ void LStringRecord::Unload()
     {
         delete [] value;
         value = NULL;
+        Id = 0;
     }
 }
 
@@ -243,8 +519,9 @@ bool LStringRecord::Read(unsigned char *&buffer, const uint32_t &subSize, const
     }
     if (LookupStrings != NULL)
     {
-        uint32_t Id = *reinterpret_cast<uint32_t *>(buffer);
-        value = LookupStrings->Strings[Id];
+        // The id is kept even if the lookup misses, so that it isn't lost on save
+        Id = *reinterpret_cast<uint32_t *>(buffer);
+        value = LookupStrings->Lookup(Id);
         IsOnDisk = true;
     }
     else
@@ -264,18 +541,47 @@ bool LStringRecord::Read(unsigned char *&buffer, const uint32_t &subSize, const
     return true;
 }
 
+// With the string files being written, any text gets an id in them. Without, only the id
+// that was read can be written, and a string that was changed has none.
+uint32_t LStringRecord::GetWriteId(uint32_t _Type, FileWriter &writer) const
+{
+    if (value != NULL && writer.string_tables != NULL)
+        return writer.string_tables->Add(_Type, value);
+    // A string that wasn't found in the string files keeps its id
+    if (Id == 0)
+        ++writer.missing_strings;
+    return Id;
+}
+
 void LStringRecord::Write(uint32_t _Type, FileWriter &writer)
 {
-    if (value != NULL)
+    if (!IsLoaded())
+        return;
+    if (writer.localized_strings)
+    {
+        uint32_t StringId = GetWriteId(_Type, writer);
+        writer.record_write_subrecord(_Type, &StringId, 4);
+    }
+    else if (value != NULL)
         writer.record_write_subrecord(_Type, value, static_cast<uint32_t>(strlen(value)) + 1);
+    else
+        // Only an id, copied from a localized plugin
+        ++writer.missing_strings;
 }
 
 void LStringRecord::ReqWrite(uint32_t _Type, FileWriter &writer)
 {
-    if (value != NULL)
+    if (writer.localized_strings)
+    {
+        uint32_t StringId = IsLoaded() ? GetWriteId(_Type, writer) : 0;
+        writer.record_write_subrecord(_Type, &StringId, 4);
+    }
+    else if (value != NULL)
         writer.record_write_subrecord(_Type, value, static_cast<uint32_t>(strlen(value)) + 1);
     else
     {
+        if (Id != 0)
+            ++writer.missing_strings;
         uint8_t null = 0x00;
         writer.record_write_subrecord(_Type, &null, 1);
     }
@@ -284,6 +590,7 @@ void LStringRecord::ReqWrite(uint32_t _Type, FileWriter &writer)
 void LStringRecord::Copy(char * FieldValue)
 {
     Unload();
+    Id = 0;
     if (FieldValue != NULL)
     {
         IsOnDisk = false;
@@ -296,6 +603,7 @@ void LStringRecord::Copy(char * FieldValue)
 void LStringRecord::TruncateCopy(char * FieldValue, uint32_t MaxSize)
 {
     Unload();
+    Id = 0;
     if (FieldValue != NULL)
     {
         IsOnDisk = false;
@@ -308,13 +616,18 @@ void LStringRecord::TruncateCopy(char * FieldValue, uint32_t MaxSize)
     }
 }
 
+// Strings that weren't found are compared by id
 bool LStringRecord::equals(const LStringRecord &other) const
 {
+    if (value == NULL || other.value == NULL)
+        return value == other.value && Id == other.Id;
     return cmps(value, other.value) == 0;
 }
 
 bool LStringRecord::equalsi(const LStringRecord &other) const
 {
+    if (value == NULL || other.value == NULL)
+        return value == other.value && Id == other.Id;
     return icmps(value, other.value) == 0;
 }
 
@@ -323,9 +636,11 @@ LStringRecord& LStringRecord::operator = (const LStringRecord &rhs)
     if (this != &rhs)
     {
         Unload();
+        Id = 0;
         if(rhs.IsOnDisk)
         {
             value = rhs.value;
+            Id = rhs.value == NULL ? rhs.Id : 0;
             IsOnDisk = true;
         }
         else if (rhs.value != NULL)
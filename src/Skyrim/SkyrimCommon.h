@@ -39,7 +39,12 @@
 
 #include "../Common.h"
 #include "VMAD/VMAD.h"
+#include <boost/unordered_map.hpp>
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <string>
+#include <vector>
 
 
 class StringLookups
@@ -52,30 +57,82 @@ class StringLookups
             eILStrings = 2,     // .ILSTRINGS file
         };
 
-        typedef std::map<uint32_t,char *> MapType;
-
     private:
-        boost::iostreams::mapped_file_source file_map_strings;
-        boost::iostreams::mapped_file_source file_map_dlstrings;
-        boost::iostreams::mapped_file_source file_map_ilstrings;
-
+        /* Strings are served straight from the mapped files. Each file is a
+           count, the data size, a directory of (id, offset) pairs, and then
+           the string data. */
+        struct StringTable
+            {
+            boost::iostreams::mapped_file_source file_map;
+            const uint8_t *directory;
+            const uint8_t *data;
+            uint32_t count;
+            uint32_t dataSize;
+            //Only built if the directory isn't sorted by id
+            std::vector<std::pair<uint32_t, uint32_t> > sorted;
+
+            StringTable();
+            };
+
+        std::string FileNames[3];
+        StringTable Tables[3];
+        //Set once the first lookup has opened the files, and cleared by Close()
+        std::atomic<bool> loaded;
+        std::mutex load_lock;
+
+        void EnsureLoaded();
         void Open(char * FileName, boost::iostreams::mapped_file_source &file_map);
-        void Load(boost::iostreams::mapped_file_source &file_map, typeTypes Type);
+        void Index(StringTable &Table);
+        char * Lookup(const StringTable &Table, typeTypes Type, uint32_t Id) const;
 
-        char * GetFileName(char * ModName, char * Language, typeTypes Type) const;
+        friend class StringTableWriter;
 
     public:
-        /* For now we'll merge everything into one map, for speed an memory
-           saving.  When writing these files becomes necessary, we'll need to
-           provide a way to distinguish their source files. */
-        MapType Strings;
+        /* The files are only opened by the first lookup, since many records
+           are never read. The names are resolved against the current
+           directory now, as it may have changed by then. */
+        StringLookups(char * ModName);
+        ~StringLookups();
 
-        StringLookups();
-
-        bool Open(char * ModName);
+        bool Open();
         bool Close();
 
         void Load();
+        char * Lookup(uint32_t Id);
+
+        static char * GetFileName(char * ModName, const char * Language, typeTypes Type);
+    };
+
+/* Builds the string files of a localized plugin while it is saved. Equal
+   strings in the same file share an id, and new ids and data offsets are
+   handed out in order, so each file is written with a single pass. */
+class StringTableWriter
+    {
+    private:
+        struct StringTable
+            {
+            //Maps each string to its id and data offset
+            boost::unordered_map<std::string, std::pair<uint32_t, uint32_t> > strings;
+            std::vector<std::pair<uint32_t, uint32_t> > directory;
+            std::vector<char> data;
+            };
+
+        StringTable Tables[3];
+        std::string FileNames[3];
+        uint32_t NextId;
+
+        uint32_t Append(StringTable &Table, StringLookups::typeTypes Type, const char * value);
+        char * WriteTemporary(char * FileName, StringTable &Table);
+
+    public:
+        StringTableWriter();
+        ~StringTableWriter();
+
+        static StringLookups::typeTypes GetType(uint32_t _Type);
+
+        bool Seed(StringLookups &Lookups);
+        uint32_t Add(uint32_t _Type, const char * value);
+        bool Write(char * ModName, std::vector<RenameOp *> &ops);
     };
 
 class LStringRecord
@@ -83,8 +140,13 @@ class LStringRecord
     private:
         bool IsOnDisk;
 
+        uint32_t GetWriteId(uint32_t _Type, FileWriter &writer) const;
+
     public:
         char * value;
+        //The id read from a localized plugin, kept so that it can be written back even if
+        // the string isn't in the loose string files, as when they ship in a BSA. 0 once changed.
+        uint32_t Id;
 
         LStringRecord();
         LStringRecord(const LStringRecord &p);
@@ -230,7 +230,8 @@ int32_t TES5File::Load(RecordOp &read_parser, RecordOp &indexer, std::vector<For
         }
 
     // Load translation strings
-    //TES4.LoadStringLookups(FileName);
+    if(TES4.IsLookupStrings())
+        TES4.LoadStringLookups(ModName);
 
     Flags.LoadedGRUPs = true;
     unsigned char *group_buffer_end = NULL;
@@ -245,12 +246,16 @@ int32_t TES5File::Load(RecordOp &read_parser, RecordOp &indexer, std::vector<For
     processor.SetFilter(filter_inclusive, filter_records, filter_wspaces);
 
     while(buffer_position < buffer_end){
+        if(!ContinueLoad())
+            break;
+        PROFILE_SCOPE("GRUP scan");
         buffer_position += 4; //Skip "GRUP"
         GRUPSize = *(uint32_t *)buffer_position;
         group_buffer_end = buffer_position + GRUPSize - 4;
         buffer_position += 4;
         GRUPLabel = *(uint32_t *)buffer_position;
         buffer_position += 8; //Skip type (tops will all == 0)
+        TRACE_SPAN("GRUP", ModName, GRUPLabel);
 
         //printer("%c%c%c%c\n", ((char *)&GRUPLabel)[0], ((char *)&GRUPLabel)[1], ((char *)&GRUPLabel)[2], ((char *)&GRUPLabel)[3]);
         switch(GRUPLabel)
@@ -1748,6 +1753,9 @@ int32_t TES5File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
         }
         */
 
+        //Keep the worldspace's grid index from pointing at the deleted LAND
+        if (cell_record->LAND != NULL && cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+            ((Sk::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(cell_record->LAND);
         deindexer.Accept(cell_record->LAND);
         WRLD.land_pool.destroy(cell_record->LAND);
 
@@ -1978,6 +1986,8 @@ int32_t TES5File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
         }
 
         cell_record->LAND = NULL;
+        if (cell_record->GetParentRecord() != NULL && cell_record->GetParentRecord()->GetType() == REV32(WRLD))
+            ((Sk::WRLDRecord *)cell_record->GetParentRecord())->LANDs.Erase(curRecord);
         deindexer.Accept(curRecord);
         WRLD.land_pool.destroy(curRecord);
     }
@@ -2385,7 +2395,7 @@ int32_t TES5File::DeleteRecord(Record *&curRecord, RecordOp &deindexer)
     return 0;
     }
 
-int32_t TES5File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer)
+int32_t TES5File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Expanders, bool CloseMod, RecordOp &indexer, StringTableWriter *Strings)
     {
     if(!Flags.IsSaveable)
         {
@@ -2393,6 +2403,17 @@ int32_t TES5File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Ex
         return -1;
         }
 
+    //Plugins are saved in the form they were read in, so the string files are only written for localized plugins
+    const bool bLocalized = TES4.IsLookupStrings();
+    if(!bLocalized)
+        Strings = NULL;
+    //New files would hide any string files that ship in a BSA
+    if(Strings != NULL && TES4.LookupStrings != NULL && !Strings->Seed(*TES4.LookupStrings) && !Flags.IsCreateNew)
+        {
+        printer("TES5File::Save: Error - Unable to save the string files of mod \"%s\". Its existing string files couldn't be read.\n", ModName);
+        return -1;
+        }
+
     FileWriter writer(SaveName, BUFFERSIZE);
     if(writer.open() == -1)
         throw std::runtime_error("TES5File::Save: Error - Unable to open temporary file for writing\n");
@@ -2403,6 +2424,9 @@ int32_t TES5File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Ex
     //RecordReader reader(FormIDHandler);
     const bool bMastersChanged = FormIDHandler.MastersChanged();
 
+    writer.localized_strings = bLocalized;
+    writer.string_tables = Strings;
+
     TES4.Write(writer, bMastersChanged, expander, collapser, Expanders);
 
     //ADD DEFINITIONS HERE, but Write in the same Top GRUP order as Skyrim.esm
@@ -2529,6 +2553,12 @@ int32_t TES5File::Save(char * const &SaveName, std::vector<FormIDResolver *> &Ex
     writer.file_write(34, &formCount, 4);
     writer.close();
 
+    if(writer.missing_strings != 0)
+        {
+        printer("TES5File::Save: Error - Unable to save mod \"%s\". %u of its localized strings couldn't be written. They were changed or added without fIsWriteStrings, or copied from another mod.\n", ModName, writer.missing_strings);
+        return -1;
+        }
+
     return 0;
     }
 
@@ -0,0 +1,485 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+// Snapshot.cpp
+#include "Snapshot.h"
+#include "Collection.h"
+#include <algorithm>
+#include <boost/crc.hpp>
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
+class SnapshotRecordCollector : public RecordOp
+    {
+    public:
+        std::vector<Record *> &records;
+
+        SnapshotRecordCollector(std::vector<Record *> &_records):
+            RecordOp(),
+            records(_records)
+            {
+            //
+            }
+
+        bool Accept(Record *&curRecord)
+            {
+            //The header record is described by the mod entry instead
+            if(curRecord->GetType() != REV32(TES4))
+                records.push_back(curRecord);
+            return false;
+            }
+    };
+
+struct SnapshotRecordLess
+    {
+    bool operator()(const SnapshotRecord &lhs, const SnapshotRecord &rhs) const
+        {
+        if(lhs.FormID != rhs.FormID)
+            return lhs.FormID < rhs.FormID;
+        return lhs.ModIndex < rhs.ModIndex;
+        }
+    bool operator()(const SnapshotRecord &lhs, const FORMID &rhs) const
+        {
+        return lhs.FormID < rhs;
+        }
+    bool operator()(const FORMID &lhs, const SnapshotRecord &rhs) const
+        {
+        return lhs < rhs.FormID;
+        }
+    };
+
+struct SnapshotEditorIDLess
+    {
+    const char *Strings;
+
+    SnapshotEditorIDLess(const char *_Strings):
+        Strings(_Strings)
+        {
+        //
+        }
+
+    bool operator()(const SnapshotEditorID &lhs, const SnapshotEditorID &rhs) const
+        {
+        return icmps(Strings + lhs.EditorID, Strings + rhs.EditorID) < 0;
+        }
+    bool operator()(const SnapshotEditorID &lhs, const char *rhs) const
+        {
+        return icmps(Strings + lhs.EditorID, rhs) < 0;
+        }
+    bool operator()(const char *lhs, const SnapshotEditorID &rhs) const
+        {
+        return icmps(lhs, Strings + rhs.EditorID) < 0;
+        }
+    };
+
+static uint32_t AddSnapshotString(std::vector<char> &Strings, const char *String)
+    {
+    uint32_t Offset = (uint32_t)Strings.size();
+    Strings.insert(Strings.end(), String, String + strlen(String) + 1);
+    return Offset;
+    }
+
+//ModTime is in nanoseconds, since stat only gives whole seconds on some platforms
+static bool StatPlugin(const char *FileName, uint64_t &FileSize, int64_t &ModTime)
+    {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if(!GetFileAttributesExA(FileName, GetFileExInfoStandard, &attributes) || (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return false;
+    FileSize = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+    //In 100 nanosecond intervals
+    ModTime = (int64_t)(((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime) * 100;
+#else
+    struct stat statBuffer;
+    if(stat(FileName, &statBuffer) < 0 || !(statBuffer.st_mode & S_IFREG))
+        return false;
+    FileSize = (uint64_t)statBuffer.st_size;
+    #ifdef __APPLE__
+        ModTime = (int64_t)statBuffer.st_mtimespec.tv_sec * 1000000000 + statBuffer.st_mtimespec.tv_nsec;
+    #else
+        ModTime = (int64_t)statBuffer.st_mtim.tv_sec * 1000000000 + statBuffer.st_mtim.tv_nsec;
+    #endif
+#endif
+    return true;
+    }
+
+//The header record holds the masters, the record count and the next object id,
+// so it changes with almost any edit even when the size and time are kept
+static uint32_t HashPluginHeader(const char *FileName, const uint32_t CollectionType)
+    {
+    const uint32_t headerSize = CollectionType == eIsOblivion ? 20 : 24;
+    FILE *file = fopen(FileName, "rb");
+    if(file == NULL)
+        return 0;
+    std::vector<unsigned char> buffer(headerSize);
+    uint32_t dataSize = 0;
+    if(fread(&buffer[0], 1, headerSize, file) == headerSize)
+        {
+        dataSize = *(uint32_t *)&buffer[4];
+        //A valid TES4 record is small, so anything bigger is hashed as far as the cap
+        if(dataSize > 0x100000)
+            dataSize = 0x100000;
+        buffer.resize(headerSize + dataSize);
+        if(dataSize != 0)
+            buffer.resize(headerSize + fread(&buffer[headerSize], 1, dataSize, file));
+        }
+    else
+        buffer.clear();
+    fclose(file);
+    boost::crc_32_type crc;
+    if(!buffer.empty())
+        crc.process_bytes(&buffer[0], buffer.size());
+    return crc.checksum();
+    }
+
+Snapshot::Snapshot():
+    Header(NULL),
+    Mods(NULL),
+    Records(NULL),
+    EditorIDs(NULL),
+    Strings(NULL),
+    IsRebuilt(false)
+    {
+    //
+    }
+
+Snapshot::~Snapshot()
+    {
+    if(file_map.is_open())
+        file_map.close();
+    }
+
+bool Snapshot::Open(char * const FileName)
+    {
+    PROFILE_FUNC
+
+    struct stat statBuffer;
+    if(stat(FileName, &statBuffer) < 0 || statBuffer.st_size < (off_t)sizeof(SnapshotHeader))
+        return false;
+    try
+        {
+        file_map.open(FileName);
+        }
+    catch(std::exception &ex)
+        {
+        log_warning << "Snapshot: Warning - Unable to open \"" << FileName << "\" via memory mapping: " << ex.what() << "\n";
+        return false;
+        }
+
+    //Everything is checked up front, so that queries can trust the offsets
+    const char *start = file_map.data();
+    const uint64_t size = file_map.size();
+    const SnapshotHeader *header = (const SnapshotHeader *)start;
+    if(memcmp(header->Magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+       header->Version != SNAPSHOT_VERSION ||
+       header->FileSize != size ||
+       header->ModsOffset + (uint64_t)header->NumMods * sizeof(SnapshotMod) > size ||
+       header->RecordsOffset + (uint64_t)header->NumRecords * sizeof(SnapshotRecord) > size ||
+       header->EditorIDsOffset + (uint64_t)header->NumEditorIDs * sizeof(SnapshotEditorID) > size ||
+       header->StringsSize == 0 ||
+       header->StringsOffset + (uint64_t)header->StringsSize > size ||
+       start[header->StringsOffset + header->StringsSize - 1] != 0)
+        {
+        log_info << "Snapshot: \"" << FileName << "\" isn't a valid snapshot for this version of CBash.\n";
+        file_map.close();
+        return false;
+        }
+
+    Header = header;
+    Mods = (const SnapshotMod *)(start + header->ModsOffset);
+    Records = (const SnapshotRecord *)(start + header->RecordsOffset);
+    EditorIDs = (const SnapshotEditorID *)(start + header->EditorIDsOffset);
+    Strings = start + header->StringsOffset;
+    return true;
+    }
+
+bool Snapshot::IsCurrent(Collection *CollectionID)
+    {
+    PROFILE_FUNC
+
+    if(Header->CollectionType != (uint32_t)CollectionID->CollectionType)
+        return false;
+    //Masters added while loading come after the mods added by the caller
+    if(Header->NumMods < CollectionID->ModFiles.size())
+        return false;
+    for(uint32_t p = 0; p < CollectionID->ModFiles.size(); ++p)
+        {
+        ModFile *curModFile = CollectionID->ModFiles[p];
+        if(icmps(GetString(Mods[p].FileName), curModFile->FileName) != 0 ||
+           Mods[p].Flags != curModFile->Flags.GetFlags())
+            return false;
+        }
+
+#ifdef _WIN32
+    _chdir(CollectionID->ModsDir);
+#else
+    chdir(CollectionID->ModsDir);
+#endif
+    for(uint32_t p = 0; p < Header->NumMods; ++p)
+        {
+        const SnapshotMod &mod = Mods[p];
+        uint64_t FileSize = 0;
+        int64_t ModTime = 0;
+        bool IsPresent = StatPlugin(GetString(mod.FileName), FileSize, ModTime);
+        if(IsPresent != (mod.IsPresent != 0) || FileSize != mod.FileSize || ModTime != mod.ModTime ||
+           (IsPresent && HashPluginHeader(GetString(mod.FileName), Header->CollectionType) != mod.HeaderCRC))
+            {
+            log_info << "Snapshot: \"" << GetString(mod.FileName) << "\" has changed since the snapshot was saved.\n";
+            return false;
+            }
+        }
+    return true;
+    }
+
+const char * Snapshot::GetString(const uint32_t Offset) const
+    {
+    return Offset < Header->StringsSize ? Strings + Offset : "";
+    }
+
+uint32_t Snapshot::FindRecords(const FORMID FormID, const SnapshotRecord *&First) const
+    {
+    std::pair<const SnapshotRecord *, const SnapshotRecord *> range = std::equal_range(Records, Records + Header->NumRecords, FormID, SnapshotRecordLess());
+    First = range.first;
+    return (uint32_t)(range.second - range.first);
+    }
+
+uint32_t Snapshot::FindEditorIDs(char * const EditorID, const SnapshotEditorID *&First) const
+    {
+    std::pair<const SnapshotEditorID *, const SnapshotEditorID *> range = std::equal_range(EditorIDs, EditorIDs + Header->NumEditorIDs, (const char *)EditorID, SnapshotEditorIDLess(Strings));
+    First = range.first;
+    return (uint32_t)(range.second - range.first);
+    }
+
+void Snapshot::GetModInfo(const uint32_t ModIndex, SnapshotModInfo &Info) const
+    {
+    const SnapshotMod &mod = Mods[ModIndex];
+    Info.FileName = GetString(mod.FileName);
+    Info.ModName = GetString(mod.ModName);
+    Info.Flags = mod.Flags;
+    Info.IsPresent = mod.IsPresent != 0;
+    Info.ExpandedIndex = mod.ExpandedIndex;
+    Info.CollapsedIndex = mod.CollapsedIndex;
+    Info.ExpandTable = &mod.ExpandTable[0];
+    Info.CollapseTable = &mod.CollapseTable[0];
+    }
+
+void Snapshot::GetRecordInfo(const SnapshotRecord &Entry, SnapshotRecordInfo &Info) const
+    {
+    Info.FormID = Entry.FormID;
+    Info.Type = Entry.Type;
+    Info.Flags = Entry.Flags;
+    Info.ModIndex = Entry.ModIndex;
+    Info.Offset = Entry.Offset;
+    Info.Size = Entry.Size;
+    Info.ParentFormID = Entry.ParentFormID;
+    Info.EditorID = Entry.EditorID != 0 ? GetString(Entry.EditorID) : NULL;
+    Info.IsWinning = Entry.IsWinning != 0;
+    }
+
+//The snapshot doesn't hold record objects, so the collection is loaded the first time one is asked for
+Record * Snapshot::GetRecord(Collection *CollectionID, const SnapshotRecordInfo &Info) const
+    {
+    PROFILE_FUNC
+
+    if((uint32_t)CollectionID->CollectionType != Header->CollectionType)
+        throw std::runtime_error("Unable to get the record. The snapshot is of a different type of collection.");
+    if(Info.ModIndex >= Header->NumMods)
+        throw Ex_INVALIDINDEX();
+    if(!CollectionID->IsLoaded)
+        {
+        if(CollectionID->Monitor != NULL)
+            throw std::runtime_error("Unable to get the record. The collection is being loaded by a load task.");
+        if(CollectionID->Load(NULL) != 0)
+            return NULL;
+        }
+    if(Info.ModIndex >= CollectionID->ModFiles.size() || icmps(GetString(Mods[Info.ModIndex].FileName), CollectionID->ModFiles[Info.ModIndex]->FileName) != 0)
+        throw std::runtime_error("Unable to get the record. The collection doesn't match the snapshot.");
+
+    ModFile *curModFile = CollectionID->ModFiles[Info.ModIndex];
+    Record *curRecord = NULL;
+    CollectionID->LookupRecord(curModFile, Info.FormID, curRecord);
+    return curRecord;
+    }
+
+bool Snapshot::Save(Collection *CollectionID, char * const FileName)
+    {
+    PROFILE_FUNC
+    TRACE_SPAN("Save snapshot");
+
+    if(!CollectionID->IsLoaded)
+        throw std::runtime_error("Unable to save a snapshot of the collection. It hasn't been loaded.");
+
+    //Offset 0 is reserved for records without an editor id
+    std::vector<char> strings(1, 0);
+    std::vector<SnapshotMod> mods(CollectionID->ModFiles.size());
+    std::vector<SnapshotRecord> records;
+    std::vector<SnapshotEditorID> editorIDs;
+
+    boost::unordered_map<Record *, char *> recordEditorIDs;
+    for(EditorID_Iterator it = CollectionID->EDIDIndex.begin(); it != CollectionID->EDIDIndex.end(); ++it)
+        recordEditorIDs[it->second] = it->first;
+
+#ifdef _WIN32
+    _chdir(CollectionID->ModsDir);
+#else
+    chdir(CollectionID->ModsDir);
+#endif
+    //The record size sits before the flags, formID and version control info in the record header
+    const int32_t sizeDistance = CollectionID->CollectionType == eIsOblivion ? 16 : 20;
+    std::vector<Record *> modRecords;
+    for(uint32_t p = 0; p < CollectionID->ModFiles.size(); ++p)
+        {
+        ModFile *curModFile = CollectionID->ModFiles[p];
+        SnapshotMod &mod = mods[p];
+        memset(&mod, 0, sizeof(SnapshotMod));
+        mod.FileName = AddSnapshotString(strings, curModFile->FileName);
+        mod.ModName = AddSnapshotString(strings, curModFile->ModName);
+        mod.Flags = curModFile->Flags.GetFlags();
+        mod.IsPresent = StatPlugin(curModFile->FileName, mod.FileSize, mod.ModTime) ? 1 : 0;
+        mod.HeaderCRC = mod.IsPresent ? HashPluginHeader(curModFile->FileName, CollectionID->CollectionType) : 0;
+        memcpy(&mod.ExpandTable[0], &curModFile->FormIDHandler.ExpandTable[0], sizeof(mod.ExpandTable));
+        memcpy(&mod.CollapseTable[0], &curModFile->FormIDHandler.CollapseTable[0], sizeof(mod.CollapseTable));
+        mod.ExpandedIndex = curModFile->FormIDHandler.ExpandedIndex;
+        mod.CollapsedIndex = curModFile->FormIDHandler.CollapsedIndex;
+
+        if(curModFile->Flags.IsCreateNew || !curModFile->file_map.is_open())
+            continue;
+
+        //The snapshot describes the plugin as it is on disk, which a changed record no longer matches.
+        //Leaving the record out would leave its version on disk out of the indexes, so nothing is saved instead.
+        const unsigned char *FileStart = (const unsigned char *)curModFile->file_map.data();
+        const unsigned char *FileEnd = FileStart + curModFile->file_map.size();
+        modRecords.clear();
+        SnapshotRecordCollector collector(modRecords);
+        curModFile->VisitAllRecords(collector);
+        for(uint32_t x = 0; x < modRecords.size(); ++x)
+            {
+            Record *curRecord = modRecords[x];
+            if(curRecord->IsChanged())
+                throw std::runtime_error("Unable to save a snapshot of the collection. It has unsaved changes to records in \"" + std::string(curModFile->ModName) + "\".");
+            if(curRecord->recData - (sizeDistance + 4) < FileStart || curRecord->recData > FileEnd)
+                continue;
+            SnapshotRecord entry;
+            entry.FormID = curRecord->formID;
+            entry.Type = curRecord->GetType();
+            entry.Flags = *(uint32_t *)&curRecord->recData[-sizeDistance + 4];
+            entry.ModIndex = p;
+            entry.Offset = (uint32_t)(curRecord->recData - (sizeDistance + 4) - FileStart);
+            entry.Size = *(uint32_t *)&curRecord->recData[-sizeDistance];
+            Record *curParent = curRecord->GetParentRecord();
+            entry.ParentFormID = curParent != NULL ? curParent->formID : 0;
+            boost::unordered_map<Record *, char *>::iterator editorID = recordEditorIDs.find(curRecord);
+            entry.EditorID = editorID != recordEditorIDs.end() ? AddSnapshotString(strings, editorID->second) : 0;
+            entry.IsWinning = CollectionID->IsWinningRecord(curRecord) ? 1 : 0;
+            records.push_back(entry);
+            }
+        }
+
+    std::stable_sort(records.begin(), records.end(), SnapshotRecordLess());
+    for(uint32_t x = 0; x < records.size(); ++x)
+        {
+        if(records[x].EditorID == 0)
+            continue;
+        SnapshotEditorID entry;
+        entry.EditorID = records[x].EditorID;
+        entry.RecordIndex = x;
+        editorIDs.push_back(entry);
+        }
+    std::stable_sort(editorIDs.begin(), editorIDs.end(), SnapshotEditorIDLess(&strings[0]));
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(SnapshotHeader));
+    memcpy(header.Magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.Version = SNAPSHOT_VERSION;
+    header.CollectionType = CollectionID->CollectionType;
+    header.NumMods = (uint32_t)mods.size();
+    header.ModsOffset = sizeof(SnapshotHeader);
+    header.NumRecords = (uint32_t)records.size();
+    header.RecordsOffset = header.ModsOffset + header.NumMods * sizeof(SnapshotMod);
+    header.NumEditorIDs = (uint32_t)editorIDs.size();
+    header.EditorIDsOffset = header.RecordsOffset + header.NumRecords * sizeof(SnapshotRecord);
+    header.StringsOffset = header.EditorIDsOffset + header.NumEditorIDs * sizeof(SnapshotEditorID);
+    header.StringsSize = (uint32_t)strings.size();
+    header.FileSize = header.StringsOffset + header.StringsSize;
+
+    FILE *file = fopen(FileName, "wb");
+    if(file == NULL)
+        return false;
+    fwrite(&header, sizeof(SnapshotHeader), 1, file);
+    if(!mods.empty())
+        fwrite(&mods[0], sizeof(SnapshotMod), mods.size(), file);
+    if(!records.empty())
+        fwrite(&records[0], sizeof(SnapshotRecord), records.size(), file);
+    if(!editorIDs.empty())
+        fwrite(&editorIDs[0], sizeof(SnapshotEditorID), editorIDs.size(), file);
+    fwrite(&strings[0], 1, strings.size(), file);
+    bool IsWritten = ferror(file) == 0;
+    if(fclose(file) != 0)
+        IsWritten = false;
+    return IsWritten;
+    }
+
+Snapshot * Snapshot::OpenOrRebuild(Collection *CollectionID, char * const FileName, bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *))
+    {
+    PROFILE_FUNC
+
+    Snapshot *SnapshotID = new Snapshot();
+    try
+        {
+        if(SnapshotID->Open(FileName) && SnapshotID->IsCurrent(CollectionID))
+            return SnapshotID;
+        //The old mapping has to be released before the file can be replaced
+        delete SnapshotID;
+        SnapshotID = NULL;
+
+        if(!CollectionID->IsLoaded && CollectionID->Load(_ProgressCallback) != 0)
+            return NULL;
+        if(!Save(CollectionID, FileName))
+            throw std::runtime_error("Unable to write the snapshot file.");
+        SnapshotID = new Snapshot();
+        if(!SnapshotID->Open(FileName))
+            throw std::runtime_error("Unable to open the snapshot file after saving it.");
+        SnapshotID->IsRebuilt = true;
+        return SnapshotID;
+        }
+    catch(...)
+        {
+        delete SnapshotID;
+        throw;
+        }
+    }
@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is CBash code.
+ *
+ * The Initial Developer of the Original Code is
+ * Waruddar.
+ * Portions created by the Initial Developer are Copyright (C) 2010
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+#pragma once
+// Snapshot.h
+#include "Common.h"
+
+#define SNAPSHOT_MAGIC "CBSNAP"
+#define SNAPSHOT_VERSION 2
+
+struct Collection;
+
+//The on disk layout of a collection snapshot. Every position is an offset
+//from the start of the file, so a mapped snapshot is used as is.
+struct SnapshotHeader
+    {
+    char     Magic[8];
+    uint32_t Version;
+    uint32_t CollectionType;
+    uint32_t FileSize;
+    uint32_t NumMods, ModsOffset;
+    uint32_t NumRecords, RecordsOffset;
+    uint32_t NumEditorIDs, EditorIDsOffset;
+    uint32_t StringsOffset, StringsSize;
+    };
+
+struct SnapshotMod
+    {
+    uint32_t FileName;                //Offset into the string table
+    uint32_t ModName;                 //Offset into the string table
+    uint64_t FileSize;
+    int64_t  ModTime;                 //In nanoseconds, so that a rewrite within the same second is noticed
+    uint32_t Flags;                   //The ModFlags the mod was added with
+    uint8_t  ExpandTable[256];
+    uint8_t  CollapseTable[256];
+    uint8_t  ExpandedIndex;
+    uint8_t  CollapsedIndex;
+    uint8_t  IsPresent;               //Whether the plugin existed when the snapshot was made
+    uint8_t  unused1;
+    uint32_t HeaderCRC;               //CRC-32 of the plugin's header record, which changes with its masters and record count
+    };
+
+//Sorted by FormID, then by mod
+struct SnapshotRecord
+    {
+    FORMID   FormID;
+    uint32_t Type;
+    uint32_t Flags;                   //The record flags as stored in the plugin
+    uint32_t ModIndex;
+    uint32_t Offset;                  //Offset of the record header in the plugin
+    uint32_t Size;                    //Size of the record data in the plugin, excluding the header
+    FORMID   ParentFormID;
+    uint32_t EditorID;                //Offset into the string table, 0 if the record has none
+    uint32_t IsWinning;
+    };
+
+//Sorted case insensitively by editor id
+struct SnapshotEditorID
+    {
+    uint32_t EditorID;
+    uint32_t RecordIndex;
+    };
+
+struct Snapshot
+    {
+    private:
+        boost::iostreams::mapped_file_source file_map;
+
+    public:
+        const SnapshotHeader *Header;
+        const SnapshotMod *Mods;
+        const SnapshotRecord *Records;
+        const SnapshotEditorID *EditorIDs;
+        const char *Strings;
+        bool IsRebuilt;
+
+        Snapshot();
+        ~Snapshot();
+
+        bool Open(char * const FileName);
+        bool IsCurrent(Collection *CollectionID);
+
+        const char * GetString(const uint32_t Offset) const;
+        uint32_t FindRecords(const FORMID FormID, const SnapshotRecord *&First) const;
+        uint32_t FindEditorIDs(char * const EditorID, const SnapshotEditorID *&First) const;
+        void GetModInfo(const uint32_t ModIndex, SnapshotModInfo &Info) const;
+        void GetRecordInfo(const SnapshotRecord &Entry, SnapshotRecordInfo &Info) const;
+        Record * GetRecord(Collection *CollectionID, const SnapshotRecordInfo &Info) const;
+
+        static bool Save(Collection *CollectionID, char * const FileName);
+        static Snapshot * OpenOrRebuild(Collection *CollectionID, char * const FileName, bool (*_ProgressCallback)(const uint32_t, const uint32_t, const char *));
+    };
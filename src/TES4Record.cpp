@@ -152,8 +152,8 @@ void TES4Record::LoadStringLookups(char * FileName)
     if (LookupStrings != NULL)
         return;
 
-    LookupStrings = new StringLookups;
-    LookupStrings->Open(FileName);
+    //The string files are opened by the first lookup
+    LookupStrings = new StringLookups(FileName);
 }
 
 uint32_t TES4Record::GetType()
@@ -301,14 +301,14 @@ int32_t TES4Record::WriteRecord(FileWriter &writer)
     return -1;
 }
 
-bool TES4Record::Read()
+bool TES4Record::Read(const SubrecordProjection *Projection)
 {
 	if (whichGame == eIsFalloutNewVegas)
-		return ReadRecord(20);
+		return ReadRecord(20, Projection);
 	else if (whichGame == eIsSkyrim)
-		return ReadRecord(20);
+		return ReadRecord(20, Projection);
 	else
-		return ReadRecord(16);
+		return ReadRecord(16, Projection);
 }
 
 uint32_t TES4Record::Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders)
@@ -103,7 +103,7 @@ class TES4Record : public Record
         int32_t Unload();
         int32_t WriteRecord(FileWriter &writer);
         uint32_t Write(FileWriter &writer, const bool &bMastersChanged, FormIDResolver &expander, FormIDResolver &collapser, std::vector<FormIDResolver *> &Expanders);
-		bool   Read();
+		bool   Read(const SubrecordProjection *Projection=NULL);
 
         bool operator ==(const TES4Record &other) const;
         bool operator !=(const TES4Record &other) const;
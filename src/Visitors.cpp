@@ -36,6 +36,9 @@
 // Visitors.cpp
 #include "Visitors.h"
 #include "Oblivion/Records/MGEFRecord.h"
+#include <algorithm>
+#include <functional>
+#include <string.h>
 
 FormIDMatchCounter::FormIDMatchCounter(const uint32_t &_FormIDToMatch):
     FormIDOp(),
@@ -137,6 +140,70 @@ bool FormIDSwapper::AcceptMGEF(uint32_t &curMgefCode)
     return stop;
     }
 
+FormIDNormalizer::FormIDNormalizer():
+    FormIDOp(),
+    LoadOrder255(NULL),
+    CanonicalTable(NULL),
+    hash(FINGERPRINT_SEED)
+    {
+    //
+    }
+
+FormIDNormalizer::~FormIDNormalizer()
+    {
+    //
+    }
+
+void FormIDNormalizer::Normalize(ModFile *ModID, const uint8_t *_CanonicalTable)
+    {
+    LoadOrder255 = &ModID->FormIDHandler.LoadOrder255;
+    CanonicalTable = _CanonicalTable;
+    originals.clear();
+    hash = FINGERPRINT_SEED;
+    count = 0;
+    }
+
+uint32_t FormIDNormalizer::Normalize(const uint32_t curID, const uint8_t ModIndex, const bool IsMGEF)
+    {
+    if(ModIndex < LoadOrder255->size())
+        hash = HashName((*LoadOrder255)[ModIndex], hash);
+    else
+        hash = HashBytes(&ModIndex, sizeof(ModIndex), hash);
+    uint32_t NewIndex = CanonicalTable != NULL ? CanonicalTable[ModIndex] : 0;
+    if(IsMGEF)
+        return (curID & 0xFFFFFF00) | NewIndex;
+    return (curID & 0x00FFFFFF) | (NewIndex << 24);
+    }
+
+uint32_t FormIDNormalizer::NormalizeFormID(const uint32_t curFormID)
+    {
+    return Normalize(curFormID, (uint8_t)(curFormID >> 24), false);
+    }
+
+void FormIDNormalizer::Restore()
+    {
+    //Undone in reverse, so a formID visited twice ends up with its first value
+    for(size_t x = originals.size(); x > 0; --x)
+        *originals[x - 1].first = originals[x - 1].second;
+    originals.clear();
+    }
+
+bool FormIDNormalizer::Accept(uint32_t &curFormID)
+    {
+    originals.push_back(std::make_pair(&curFormID, curFormID));
+    curFormID = Normalize(curFormID, (uint8_t)(curFormID >> 24), false);
+    ++count;
+    return stop;
+    }
+
+bool FormIDNormalizer::AcceptMGEF(uint32_t &curMgefCode)
+    {
+    originals.push_back(std::make_pair(&curMgefCode, curMgefCode));
+    curMgefCode = Normalize(curMgefCode, (uint8_t)(curMgefCode & 0x000000FF), true);
+    ++count;
+    return stop;
+    }
+
 RecordIndexer::RecordIndexer(ModFile *_curModFile, EditorID_Map &_EditorID_Map, FormID_Map &_FormID_Map, EditorID_Map &EDIDIndex):
     RecordOp(),
     curModFile(_curModFile),
@@ -163,6 +230,9 @@ RecordIndexer::~RecordIndexer()
 
 bool RecordIndexer::Accept(Record *&curRecord)
     {
+    PROFILE_SCOPE("indexing");
+    if(IsTracing)
+        ++LocalTraceCounters().records;
     if(curRecord->formID != 0)
         FormID_ModFile_Record.insert(std::make_pair(curRecord->formID,curRecord));
     if(curRecord->IsKeyedByEditorID() && curRecord->GetEditorIDKey() != NULL) //Should only be null on deleted records (they'll get indexed after being undeleted)
@@ -87,6 +87,34 @@ class FormIDSwapper : public FormIDOp
         bool AcceptMGEF(uint32_t &curMgefCode);
     };
 
+//Rewrites each formID visited so that it no longer depends on load order, and folds
+// the name of the mod it resolved to into hash.
+//If a CanonicalTable is given, the modIndex is remapped through it instead of being dropped.
+//Like collapsing for a save, the record is changed in place, so anything written from it
+// is load order independent. Restore puts the loaded formIDs back.
+class FormIDNormalizer : public FormIDOp
+    {
+    private:
+        std::vector<char *> *LoadOrder255;
+        const uint8_t *CanonicalTable;
+        std::vector<std::pair<uint32_t *, uint32_t> > originals;
+
+        uint32_t Normalize(const uint32_t curID, const uint8_t ModIndex, const bool IsMGEF);
+
+    public:
+        uint64_t hash;
+
+        FormIDNormalizer();
+        ~FormIDNormalizer();
+
+        void Normalize(ModFile *ModID, const uint8_t *_CanonicalTable=NULL);
+        uint32_t NormalizeFormID(const uint32_t curFormID);
+        void Restore();
+
+        bool Accept(uint32_t &curFormID);
+        bool AcceptMGEF(uint32_t &curMgefCode);
+    };
+
 class RecordIndexer : public RecordOp
     {
     private: